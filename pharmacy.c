@@ -1,2369 +1,9836 @@
-#include <stdio.h>
-#include <stdlib.h>
-#include <string.h>
-
-#define ORDER 4 // Order of the B-tree
-#define MIN_KEYS ((ORDER - 1) / 2)
-#define MAX_SUPPLIERS 400    // Maximum suppliers in a batch
-#define MAX_BATCHES 100      // Maximum batches per medication
-#define MAX_MEDICATIONS 1000 // Maximum medications
-#define MAX_NAME_LENGTH 50   // Maximum length for names
-#define MAX_MEDS_PER_SUPP 100
-#define MAX_DATE_LENGTH 11
-
-typedef enum
-{
-    FAILURE,
-    SUCCESS
-} status_code;
-
-typedef enum
-{
-    false,
-    true
-} Boolean;
-
-int suppliers_active[MAX_SUPPLIERS] = {0}; // Array to track active suppliers
-
-// Forward declaration
-typedef struct data_tag data;
-
-// Supplier structure holds supplier details.
-typedef struct Supplier_tag
-{
-    int supplier_id;
-    char supp_name[MAX_NAME_LENGTH];
-    int qty_of_supply;
-    long long contact;
-    data *medications[MAX_MEDS_PER_SUPP]; // Pointers to medication data
-    int med_count;
-} supplier;
-
-// Batch structure holds information about one batch of a medication.
-typedef struct batch_tag
-{
-    int batch_no;
-    int qty_instock;
-    char exp_date[MAX_DATE_LENGTH];
-    supplier *suppliers[MAX_SUPPLIERS]; // Array of pointers to suppliers for this batch
-    int supplier_count;                 // Number of suppliers in this batch
-} batch;
-
-// Medication data structure holds medID, medname, an array of batches, and reorder level.
-typedef struct data_tag
-{
-    int medID;
-    char medname[MAX_NAME_LENGTH];
-    batch Batch[MAX_BATCHES]; // Array of batch information
-    int batch_count;          // Number of batches for this medication
-    int reorder_lvl;
-    int priceperunit;
-} data;
-
-// B-tree node for medication ID (integer key)
-typedef struct B
-{
-    int keys[ORDER - 1];       // Integer keys (medID)
-    data *values[ORDER - 1];   // Pointer to medication record
-    struct B *children[ORDER]; // Child pointers
-    int num_keys;              // Number of keys in the node
-    int is_leaf;               // 1 if leaf, 0 otherwise
-} B;
-
-// B-tree node for medication name (string key)
-typedef struct B_str
-{
-    char *keys[ORDER - 1];         // String keys (medname or expiry date)
-    data *values[ORDER - 1];       // Pointer to medication record
-    struct B_str *children[ORDER]; // Child pointers
-    int num_keys;                  // Number of keys
-    int is_leaf;                   // 1 if leaf, 0 otherwise
-} B_str;
-
-// B-tree node for supplier (integer key)
-typedef struct B_supp
-{
-    int keys[ORDER - 1];            // supplier_id keys
-    supplier *values[ORDER - 1];    // Pointer to supplier data
-    struct B_supp *children[ORDER]; // Child pointers
-    int num_keys;
-    int is_leaf;
-} B_supp;
-
-supplier *search_supplier(B_supp *root, int supplier_id);
-void addMedicationGeneral(B **medIDTree, B_str **mednameTree, B_str **expDateTree, B_supp **supplierTree);
-void searchMedicationBymedId(int medId, B *medIDTree);
-void searchMedicationBymedname(char *medname, B_str *mednameTree);
-void searchMedication();
-void updateMedication(int medID);
-B *precedingNode(B *node, int index);
-B *successiveNode(B *node, int index);
-B *borrowFromPrev(B *node, int index);
-B *borrowFromNext(B *node, int index);
-B *mergeNodes(B *node, int index);
-B *deleteFromBTree(B *root, int key);
-B_str *mergeBTreeStr(B_str *node, int index);
-B_str *deleteFromBTreeStr(B_str *node, char *key);
-B_supp *deleteFromBTreeSupp(B_supp *root, int key);
-data *search_medID(B *root, int medID);
-void deleteMedication(B **root, B_str **nameRoot, B_str **dateRoot, B_supp **supplierRoot, int medID, int batch_no);
-void checkexpirydate(B_str *expDateTree, char *currentdate);
-void stockAlerts(B *root);
-void sortMedicationByExpiry(B_str *node, const char *date1, const char *date2);
-void salesTracking(B *node, int medID, int qtySold);
-void supplierManagement();
-
-//==========HEAP SORT FUNCTION==========//
-
-void swap(int *a, int *b)
-{
-    int temp = *a;
-    *a = *b;
-    *b = temp;
-}
-int left(int i)
-{
-    return (2 * i + 1);
-}
-int right(int i)
-{
-    return (2 * i + 2);
-}
-int parent(int i)
-{
-    return (i - 1) / 2;
-}
-void MaxHeapify(int A[], int ID[], int n, int i)
-{
-    int largest = i;
-    int l = left(i);
-    int r = right(i);
-
-    if (l < n && A[l] > A[largest])
-        largest = l;
-
-    if (r < n && A[r] > A[largest])
-        largest = r;
-
-    if (largest != i)
-    {
-        swap(&A[i], &A[largest]);
-        swap(&ID[i], &ID[largest]);
-        MaxHeapify(A, ID, n, largest);
-    }
-}
-
-void BuildMaxHeap(int A[], int ID[], int n)
-{
-    for (int i = n / 2 - 1; i >= 0; i--)
-        MaxHeapify(A, ID, n, i);
-}
-
-void Heapsort(int A[], int ID[], int n)
-{
-    BuildMaxHeap(A, ID, n);
-    for (int i = n - 1; i > 0; i--)
-    {
-        swap(&A[0], &A[i]);
-        swap(&ID[0], &ID[i]);
-        MaxHeapify(A, ID, i, 0);
-    }
-}
-void swap_batches(batch *a, batch *b)
-{
-    batch temp = *a;
-    *a = *b;
-    *b = temp;
-}
-void MaxHeapify_batches(batch *batches, int n, int i)
-{
-    int largest = i;
-    int l = left(i);
-    int r = right(i);
-
-    if (l < n && strcmp(batches[l].exp_date, batches[largest].exp_date) > 0)
-        largest = l;
-
-    if (r < n && strcmp(batches[r].exp_date, batches[largest].exp_date) > 0)
-        largest = r;
-
-    if (largest != i)
-    {
-        swap_batches(&batches[i], &batches[largest]);
-        MaxHeapify_batches(batches, n, largest);
-    }
-}
-
-void BuildMaxHeap_batches(batch *batches, int n)
-{
-    for (int i = n / 2 - 1; i >= 0; i--)
-        MaxHeapify_batches(batches, n, i);
-}
-
-void Heapsort_batches(batch *batches, int n)
-{
-    BuildMaxHeap_batches(batches, n);
-    for (int i = n - 1; i > 0; i--)
-    {
-        swap_batches(&batches[0], &batches[i]);
-        MaxHeapify_batches(batches, i, 0); // Reduce heap size by 1
-    }
-}
-
-void sortBatchesByExpiry(batch *batches, int batch_count)
-{
-    Heapsort_batches(batches, batch_count);
-}
-
-void convert_date_format(const char *input_date, char *output_date)
-{
-    // Assuming input_date is in the format "DD-MM-YYYY"
-    // output_date should be a buffer of at least 11 bytes
-    char day[3], month[3], year[5];
-
-    // Extract parts using sscanf
-    sscanf(input_date, "%2s-%2s-%4s", day, month, year);
-
-    // Rearrange into YYYY-MM-DD
-    sprintf(output_date, "%s-%s-%s", year, month, day);
-}
-
-void reverse_date_format(const char *input_date, char *output_date)
-{
-    // Assuming input_date is in the format "YYYY-MM-DD"
-    // output_date should be a buffer of at least 11 bytes
-    char day[3], month[3], year[5];
-
-    // Extract parts using sscanf
-    sscanf(input_date, "%4s-%2s-%2s", year, month, day);
-
-    // Rearrange into DD-MM-YYYY
-    sprintf(output_date, "%s-%s-%s", day, month, year);
-}
-
-B *create_node()
-{
-    B *new_node = (B *)malloc(sizeof(B));
-    new_node->num_keys = 0;
-    new_node->is_leaf = 1;
-    for (int i = 0; i < ORDER; i++)
-        new_node->children[i] = NULL;
-    return new_node;
-}
-
-void split_child(B *parent, int index, B *child)
-{
-    B *new_child = create_node();
-    new_child->is_leaf = child->is_leaf;
-    new_child->num_keys = (ORDER / 2) - 1;
-
-    for (int i = 0; i < (ORDER / 2) - 1; i++)
-    {
-        new_child->keys[i] = child->keys[i + (ORDER / 2)];
-        new_child->values[i] = child->values[i + (ORDER / 2)];
-    }
-
-    if (!child->is_leaf)
-    {
-        for (int i = 0; i < ORDER / 2; i++)
-            new_child->children[i] = child->children[i + (ORDER / 2)];
-    }
-
-    child->num_keys = (ORDER / 2) - 1;
-
-    for (int i = parent->num_keys; i >= index + 1; i--)
-        parent->children[i + 1] = parent->children[i];
-    parent->children[index + 1] = new_child;
-
-    for (int i = parent->num_keys - 1; i >= index; i--)
-    {
-        parent->keys[i + 1] = parent->keys[i];
-        parent->values[i + 1] = parent->values[i];
-    }
-
-    parent->keys[index] = child->keys[(ORDER / 2) - 1];
-    parent->values[index] = child->values[(ORDER / 2) - 1];
-    parent->num_keys++;
-}
-
-void insert_non_full(B *node, int key, data *value)
-{
-    int i = node->num_keys - 1;
-
-    if (node->is_leaf)
-    {
-        while (i >= 0 && key < node->keys[i])
-        {
-            node->keys[i + 1] = node->keys[i];
-            node->values[i + 1] = node->values[i];
-            i--;
-        }
-        node->keys[i + 1] = key;
-        node->values[i + 1] = value;
-        node->num_keys++;
-    }
-    else
-    {
-        while (i >= 0 && key < node->keys[i])
-            i--;
-        i++;
-        if (node->children[i]->num_keys == ORDER - 1)
-        {
-            split_child(node, i, node->children[i]);
-            if (key > node->keys[i])
-                i++;
-        }
-        insert_non_full(node->children[i], key, value);
-    }
-}
-void insert_int(B **root, int key, data *value)
-{
-    if (*root == NULL)
-    {
-        *root = create_node();
-        (*root)->keys[0] = key;
-        (*root)->values[0] = value;
-        (*root)->num_keys = 1;
-    }
-    else
-    {
-        if ((*root)->num_keys == ORDER - 1)
-        {
-            B *new_root = create_node();
-            new_root->is_leaf = 0;
-            new_root->children[0] = *root;
-            split_child(new_root, 0, *root);
-            *root = new_root;
-        }
-        insert_non_full(*root, key, value);
-    }
-}
-
-B *medIDTree = NULL;
-B_str *mednameTree = NULL;
-B_str *expDateTree = NULL;
-B_supp *supplierTree = NULL;
-
-B_str *create_node_str()
-{
-    B_str *new_node = (B_str *)malloc(sizeof(B_str));
-    new_node->num_keys = 0;
-    new_node->is_leaf = 1;
-    for (int i = 0; i < ORDER; i++)
-        new_node->children[i] = NULL;
-    return new_node;
-}
-
-void split_child_str(B_str *parent, int index, B_str *child)
-{
-    B_str *new_child = create_node_str();
-    new_child->is_leaf = child->is_leaf;
-    new_child->num_keys = (ORDER / 2) - 1;
-
-    for (int i = 0; i < (ORDER / 2) - 1; i++)
-    {
-        new_child->keys[i] = child->keys[i + (ORDER / 2)];
-        new_child->values[i] = child->values[i + (ORDER / 2)];
-    }
-
-    if (!child->is_leaf)
-    {
-        for (int i = 0; i < ORDER / 2; i++)
-            new_child->children[i] = child->children[i + (ORDER / 2)];
-    }
-
-    child->num_keys = (ORDER / 2) - 1;
-
-    for (int i = parent->num_keys; i >= index + 1; i--)
-        parent->children[i + 1] = parent->children[i];
-    parent->children[index + 1] = new_child;
-
-    for (int i = parent->num_keys - 1; i >= index; i--)
-    {
-        parent->keys[i + 1] = parent->keys[i];
-        parent->values[i + 1] = parent->values[i];
-    }
-
-    parent->keys[index] = child->keys[(ORDER / 2) - 1];
-    parent->values[index] = child->values[(ORDER / 2) - 1];
-    parent->num_keys++;
-}
-
-void insert_non_full_str(B_str *node, char *key, data *value)
-{
-    int i = node->num_keys - 1;
-    if (node->is_leaf)
-    {
-        while (i >= 0 && strcmp(key, node->keys[i]) < 0)
-        {
-            node->keys[i + 1] = node->keys[i];
-            node->values[i + 1] = node->values[i];
-            i--;
-        }
-        node->keys[i + 1] = strdup(key);
-        node->values[i + 1] = value;
-        node->num_keys++;
-    }
-    else
-    {
-        while (i >= 0 && strcmp(key, node->keys[i]) < 0)
-            i--;
-        i++;
-        if (node->children[i]->num_keys == ORDER - 1)
-        {
-            split_child_str(node, i, node->children[i]);
-            if (strcmp(key, node->keys[i]) > 0)
-                i++;
-        }
-        insert_non_full_str(node->children[i], key, value);
-    }
-}
-
-void insert_str(B_str **root, char *key, data *value)
-{
-    if (*root == NULL)
-    {
-        *root = create_node_str();
-        (*root)->keys[0] = strdup(key);
-        (*root)->values[0] = value;
-        (*root)->num_keys = 1;
-    }
-    else
-    {
-        if ((*root)->num_keys == ORDER - 1)
-        {
-            B_str *new_root = create_node_str();
-            new_root->is_leaf = 0;
-            new_root->children[0] = *root;
-            split_child_str(new_root, 0, *root);
-            *root = new_root;
-        }
-        insert_non_full_str(*root, key, value);
-    }
-}
-
-B_supp *create_node_supp()
-{
-    B_supp *new_node = (B_supp *)malloc(sizeof(B_supp));
-    new_node->num_keys = 0;
-    new_node->is_leaf = 1;
-    for (int i = 0; i < ORDER; i++)
-        new_node->children[i] = NULL;
-    return new_node;
-}
-
-void split_child_supp(B_supp *parent, int index, B_supp *child)
-{
-    B_supp *new_child = create_node_supp();
-    new_child->is_leaf = child->is_leaf;
-    new_child->num_keys = (ORDER / 2) - 1;
-
-    for (int i = 0; i < (ORDER / 2) - 1; i++)
-    {
-        new_child->keys[i] = child->keys[i + (ORDER / 2)];
-        new_child->values[i] = child->values[i + (ORDER / 2)];
-    }
-
-    if (!child->is_leaf)
-    {
-        for (int i = 0; i < ORDER / 2; i++)
-            new_child->children[i] = child->children[i + (ORDER / 2)];
-    }
-
-    child->num_keys = (ORDER / 2) - 1;
-
-    for (int i = parent->num_keys; i >= index + 1; i--)
-        parent->children[i + 1] = parent->children[i];
-    parent->children[index + 1] = new_child;
-
-    for (int i = parent->num_keys - 1; i >= index; i--)
-    {
-        parent->keys[i + 1] = parent->keys[i];
-        parent->values[i + 1] = parent->values[i];
-    }
-
-    parent->keys[index] = child->keys[(ORDER / 2) - 1];
-    parent->values[index] = child->values[(ORDER / 2) - 1];
-    parent->num_keys++;
-}
-
-void insert_non_full_supp(B_supp *node, int key, supplier *value)
-{
-    int i = node->num_keys - 1;
-    if (node->is_leaf)
-    {
-        while (i >= 0 && key < node->keys[i])
-        {
-            node->keys[i + 1] = node->keys[i];
-            node->values[i + 1] = node->values[i];
-            i--;
-        }
-        node->keys[i + 1] = key;
-        node->values[i + 1] = value;
-        node->num_keys++;
-    }
-    else
-    {
-        while (i >= 0 && key < node->keys[i])
-            i--;
-        i++;
-        if (node->children[i]->num_keys == ORDER - 1)
-        {
-            split_child_supp(node, i, node->children[i]);
-            if (key > node->keys[i])
-                i++;
-        }
-        insert_non_full_supp(node->children[i], key, value);
-    }
-}
-
-void insert_supp(B_supp **root, int key, supplier *value)
-{
-    supplier *new_supplier = (supplier *)malloc(sizeof(supplier));
-    if (new_supplier == NULL)
-    {
-        printf("Memory allocation failed for supplier.\n");
-        return;
-    }
-    *new_supplier = *value; // Copy supplier details to prevent overwriting
-
-    if (*root == NULL)
-    {
-        *root = create_node_supp();
-        (*root)->keys[0] = key;
-        (*root)->values[0] = new_supplier; // Store new supplier pointer
-        (*root)->num_keys = 1;
-    }
-    else
-    {
-        if ((*root)->num_keys == ORDER - 1)
-        {
-            B_supp *new_root = create_node_supp();
-            new_root->is_leaf = 0;
-            new_root->children[0] = *root;
-            split_child_supp(new_root, 0, *root);
-            *root = new_root;
-        }
-        insert_non_full_supp(*root, key, new_supplier);
-    }
-}
-supplier *search_supplier(B_supp *root, int supplier_id)
-{
-    if (root == NULL)
-        return NULL;
-
-    int i = 0;
-
-    // Find the first key greater than or equal to supplier_id
-    while (i < root->num_keys && supplier_id > root->keys[i])
-        i++;
-
-    // If the key is found, return the associated supplier data
-    if (i < root->num_keys && root->keys[i] == supplier_id)
-        return root->values[i];
-
-    // If the node is a leaf, the key doesn't exist
-    if (root->is_leaf)
-        return NULL;
-
-    // Search in the appropriate child node
-    return search_supplier(root->children[i], supplier_id);
-}
-void addMedicationGeneral(B **medIDTree, B_str **mednameTree, B_str **expDateTree, B_supp **supplierTree)
-{
-    // Input medication data
-    int medID, batch_no, priceperunit, qty_instock, reorder_lvl;
-    char medname[MAX_NAME_LENGTH];
-    char exp_date[MAX_DATE_LENGTH];
-
-    printf("\n=== Add New Medication ===\n");
-    printf("Enter Medication ID: ");
-    scanf("%d", &medID);
-    printf("Enter Medication Name: ");
-    scanf(" %[^\n]", medname);
-    printf("Enter Batch Number: ");
-    scanf("%d", &batch_no);
-    printf("Enter Price per Unit: ");
-    scanf("%d", &priceperunit);
-    printf("Enter Quantity in Stock: ");
-    scanf("%d", &qty_instock);
-    printf("Enter Expiry Date (YYYY-MM-DD): ");
-    scanf(" %10s", exp_date);
-    printf("Enter Reorder Level: ");
-    scanf("%d", &reorder_lvl);
-
-    // Medication search or create
-    data *med = search_medID(*medIDTree, medID);
-    if (med == NULL)
-    {
-        med = (data *)malloc(sizeof(data));
-        if (!med)
-        {
-            printf("Memory allocation failed for medication\n");
-            return;
-        }
-
-        // Initialize medication
-        med->medID = medID;
-        strncpy(med->medname, medname, MAX_NAME_LENGTH);
-        med->medname[MAX_NAME_LENGTH - 1] = '\0';
-        med->reorder_lvl = reorder_lvl;
-        med->priceperunit = priceperunit;
-        med->batch_count = 0;
-
-        insert_int(medIDTree, med->medID, med);
-        insert_str(mednameTree, med->medname, med);
-    }
-
-    // Check batch limit
-    if (med->batch_count >= MAX_BATCHES)
-    {
-        printf("Error: Maximum batches (%d) reached for this medication\n", MAX_BATCHES);
-        return;
-    }
-
-    // Find insertion position for batch (sorted by batch_no)
-    int pos = 0;
-    while (pos < med->batch_count && batch_no > med->Batch[pos].batch_no)
-    {
-        pos++;
-    }
-
-    // Shift batches to make room
-    for (int i = med->batch_count; i > pos; i--)
-    {
-        med->Batch[i] = med->Batch[i - 1];
-    }
-
-    // Initialize new batch
-    batch *newBatch = &med->Batch[pos];
-    newBatch->batch_no = batch_no;
-    newBatch->qty_instock = qty_instock;
-    strncpy(newBatch->exp_date, exp_date, MAX_DATE_LENGTH);
-    newBatch->exp_date[MAX_DATE_LENGTH - 1] = '\0';
-    newBatch->supplier_count = 0;
-    med->batch_count++;
-    insert_str(expDateTree, newBatch->exp_date, med);
-
-    // Supplier handling
-    int supplier_id;
-    printf("\n=== Supplier Information ===\n");
-    printf("Enter Supplier ID: ");
-    scanf("%d", &supplier_id);
-
-    supplier *existingSupplier = search_supplier(*supplierTree, supplier_id);
-    if (existingSupplier == NULL)
-    {
-        // New supplier
-        existingSupplier = (supplier *)malloc(sizeof(supplier));
-        if (!existingSupplier)
-        {
-            printf("Memory allocation failed for supplier\n");
-            return;
-        }
-
-        existingSupplier->supplier_id = supplier_id;
-        printf("Enter Supplier Name: ");
-        scanf(" %[^\n]", existingSupplier->supp_name);
-        printf("Enter Quantity Supplied: ");
-        scanf("%d", &existingSupplier->qty_of_supply);
-        printf("Enter Supplier Contact: ");
-        scanf("%lld", &existingSupplier->contact);
-        existingSupplier->med_count = 0;
-
-        insert_supp(supplierTree, existingSupplier->supplier_id, existingSupplier);
-    }
-
-    // Link supplier to batch
-    if (newBatch->supplier_count < MAX_SUPPLIERS)
-    {
-        newBatch->suppliers[newBatch->supplier_count++] = existingSupplier;
-        printf("Supplier linked to batch successfully.\n");
-    }
-    else
-    {
-        printf("Warning: Maximum suppliers (%d) reached for this batch\n", MAX_SUPPLIERS);
-    }
-
-    // Link medication to supplier if not already linked
-    Boolean medExists = false;
-    for (int i = 0; i < existingSupplier->med_count; i++)
-    {
-        if (existingSupplier->medications[i] &&
-            existingSupplier->medications[i]->medID == medID)
-        {
-            medExists = true;
-            break;
-        }
-    }
-
-    if (!medExists && existingSupplier->med_count < MAX_MEDS_PER_SUPP)
-    {
-        existingSupplier->medications[existingSupplier->med_count++] = med;
-        printf("Medication linked to supplier successfully.\n");
-    }
-}
-
-void inorderBTree(B *root)
-{
-    if (root != NULL)
-    {
-        for (int i = 0; i < root->num_keys; i++)
-        {
-            inorderBTree(root->children[i]);
-            printf("%d ", root->keys[i]); // Print medID
-        }
-        inorderBTree(root->children[root->num_keys]);
-    }
-}
-
-void inorderBTreeStr(B_str *root)
-{
-    if (root != NULL)
-    {
-        for (int i = 0; i < root->num_keys; i++)
-        {
-            inorderBTreeStr(root->children[i]);
-            printf("%s ", root->keys[i]); // Print medname or exp_date
-        }
-        inorderBTreeStr(root->children[root->num_keys]);
-    }
-}
-void inorderBTreeExp(B_str *root)
-{
-    if (root != NULL)
-    {
-        for (int i = 0; i < root->num_keys; i++)
-        {
-            inorderBTreeExp(root->children[i]);
-
-            // Convert and print the date in DD-MM-YYYY format
-            char formatted_date[11];
-            reverse_date_format(root->keys[i], formatted_date);
-            printf("%s ", formatted_date);
-        }
-        inorderBTreeExp(root->children[root->num_keys]);
-    }
-}
-
-void inorderBTreeSupp(B_supp *root)
-{
-    if (root != NULL)
-    {
-        for (int i = 0; i < root->num_keys; i++)
-        {
-            // Traverse left child first
-            inorderBTreeSupp(root->children[i]);
-
-            // Print supplier details
-            printf("Supplier ID: %d\n", root->keys[i]);
-            printf("Supplier Name: %s\n", root->values[i]->supp_name);
-            printf("Quantity of Supply: %d\n", root->values[i]->qty_of_supply);
-            printf("Contact: %lld\n", root->values[i]->contact);
-            printf("Medications Supplied:\n");
-            if (root->values[i]->med_count > 0)
-            {
-
-                for (int j = 0; j < root->values[i]->med_count; j++)
-                {
-                    if (root->values[i]->medications[j] != NULL)
-                    {
-                        printf("  - %s (ID: %d)\n",
-                               root->values[i]->medications[j]->medname,
-                               root->values[i]->medications[j]->medID);
-                    }
-                }
-            }
-            else
-            {
-                printf("  (No medications recorded)\n");
-            }
-            printf("\n");
-        }
-        // Traverse rightmost child
-        inorderBTreeSupp(root->children[root->num_keys]);
-    }
-}
-void searchMedicationBymedId(int medId, B *medIDTree)
-{
-    B *current = medIDTree;
-    while (current != NULL)
-    {
-        int i = 0;
-        while (i < current->num_keys && medId > current->keys[i])
-        {
-            i++;
-        }
-
-        if (i < current->num_keys && medId == current->keys[i])
-        {
-            data *med = current->values[i];
-            printf("\nMedication Details:\n");
-            printf("ID: %d\n", med->medID);
-            printf("Name: %s\n", med->medname);
-            printf("Price per unit: %d\n", med->priceperunit);
-            printf("Reorder level: %d\n", med->reorder_lvl);
-            printf("Batch Count: %d\n", med->batch_count);
-
-            for (int j = 0; j < med->batch_count; j++)
-            {
-                printf("\nBatch %d:\n", j + 1);
-                printf("  Batch No: %d\n", med->Batch[j].batch_no);
-                printf("  Expiry Date: %s\n", med->Batch[j].exp_date);
-                printf("  Quantity in Stock: %d\n", med->Batch[j].qty_instock);
-                printf("  Suppliers: ");
-
-                if (med->Batch[j].supplier_count == 0)
-                {
-                    printf("None\n");
-                }
-                else
-                {
-                    for (int k = 0; k < med->Batch[j].supplier_count; k++)
-                    {
-                        if (med->Batch[j].suppliers[k])
-                        {
-                            printf("%s (ID: %d)",
-                                   med->Batch[j].suppliers[k]->supp_name,
-                                   med->Batch[j].suppliers[k]->supplier_id);
-                            if (k < med->Batch[j].supplier_count - 1)
-                                printf(", ");
-                        }
-                    }
-                    printf("\n");
-                }
-            }
-            return;
-        }
-
-        if (current->is_leaf)
-        {
-            break;
-        }
-        else
-        {
-            current = current->children[i];
-        }
-    }
-    printf("Medication with ID %d not found.\n", medId);
-}
-
-void searchMedicationBymedname(char *medname, B_str *mednameTree)
-{
-    B_str *current = mednameTree;
-    while (current != NULL)
-    {
-        int i = 0;
-        while (i < current->num_keys && strcmp(medname, current->keys[i]) > 0)
-        {
-            i++;
-        }
-        if (i < current->num_keys && strcmp(medname, current->keys[i]) == 0)
-        {
-            printf("Medication found: Name %s\n", medname);
-            printf("ID: %d\n", current->values[i]->medID);
-            printf("Batch Count: %d\n", current->values[i]->batch_count);
-            for (int j = 0; j < current->values[i]->batch_count; j++)
-            {
-                printf("Batch No: %d, Expiry Date: %s, Quantity in Stock: %d\n",
-                       current->values[i]->Batch[j].batch_no,
-                       current->values[i]->Batch[j].exp_date,
-                       current->values[i]->Batch[j].qty_instock);
-            }
-            printf("Reorder Level: %d\n", current->values[i]->reorder_lvl);
-            return;
-        }
-        if (current->is_leaf)
-        {
-            break;
-        }
-        else
-        {
-            current = current->children[i];
-        }
-    }
-    printf("Medication with name %s not found.\n", medname);
-}
-void updateMedication(int medID)
-{
-    // Search for existing medication by medID.
-    data *med = search_medID(medIDTree, medID);
-    if (med == NULL)
-    {
-        printf("Medication with ID %d not found.\n", medID);
-        return;
-    }
-    else
-    {
-        printf("enter the new price of medication\n");
-        int new_price;
-        scanf("%d", &new_price);
-        med->priceperunit = new_price;
-        printf("enter the batch number whose quantity is to be updated");
-        int batch_no;
-        scanf("%d", &batch_no);
-        int i;
-        for (i = 0; i < med->batch_count; i++)
-        {
-            if (med->Batch[i].batch_no == batch_no)
-            {
-                break;
-            }
-        }
-        if (i == med->batch_count)
-        {
-            printf("Batch number %d not found for medication ID %d.\n", batch_no, medID);
-            return;
-        }
-        printf("enter the new quantity of medication\n");
-        int new_qty;
-        scanf("%d", &new_qty);
-        med->Batch[i].qty_instock = new_qty;
-        printf("Batch number %d updated successfully for medication ID %d.\n", batch_no, medID);
-    }
-}
-
-B *precedingNode(B *node, int index)
-{
-    B *current = node->children[index];
-    while (current->children[0] != NULL)
-        current = current->children[current->num_keys];
-    return current;
-}
-
-B *successiveNode(B *node, int index)
-{
-    B *current = node->children[index + 1];
-    while (current->children[0] != NULL)
-        current = current->children[0];
-    return current;
-}
-
-B *borrowFromPrev(B *node, int index)
-{
-    B *child = node->children[index];
-    B *sibling = node->children[index - 1];
-
-    for (int i = child->num_keys - 1; i >= 0; i--)
-    {
-        child->keys[i + 1] = child->keys[i];
-        child->values[i + 1] = child->values[i];
-    }
-
-    if (!child->is_leaf)
-    {
-        for (int i = child->num_keys; i >= 0; i--)
-            child->children[i + 1] = child->children[i];
-    }
-
-    child->keys[0] = node->keys[index - 1];
-    child->values[0] = node->values[index - 1];
-
-    if (!child->is_leaf)
-        child->children[0] = sibling->children[sibling->num_keys];
-
-    node->keys[index - 1] = sibling->keys[sibling->num_keys - 1];
-    node->values[index - 1] = sibling->values[sibling->num_keys - 1];
-
-    child->num_keys++;
-    sibling->num_keys--;
-
-    return node;
-}
-
-B *borrowFromNext(B *node, int index)
-{
-    B *child = node->children[index];
-    B *sibling = node->children[index + 1];
-
-    child->keys[child->num_keys] = node->keys[index];
-    child->values[child->num_keys] = node->values[index];
-
-    if (!child->is_leaf)
-        child->children[child->num_keys + 1] = sibling->children[0];
-
-    node->keys[index] = sibling->keys[0];
-    node->values[index] = sibling->values[0];
-
-    for (int i = 1; i < sibling->num_keys; i++)
-    {
-        sibling->keys[i - 1] = sibling->keys[i];
-        sibling->values[i - 1] = sibling->values[i];
-    }
-
-    if (!sibling->is_leaf)
-    {
-        for (int i = 1; i <= sibling->num_keys; i++)
-            sibling->children[i - 1] = sibling->children[i];
-    }
-
-    child->num_keys++;
-    sibling->num_keys--;
-
-    return node;
-}
-
-B *mergeNodes(B *node, int index)
-{
-    B *child = node->children[index];
-    B *sibling = node->children[index + 1];
-
-    child->keys[MIN_KEYS] = node->keys[index];
-    child->values[MIN_KEYS] = node->values[index];
-
-    for (int i = 0; i < sibling->num_keys; i++)
-    {
-        child->keys[i + MIN_KEYS + 1] = sibling->keys[i];
-        child->values[i + MIN_KEYS + 1] = sibling->values[i];
-    }
-
-    if (!child->is_leaf)
-    {
-        for (int i = 0; i <= sibling->num_keys; i++)
-            child->children[i + MIN_KEYS + 1] = sibling->children[i];
-    }
-
-    for (int i = index + 1; i < node->num_keys; i++)
-    {
-        node->keys[i - 1] = node->keys[i];
-        node->values[i - 1] = node->values[i];
-    }
-
-    for (int i = index + 2; i <= node->num_keys; i++)
-        node->children[i - 1] = node->children[i];
-
-    child->num_keys += sibling->num_keys + 1;
-    node->num_keys--;
-
-    free(sibling);
-    return node;
-}
-
-B *deleteFromBTree(B *root, int key)
-{
-    if (!root)
-        return NULL;
-
-    int i = 0;
-    while (i < root->num_keys && key > root->keys[i])
-        i++;
-
-    if (i < root->num_keys && key == root->keys[i])
-    {
-        if (root->is_leaf)
-        {
-            for (int j = i; j < root->num_keys - 1; j++)
-            {
-                root->keys[j] = root->keys[j + 1];
-                root->values[j] = root->values[j + 1];
-            }
-            root->num_keys--;
-        }
-        else
-        {
-            if (root->children[i]->num_keys >= MIN_KEYS + 1)
-            {
-                B *pred = precedingNode(root, i);
-                root->keys[i] = pred->keys[pred->num_keys - 1];
-                root->values[i] = pred->values[pred->num_keys - 1];
-                root->children[i] = deleteFromBTree(root->children[i], root->keys[i]);
-            }
-            else if (root->children[i + 1]->num_keys >= MIN_KEYS + 1)
-            {
-                B *succ = successiveNode(root, i);
-                root->keys[i] = succ->keys[0];
-                root->values[i] = succ->values[0];
-                root->children[i + 1] = deleteFromBTree(root->children[i + 1], root->keys[i]);
-            }
-            else
-            {
-                mergeNodes(root, i);
-                root->children[i] = deleteFromBTree(root->children[i], key);
-            }
-        }
-    }
-    else if (!root->is_leaf)
-    {
-        if (root->children[i]->num_keys < MIN_KEYS + 1)
-        {
-            if (i > 0 && root->children[i - 1]->num_keys >= MIN_KEYS + 1)
-                borrowFromPrev(root, i);
-            else if (i < root->num_keys && root->children[i + 1]->num_keys >= MIN_KEYS + 1)
-                borrowFromNext(root, i);
-            else
-            {
-                if (i < root->num_keys)
-                    mergeNodes(root, i);
-                else
-                    mergeNodes(root, i - 1);
-            }
-        }
-        root->children[i] = deleteFromBTree(root->children[i], key);
-    }
-
-    if (root->num_keys == 0)
-    {
-        B *temp = root;
-        root = root->children[0];
-        free(temp);
-    }
-
-    return root;
-}
-
-B_str *mergeBTreeStr(B_str *node, int index)
-{
-    B_str *child = node->children[index];
-    B_str *sibling = node->children[index + 1];
-
-    // Move key and value from parent to child
-    child->keys[child->num_keys] = node->keys[index];
-    child->values[child->num_keys] = node->values[index];
-    child->num_keys++;
-
-    // Merge keys and values from sibling
-    for (int i = 0; i < sibling->num_keys; i++)
-    {
-        child->keys[child->num_keys] = sibling->keys[i];
-        child->values[child->num_keys] = sibling->values[i];
-        child->num_keys++;
-    }
-
-    // Merge children
-    if (!child->is_leaf)
-    {
-        for (int i = 0; i <= sibling->num_keys; i++)
-        {
-            child->children[child->num_keys - sibling->num_keys + i] = sibling->children[i];
-        }
-    }
-
-    // Shift keys, values and children in parent
-    for (int i = index; i < node->num_keys - 1; i++)
-    {
-        node->keys[i] = node->keys[i + 1];
-        node->values[i] = node->values[i + 1];
-    }
-    for (int i = index + 1; i <= node->num_keys; i++)
-    {
-        node->children[i] = node->children[i + 1];
-    }
-
-    node->num_keys--;
-    free(sibling);
-    return node;
-}
-B_str *deleteFromBTreeStr(B_str *node, char *key)
-{
-    if (node == NULL)
-        return NULL;
-
-    int i = 0;
-    while (i < node->num_keys && strcmp(key, node->keys[i]) > 0)
-        i++;
-
-    if (i < node->num_keys && strcmp(key, node->keys[i]) == 0)
-    {
-        if (node->is_leaf)
-        {
-            free(node->keys[i]);
-            for (int j = i; j < node->num_keys - 1; j++)
-            {
-                node->keys[j] = node->keys[j + 1];
-                node->values[j] = node->values[j + 1];
-            }
-            node->num_keys--;
-        }
-        else
-        {
-            B_str *pred = node->children[i];
-            while (!pred->is_leaf)
-                pred = pred->children[pred->num_keys];
-
-            free(node->keys[i]);
-            node->keys[i] = strdup(pred->keys[pred->num_keys - 1]);
-            node->values[i] = pred->values[pred->num_keys - 1];
-
-            node->children[i] = deleteFromBTreeStr(node->children[i], pred->keys[pred->num_keys - 1]);
-        }
-    }
-    else if (!node->is_leaf)
-    {
-        node->children[i] = deleteFromBTreeStr(node->children[i], key);
-
-        if (node->children[i] && node->children[i]->num_keys < (ORDER - 1) / 2)
-        {
-            // Borrow from previous sibling
-            if (i > 0 && node->children[i - 1]->num_keys > (ORDER - 1) / 2)
-            {
-                B_str *child = node->children[i];
-                B_str *sibling = node->children[i - 1];
-
-                for (int j = child->num_keys; j > 0; j--)
-                {
-                    child->keys[j] = child->keys[j - 1];
-                    child->values[j] = child->values[j - 1];
-                }
-
-                if (!child->is_leaf)
-                {
-                    for (int j = child->num_keys + 1; j > 0; j--)
-                        child->children[j] = child->children[j - 1];
-                }
-
-                child->keys[0] = strdup(node->keys[i - 1]);
-                child->values[0] = node->values[i - 1];
-
-                if (!child->is_leaf)
-                    child->children[0] = sibling->children[sibling->num_keys];
-
-                node->keys[i - 1] = sibling->keys[sibling->num_keys - 1];
-                node->values[i - 1] = sibling->values[sibling->num_keys - 1];
-
-                sibling->num_keys--;
-                child->num_keys++;
-            }
-            // Borrow from next sibling
-            else if (i < node->num_keys && node->children[i + 1]->num_keys > (ORDER - 1) / 2)
-            {
-                B_str *child = node->children[i];
-                B_str *sibling = node->children[i + 1];
-
-                child->keys[child->num_keys] = strdup(node->keys[i]);
-                child->values[child->num_keys] = node->values[i];
-
-                if (!child->is_leaf)
-                    child->children[child->num_keys + 1] = sibling->children[0];
-
-                node->keys[i] = sibling->keys[0];
-                node->values[i] = sibling->values[0];
-
-                for (int j = 1; j < sibling->num_keys; j++)
-                {
-                    sibling->keys[j - 1] = sibling->keys[j];
-                    sibling->values[j - 1] = sibling->values[j];
-                }
-
-                if (!sibling->is_leaf)
-                {
-                    for (int j = 1; j <= sibling->num_keys; j++)
-                        sibling->children[j - 1] = sibling->children[j];
-                }
-
-                sibling->num_keys--;
-                child->num_keys++;
-            }
-            // Merge
-            else
-            {
-                node = mergeBTreeStr(node, i);
-            }
-        }
-    }
-
-    return node;
-}
-
-B_supp *deleteFromBTreeSupp(B_supp *root, int key)
-{
-    return (B_supp *)deleteFromBTree((B *)root, key);
-}
-
-data *search_medID(B *root, int medID)
-{
-    if (root == NULL)
-        return NULL;
-
-    int i = 0;
-    while (i < root->num_keys && medID > root->keys[i])
-        i++;
-
-    if (i < root->num_keys && medID == root->keys[i])
-        return root->values[i];
-
-    if (root->is_leaf)
-        return NULL;
-
-    return search_medID(root->children[i], medID);
-}
-
-void deleteMedication(B **root, B_str **nameRoot, B_str **dateRoot, B_supp **supplierRoot, int medID, int batch_no)
-{
-    if (medID == -1)
-    {
-        printf("Invalid medication ID.\n");
-        return;
-    }
-
-    // Search for the medication
-    data *med = search_medID(*root, medID);
-    if (med == NULL)
-    {
-        printf("Medication with ID %d not found.\n", medID);
-        return;
-    }
-
-    if (batch_no == -1) // Delete entire medication
-    {
-        printf("Deleting medication with ID %d.\n", medID);
-
-        // Remove from medIDTree
-        *root = deleteFromBTree(*root, medID);
-
-        // Remove from mednameTree
-        *nameRoot = deleteFromBTreeStr(*nameRoot, med->medname);
-
-        // Remove all associated batches from expDateTree
-        for (int i = 0; i < med->batch_count; i++)
-        {
-            *dateRoot = deleteFromBTreeStr(*dateRoot, med->Batch[i].exp_date);
-        }
-
-        // Remove from supplierTree
-        for (int i = 0; i < med->batch_count; i++)
-        {
-            for (int i = 0; i < med->batch_count; i++)
-            {
-                for (int j = 0; j < med->Batch[i].supplier_count; j++)
-                {
-                    // CORRECT: suppliers[j] is a pointer, so use ->
-                    int suppID = med->Batch[i].suppliers[j]->supplier_id;
-                    *supplierRoot = deleteFromBTreeSupp(*supplierRoot, suppID);
-                }
-            }
-            free(med);
-        }
-
-        free(med);
-    }
-    else // Delete specific batch
-    {
-        int found = 0;
-        for (int i = 0; i < med->batch_count; i++)
-        {
-            if (med->Batch[i].batch_no == batch_no)
-            {
-
-                found = 1;
-                // Remove batch from expDateTree
-                *dateRoot = deleteFromBTreeStr(*dateRoot, med->Batch[i].exp_date);
-                // Shift remaining batches left
-                for (int j = i; j < med->batch_count - 1; j++)
-                {
-                    med->Batch[j] = med->Batch[j + 1];
-                }
-                med->batch_count--;
-
-                printf("Deleted batch %d from medication ID %d.\n", batch_no, medID);
-
-                // If all batches are deleted, remove medication completely
-                if (med->batch_count == 0)
-                {
-                    deleteMedication(root, nameRoot, dateRoot, supplierRoot, medID, -1);
-                }
-                break;
-            }
-        }
-        if (!found)
-        {
-            printf("Batch number %d not found for medication ID %d.\n", batch_no, medID);
-        }
-    }
-    printf("\n");
-}
-
-void checkexpirydate(B_str *expDateTree, char *currentdate)
-{
-    if (expDateTree == NULL)
-    {
-        printf("Tree is empty.\n");
-        return;
-    }
-
-    // Convert input date (DD-MM-YYYY) to YYYY-MM-DD for comparison
-    char formatted_current[11];
-    convert_date_format(currentdate, formatted_current); // You already have this function
-
-    B_str *root = expDateTree;
-
-    for (int i = 0; i < root->num_keys; i++)
-    {
-        char formatted_tree_date[11];
-        reverse_date_format(root->keys[i], formatted_tree_date); // For printing in DD-MM-YYYY
-
-        if (strcmp(root->keys[i], formatted_current) < 0)
-        {
-            printf("Medication with ID %d and name %s has an expired batch with expiry date %s.\n",
-                   root->values[i]->medID, root->values[i]->medname, formatted_tree_date);
-        }
-        else
-        {
-            int year1, month1, day1, year2, month2, day2;
-            sscanf(formatted_current, "%d-%d-%d", &year1, &month1, &day1);
-            sscanf(root->keys[i], "%d-%d-%d", &year2, &month2, &day2);
-
-            int days_diff = (year2 - year1) * 365 + (month2 - month1) * 30 + (day2 - day1);
-            if (days_diff <= 30 && days_diff >= 0)
-            {
-                printf("Medication with ID %d and name %s has a batch expiring soon (expiry date: %s).\n",
-                       root->values[i]->medID, root->values[i]->medname, formatted_tree_date);
-            }
-        }
-    }
-
-    if (!root->is_leaf)
-    {
-        for (int i = 0; i <= root->num_keys; i++)
-        {
-            checkexpirydate(root->children[i], currentdate);
-        }
-    }
-}
-
-void addsupplier()
-{
-    printf("Enter the medication ID and batch number to be supplied: ");
-    int medID, batch_no;
-    scanf("%d %d", &medID, &batch_no);
-
-    data *med = search_medID(medIDTree, medID);
-    if (med == NULL)
-    {
-        printf("Medication with ID %d not found.\n", medID);
-    }
-
-    // Find the batch
-    int i;
-    for (i = 0; i < med->batch_count; i++)
-    {
-        if (med->Batch[i].batch_no == batch_no)
-            break;
-    }
-    if (i == med->batch_count)
-    {
-        printf("Batch number %d not found for medication ID %d.\n", batch_no, medID);
-    }
-
-    printf("Enter the supplier ID: ");
-    int supplier_id;
-    scanf("%d", &supplier_id);
-
-    supplier *existingSupplier = search_supplier(supplierTree, supplier_id);
-    if (existingSupplier == NULL)
-    {
-        // New supplier
-        existingSupplier = (supplier *)malloc(sizeof(supplier));
-        if (!existingSupplier)
-        {
-            printf("Memory allocation failed for supplier.\n");
-        }
-
-        existingSupplier->supplier_id = supplier_id;
-        printf("Supplier Name: ");
-        scanf("%s", existingSupplier->supp_name);
-        printf("Quantity of Supply: ");
-        scanf("%d", &existingSupplier->qty_of_supply);
-        printf("Contact: ");
-        scanf("%lld", &existingSupplier->contact);
-
-        existingSupplier->med_count = 0;
-        suppliers_active[supplier_id] = 1;
-    }
-
-    // Link supplier to batch
-    if (med->Batch[i].supplier_count < MAX_SUPPLIERS)
-    {
-        // Check if supplier already linked to this batch
-        for (int j = 0; j < med->Batch[i].supplier_count; j++)
-        {
-            if (med->Batch[i].suppliers[j] &&
-                med->Batch[i].suppliers[j]->supplier_id == supplier_id)
-            {
-                printf("Supplier already linked to this batch.\n");
-            }
-        }
-
-        med->Batch[i].suppliers[med->Batch[i].supplier_count] = existingSupplier;
-        med->Batch[i].supplier_count++;
-    }
-    else
-    {
-        printf("Maximum suppliers reached for this batch.\n");
-    }
-
-    // Link medication to supplier if not already linked
-    Boolean medExists = false;
-    for (int j = 0; j < existingSupplier->med_count; j++)
-    {
-        if (existingSupplier->medications[j] &&
-            existingSupplier->medications[j]->medID == medID)
-        {
-            medExists = true;
-            break;
-        }
-    }
-
-    if (!medExists && existingSupplier->med_count < MAX_MEDS_PER_SUPP)
-    {
-        existingSupplier->medications[existingSupplier->med_count] = med;
-        existingSupplier->med_count++;
-    }
-
-    printf("Supplier added successfully to batch %d of medication %s (ID: %d)\n",
-           batch_no, med->medname, medID);
-    insert_supp(&supplierTree, supplier_id, existingSupplier);
-}
-// Function to delete a supplier from the system
-void deleteSupplier(B_supp **supplierTree)
-{
-    if (*supplierTree == NULL)
-    {
-        printf("Supplier tree is empty.\n");
-        return;
-    }
-    int supplier_id;
-    printf("Enter supplier id to be deleted: ");
-    scanf("%d", &supplier_id);
-    // Search for the supplier first
-    supplier *suppToDelete = search_supplier(*supplierTree, supplier_id);
-    if (suppToDelete == NULL)
-    {
-        printf("Supplier with ID %d not found.\n", supplier_id);
-        return;
-    }
-
-    // Check if supplier is linked to any medications
-    if (suppToDelete->med_count > 0)
-    {
-        printf("Warning: Supplier is linked to %d medications. Deleting anyway...\n", suppToDelete->med_count);
-
-        // Remove supplier references from all linked medications
-        for (int i = 0; i < suppToDelete->med_count; i++)
-        {
-            if (suppToDelete->medications[i] != NULL)
-            {
-                data *med = suppToDelete->medications[i];
-
-                // Remove supplier from all batches of this medication
-                for (int j = 0; j < med->batch_count; j++)
-                {
-                    batch *currentBatch = &med->Batch[j];
-
-                    // Find and remove supplier from this batch
-                    for (int k = 0; k < currentBatch->supplier_count; k++)
-                    {
-                        if (currentBatch->suppliers[k] != NULL &&
-                            currentBatch->suppliers[k]->supplier_id == supplier_id)
-                        {
-
-                            // Shift remaining suppliers left
-                            for (int l = k; l < currentBatch->supplier_count - 1; l++)
-                            {
-                                currentBatch->suppliers[l] = currentBatch->suppliers[l + 1];
-                            }
-                            currentBatch->supplier_count--;
-                            break; // Found and removed, move to next batch
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    // Now delete from the B-tree
-    *supplierTree = deleteFromBTreeSupp(*supplierTree, supplier_id);
-
-    // Update active suppliers array
-    suppliers_active[supplier_id] = 0;
-
-    printf("Supplier with ID %d deleted successfully.\n", supplier_id);
-}
-void collectSupplierMedCounts(B_supp *node, int *frequency, int *supplierIDs)
-{
-    if (node == NULL)
-        return;
-
-    for (int i = 0; i < node->num_keys; i++)
-    {
-        if (!node->is_leaf)
-        {
-            collectSupplierMedCounts(node->children[i], frequency, supplierIDs);
-        }
-
-        int supplierID = node->keys[i];
-        frequency[supplierID] = node->values[i]->med_count; // Ensure med_count is updated correctly
-        supplierIDs[supplierID] = supplierID;
-    }
-
-    if (!node->is_leaf)
-    {
-        collectSupplierMedCounts(node->children[node->num_keys], frequency, supplierIDs);
-    }
-}
-void top10Allrounders()
-{
-    int frequency[500] = {0};
-    int supplierIDs[500] = {0};
-
-    collectSupplierMedCounts(supplierTree, frequency, supplierIDs);
-
-    // Heap sort both arrays together
-    Heapsort(frequency, supplierIDs, 500); // Sort in ascending order
-
-    printf("Top 10 Suppliers based on No. of Unique Medications:\n");
-    int found = 0;
-    for (int i = 499; i >= 490; i--) // Get top 10 from the end (since it's ascending)
-    {
-        if (frequency[i] > 0)
-        {
-            printf("Supplier ID: %d, Unique Medications Supplied: %d\n", supplierIDs[i], frequency[i]);
-            found++;
-        }
-    }
-
-    if (found == 0)
-    {
-        printf("No suppliers have supplied any medications.\n");
-    }
-}
-
-void searchbysupplier()
-{
-    supplier *temp;
-    int sup_id;
-    printf("enter supplier id whose meds u wanna know");
-    scanf("%d", &sup_id);
-    temp = search_supplier(supplierTree, sup_id);
-    for (int i = 0; i < temp->med_count; i++)
-    {
-        printf("Supplies Medicine %s \n", temp->medications[i]->medname);
-        printf("Med ID:%d", temp->medications[i]->medID);
-        printf("Batch Count: %d\n", temp->medications[i]->batch_count);
-        printf("Reorder Level: %d\n", temp->medications[i]->reorder_lvl);
-        printf("Price per unit: %d\n", temp->medications[i]->priceperunit);
-    }
-}
-// Function to update supplier contact and quantity of supply
-void updateSupplier(B_supp *supplierTree)
-{
-    if (supplierTree == NULL)
-    {
-        printf("Supplier tree is empty.\n");
-        return;
-    }
-    int supplier_id;
-    printf("Enter supplier id to be updated: ");
-    scanf("%d", &supplier_id);
-    // Search for the supplier
-    supplier *suppToUpdate = search_supplier(supplierTree, supplier_id);
-    if (suppToUpdate == NULL)
-    {
-        printf("Supplier with ID %d not found.\n", supplier_id);
-        return;
-    }
-
-    printf("\nCurrent Supplier Details:\n");
-    printf("Supplier ID: %d\n", suppToUpdate->supplier_id);
-    printf("1. Quantity of Supply: %d\n", suppToUpdate->qty_of_supply);
-    printf("2. Contact: %lld\n", suppToUpdate->contact);
-
-    int choice;
-    printf("Choose an option to update:\n");
-    printf("0. Cancel\n");
-    printf("1. Update Quantity of Supply\n");
-    printf("2. Update Contact\n");
-    printf("3. Update Both\n");
-    printf("Enter your choice: ");
-    scanf("%d", &choice);
-
-    switch (choice)
-    {
-    case 0:
-        printf("Update cancelled.\n");
-        break;
-    case 1: // Update quantity
-        printf("Enter new quantity of supply: ");
-        scanf("%d", &suppToUpdate->qty_of_supply);
-
-        // Update quantity in all linked batches
-        for (int i = 0; i < suppToUpdate->med_count; i++)
-        {
-            if (suppToUpdate->medications[i] != NULL)
-            {
-                data *med = suppToUpdate->medications[i];
-                for (int j = 0; j < med->batch_count; j++)
-                {
-                    for (int k = 0; k < med->Batch[j].supplier_count; k++)
-                    {
-                        if (med->Batch[j].suppliers[k] != NULL &&
-                            med->Batch[j].suppliers[k]->supplier_id == supplier_id)
-                        {
-                            med->Batch[j].suppliers[k]->qty_of_supply = suppToUpdate->qty_of_supply;
-                        }
-                    }
-                }
-            }
-        }
-        printf("Quantity of supply updated successfully.\n");
-        break;
-    case 2: // Update contact
-        printf("Enter new contact number: ");
-        scanf("%lld", &suppToUpdate->contact);
-        for (int i = 0; i < suppToUpdate->med_count; i++)
-        {
-            if (suppToUpdate->medications[i] != NULL)
-            {
-                data *med = suppToUpdate->medications[i];
-                for (int j = 0; j < med->batch_count; j++)
-                {
-                    for (int k = 0; k < med->Batch[j].supplier_count; k++)
-                    {
-                        if (med->Batch[j].suppliers[k] != NULL &&
-                            med->Batch[j].suppliers[k]->supplier_id == supplier_id)
-                        {
-                            med->Batch[j].suppliers[k]->contact = suppToUpdate->contact;
-                        }
-                    }
-                }
-            }
-        }
-        printf("Contact number updated successfully.\n");
-        break;
-    case 3: // Update both
-        printf("Enter new quantity of supply: ");
-        scanf("%d", &suppToUpdate->qty_of_supply);
-        printf("Enter new contact number: ");
-        scanf("%lld", &suppToUpdate->contact);
-
-        // Update quantity and contact in all linked batches
-        for (int i = 0; i < suppToUpdate->med_count; i++)
-        {
-            if (suppToUpdate->medications[i] != NULL)
-            {
-                data *med = suppToUpdate->medications[i];
-                for (int j = 0; j < med->batch_count; j++)
-                {
-                    for (int k = 0; k < med->Batch[j].supplier_count; k++)
-                    {
-                        if (med->Batch[j].suppliers[k] != NULL &&
-                            med->Batch[j].suppliers[k]->supplier_id == supplier_id)
-                        {
-                            med->Batch[j].suppliers[k]->qty_of_supply = suppToUpdate->qty_of_supply;
-                            med->Batch[j].suppliers[k]->contact = suppToUpdate->contact; // <- FIXED
-                        }
-                    }
-                }
-            }
-        }
-        printf("Supplier details updated successfully.\n");
-        break;
-
-    default:
-        printf("Invalid choice.\n");
-        break;
-    }
-}
-void searchsupplierByID()
-{
-    printf("Enter Supplier ID to search: ");
-    int supplier_id;
-    scanf("%d", &supplier_id);
-    supplier *foundSupplier = search_supplier(supplierTree, supplier_id);
-    if (foundSupplier != NULL)
-    {
-        printf("Supplier found:\n");
-        printf("ID: %d\n", foundSupplier->supplier_id);
-        printf("Name: %s\n", foundSupplier->supp_name);
-        printf("Quantity of Supply: %d\n", foundSupplier->qty_of_supply);
-        printf("Contact: %lld\n", foundSupplier->contact);
-        printf("Medications Supplied:\n");
-        for (int i = 0; i < foundSupplier->med_count; i++)
-        {
-            if (foundSupplier->medications[i] != NULL)
-            {
-                printf("  - %s (ID: %d)\n",
-                       foundSupplier->medications[i]->medname,
-                       foundSupplier->medications[i]->medID);
-            }
-        }
-    }
-    else
-    {
-        printf("Supplier with ID %d not found.\n", supplier_id);
-    }
-}
-void supplierManagement()
-{
-    int choice;
-    printf("Enter 1 for adding supplier\nEnter 2 for deleting supplier\nEnter 3 for updating supplier\nEnter 4 for searching supplier\n");
-    scanf("%d", &choice);
-    switch (choice)
-    {
-    case 1:
-        addsupplier();
-        break;
-    case 2:
-        deleteSupplier(&supplierTree);
-        break;
-    case 3:
-        updateSupplier(supplierTree);
-        break;
-    case 4:
-        searchsupplierByID();
-        break;
-    }
-}
-
-void stockAlerts(B *root)
-{
-    if (root == NULL)
-        return;
-
-    for (int i = 0; i < root->num_keys; i++)
-    {
-        data *med = root->values[i];
-        int totalQtyInStock = 0;
-
-        for (int j = 0; j < med->batch_count; j++)
-        {
-            totalQtyInStock += med->Batch[j].qty_instock;
-        }
-
-        if (totalQtyInStock <= med->reorder_lvl)
-        {
-            printf("Stock alert: Medication \"%s\" (ID: %d)\n", med->medname, med->medID);
-            printf("Current stock: %d | Reorder level: %d\n", totalQtyInStock, med->reorder_lvl);
-        }
-
-        stockAlerts(root->children[i]); // Traverse left children
-    }
-
-    // Traverse the rightmost child (not handled in loop above)
-    stockAlerts(root->children[root->num_keys]);
-}
-void sortMedicationByExpiry(B_str *node, const char *date1, const char *date2)
-{
-    if (node == NULL)
-        return;
-
-    // Convert input range from DD-MM-YYYY to YYYY-MM-DD
-    char start_date[11], end_date[11];
-    convert_date_format(date1, start_date);
-    convert_date_format(date2, end_date);
-
-    int i = 0;
-    while (i < node->num_keys)
-    {
-        // Traverse left subtree if needed
-        if (!node->is_leaf && (i == 0 || strcmp(node->keys[i], start_date) >= 0))
-        {
-            sortMedicationByExpiry(node->children[i], date1, date2); // reuse original input
-        }
-
-        // Check if key lies in [start_date, end_date]
-        if (strcmp(node->keys[i], start_date) >= 0 && strcmp(node->keys[i], end_date) <= 0)
-        {
-            data *med = node->values[i];
-            if (med != NULL)
-            {
-                char formatted_exp[11];
-                reverse_date_format(node->keys[i], formatted_exp);
-
-                printf("Medication ID: %d, Name: %s, Expiry Date: %s\n",
-                       med->medID, med->medname, formatted_exp);
-            }
-        }
-
-        i++;
-    }
-
-    if (!node->is_leaf)
-    {
-        if (strcmp(node->keys[node->num_keys - 1], end_date) <= 0)
-        {
-            sortMedicationByExpiry(node->children[i], date1, date2);
-        }
-    }
-}
-
-void salesTracking(B *node, int medID, int qtySold)
-{
-    if (node == NULL || qtySold <= 0)
-    {
-        printf("Invalid request.\n");
-        return;
-    }
-
-    int i = 0;
-    while (i < node->num_keys && medID > node->keys[i])
-    {
-        i++;
-    }
-
-    if (i < node->num_keys && node->keys[i] == medID)
-    {
-        data *med = node->values[i];
-        if (med == NULL || med->batch_count == 0)
-        {
-            printf("No batches available for medication ID %d.\n", medID);
-            return;
-        }
-
-        // sort batches so that medications that expire earlier are sold first
-        sortBatchesByExpiry(med->Batch, med->batch_count);
-
-        int remaining = qtySold;
-        int batches_used = 0;
-
-        for (int j = 0; j < med->batch_count && remaining > 0; j++)
-        {
-            if (med->Batch[j].qty_instock > 0)
-            {
-                int sell = (med->Batch[j].qty_instock >= remaining) ? remaining : med->Batch[j].qty_instock;
-
-                med->Batch[j].qty_instock -= sell;
-                remaining -= sell;
-                batches_used++;
-
-                printf("Sold %d units from batch %d (remaining: %d)\n",
-                       sell, med->Batch[j].batch_no, med->Batch[j].qty_instock);
-
-                if (med->Batch[j].qty_instock == 0)
-                {
-                    med->batch_count--;
-                    for (int k = j; k < med->batch_count; k++)
-                    {
-                        med->Batch[k] = med->Batch[k + 1];
-                    }
-                    j--; // stay on the new batch at this index
-                }
-            }
-        }
-
-        if (remaining == 0)
-        {
-            printf("Successfully sold %d units of medication ID %d across %d batches.\n",
-                   qtySold, medID, batches_used);
-        }
-        else
-        {
-            printf("Partial sale: Only %d/%d units sold for medication ID %d.\n",
-                   (qtySold - remaining), qtySold, medID);
-        }
-        return;
-    }
-
-    if (!node->is_leaf)
-    {
-        salesTracking(node->children[i], medID, qtySold);
-    }
-    else
-    {
-        printf("Medication ID %d not found.\n", medID);
-    }
-}
-
-void collectSupplierTurnovers(B *medRoot, int *turnover, int *supplierIDs)
-{
-    if (medRoot == NULL)
-        return;
-
-    // Traverse left children
-    for (int i = 0; i < medRoot->num_keys; i++)
-    {
-        if (!medRoot->is_leaf)
-            collectSupplierTurnovers(medRoot->children[i], turnover, supplierIDs);
-
-        data *med = medRoot->values[i];
-        int price = med->priceperunit;
-
-        for (int b = 0; b < med->batch_count; b++)
-        {
-            batch *bt = &med->Batch[b];
-
-            for (int s = 0; s < bt->supplier_count; s++)
-            {
-                supplier *supp = bt->suppliers[s];
-                int suppID = supp->supplier_id;
-                supplierIDs[suppID] = suppID;
-
-                // Now find quantity supplied by this supplier for this batch
-                // We'll extract it from the batch entry directly
-                // We'll assume the qty supplied is stored in the qty_of_supply field
-                // of the supplier struct ONLY for this batch entry (as parsed from file)
-                int qty_supplied = supp->qty_of_supply;
-
-                turnover[suppID] += price * qty_supplied;
-            }
-        }
-    }
-
-    // Traverse the rightmost child
-    if (!medRoot->is_leaf)
-        collectSupplierTurnovers(medRoot->children[medRoot->num_keys], turnover, supplierIDs);
-}
-
-void top10largestturnover()
-{
-    if (!medIDTree) // Assuming this is the root of your B-tree for meds
-    {
-        printf("Medication tree is empty.\n");
-        return;
-    }
-
-    int turnover[500] = {0};
-    int supplierIDs[500] = {0};
-
-    collectSupplierTurnovers(medIDTree, turnover, supplierIDs);
-
-    // Sort both arrays in ascending order using Heapsort
-    Heapsort(turnover, supplierIDs, 500);
-
-    printf("Top 10 suppliers by turnover:\n");
-    int found = 0;
-    for (int i = 499; i >= 490; i--) // top 10 from the end
-    {
-        if (turnover[i] > 0)
-        {
-            printf("Supplier ID: %d, Turnover: %d\n", supplierIDs[i], turnover[i]);
-            found++;
-        }
-    }
-
-    if (found == 0)
-    {
-        printf("No suppliers have non-zero turnover.\n");
-    }
-}
-
-void searchMedication()
-{
-    printf("Enter 1 to search by medID\nEnter 2 to search by medName\nEnter 3 to search by supplier\n");
-    int choice;
-    scanf("%d", &choice);
-    switch (choice)
-    {
-    case 1:
-    {
-        printf("Enter medication ID to search: ");
-        int medID;
-        scanf("%d", &medID);
-        searchMedicationBymedId(medID, medIDTree);
-        break;
-    }
-    case 2:
-    {
-        printf("Enter medication name to search: ");
-        char medName[MAX_NAME_LENGTH];
-        scanf("%s", medName);
-        searchMedicationBymedname(medName, mednameTree);
-        break;
-    }
-    case 3:
-    {
-        searchbysupplier();
-        break;
-    }
-    }
-}
-void writeMedicationsToFileRecursive(B *node, FILE *fp)
-{
-    if (!node || !fp)
-        return;
-
-    for (int i = 0; i < node->num_keys; i++)
-    {
-        if (node->children[i])
-            writeMedicationsToFileRecursive(node->children[i], fp);
-
-        data *med = node->values[i];
-        if (!med)
-            continue;
-
-        // Write medication line
-        fprintf(fp, "%d,%s,%d,%d\n", med->medID, med->medname, med->priceperunit, med->reorder_lvl);
-
-        for (int j = 0; j < med->batch_count; j++)
-        {
-            batch *b = &med->Batch[j];
-
-            // Convert expiry date format before writing
-            char reversed_date[MAX_DATE_LENGTH];
-            reverse_date_format(b->exp_date, reversed_date);
-
-            fprintf(fp, "%d,%s,%d\n", b->batch_no, reversed_date, b->qty_instock);
-
-            for (int k = 0; k < b->supplier_count; k++)
-            {
-                supplier *s = b->suppliers[k];
-                fprintf(fp, "%d,%s,%d,%lld\n", s->supplier_id, s->supp_name, s->qty_of_supply, s->contact);
-            }
-
-            fprintf(fp, "###\n"); // Separate batches
-        }
-
-        fprintf(fp, "END\n"); // End of medication
-    }
-
-    if (node->children[node->num_keys])
-        writeMedicationsToFileRecursive(node->children[node->num_keys], fp);
-}
-
-void saveMedicationsToFile()
-{
-    FILE *fp = fopen("medications_data.txt", "w");
-    if (!fp)
-    {
-        printf("Error opening file for writing.\n");
-        return;
-    }
-
-    writeMedicationsToFileRecursive(medIDTree, fp);
-    fclose(fp);
-    printf("Medication data successfully saved to file.\n");
-}
-void loadMedicationsFromFile()
-{
-    FILE *fp = fopen("medications_data.txt", "r");
-    if (!fp)
-    {
-        printf("No previous medication data found.\n");
-        return;
-    }
-
-    char line[256];
-    data *currentMed = NULL;
-    batch *currentBatch = NULL;
-
-    while (fgets(line, sizeof(line), fp))
-    {
-        if (strncmp(line, "END", 3) == 0)
-        {
-            currentMed = NULL;
-            currentBatch = NULL;
-            continue;
-        }
-
-        if (strncmp(line, "###", 3) == 0)
-        {
-            currentBatch = NULL;
-            continue;
-        }
-
-        if (currentMed == NULL)
-        {
-            // Medication line
-            int medID, priceperunit, reorder_lvl;
-            char medname[MAX_NAME_LENGTH];
-            sscanf(line, "%d,%[^,],%d,%d", &medID, medname, &priceperunit, &reorder_lvl);
-
-            currentMed = (data *)malloc(sizeof(data));
-            currentMed->medID = medID;
-            strncpy(currentMed->medname, medname, MAX_NAME_LENGTH);
-            currentMed->priceperunit = priceperunit;
-            currentMed->reorder_lvl = reorder_lvl;
-            currentMed->batch_count = 0;
-
-            insert_int(&medIDTree, medID, currentMed);
-            insert_str(&mednameTree, medname, currentMed);
-        }
-        else if (currentBatch == NULL)
-        {
-            // Batch line
-            int batch_no, qty_instock;
-            char exp_date[MAX_DATE_LENGTH];
-            sscanf(line, "%d,%[^,],%d", &batch_no, exp_date, &qty_instock);
-
-            if (currentMed->batch_count >= MAX_BATCHES)
-                continue;
-
-            currentBatch = &currentMed->Batch[currentMed->batch_count++];
-            currentBatch->batch_no = batch_no;
-
-            // Convert date format before storing and indexing
-            char formatted_date[MAX_DATE_LENGTH];
-            convert_date_format(exp_date, formatted_date);
-            strncpy(currentBatch->exp_date, formatted_date, MAX_DATE_LENGTH);
-
-            currentBatch->qty_instock = qty_instock;
-            currentBatch->supplier_count = 0;
-
-            insert_str(&expDateTree, currentBatch->exp_date, currentMed);
-        }
-        else
-        {
-            // Supplier line
-            int supplier_id, qty_supplied;
-            long long contact;
-            char supp_name[MAX_NAME_LENGTH];
-            sscanf(line, "%d,%[^,],%d,%lld", &supplier_id, supp_name, &qty_supplied, &contact);
-
-            supplier *s = search_supplier(supplierTree, supplier_id);
-
-            if (!s)
-            {
-                s = (supplier *)malloc(sizeof(supplier));
-                s->supplier_id = supplier_id;
-                strncpy(s->supp_name, supp_name, MAX_NAME_LENGTH);
-                s->qty_of_supply = 0;
-                s->contact = contact;
-                s->med_count = 0;
-
-                suppliers_active[supplier_id] = 1;
-                // DON'T insert into B-tree yet — wait till medication is fully linked
-            }
-            s->qty_of_supply += qty_supplied;
-
-            // Link supplier to current batch
-            if (currentBatch->supplier_count < MAX_SUPPLIERS)
-                currentBatch->suppliers[currentBatch->supplier_count++] = s;
-
-            // Link medication to supplier if not already added
-            Boolean medExists = false;
-            for (int i = 0; i < s->med_count; i++)
-            {
-                if (s->medications[i] && s->medications[i]->medID == currentMed->medID)
-                {
-                    medExists = true;
-                    break;
-                }
-            }
-
-            if (!medExists && s->med_count < MAX_MEDS_PER_SUPP)
-            {
-                s->medications[s->med_count++] = currentMed;
-            }
-
-            // Now insert supplier into B-tree after all linking
-            if (!search_supplier(supplierTree, supplier_id))
-            {
-                insert_supp(&supplierTree, supplier_id, s); // insert only now
-            }
-        }
-    }
-
-    fclose(fp);
-    printf("Medication data successfully loaded from file.\n");
-}
-
-int main()
-{
-    // Load existing data from file
-    loadMedicationsFromFile();
-
-    int choice;
-    do
-    {
-        printf("\n=== Pharmacy Management System ===\n");
-        printf("1. Add New Medication\n");
-        printf("2. Update Medication\n");
-        printf("3. Delete Medication\n");
-        printf("4. Search Medication\n");
-        printf("5. View Stock Alerts\n");
-        printf("6. Check Expiry Dates\n");
-        printf("7. Sort Medication by Expiry Dates\n");
-        printf("8. Track the sales\n");
-        printf("9. Supplier Management\n");
-        printf("10. Top 10 All-rounder Supplier\n");
-        printf("11. Top 10 Largest Turnover\n");
-        printf("12. To Exit\n");
-        printf("Enter your choice: ");
-        scanf("%d", &choice);
-
-        switch (choice)
-        {
-        case 1:
-        {
-            addMedicationGeneral(&medIDTree, &mednameTree, &expDateTree, &supplierTree);
-            saveMedicationsToFile(medIDTree);
-            break;
-        }
-        case 2:
-        {
-            int medID;
-            printf("Enter Medication ID to update: ");
-            scanf("%d", &medID);
-            updateMedication(medID);
-            saveMedicationsToFile(medIDTree);
-            break;
-        }
-        case 3:
-        {
-            int medID, batch_no;
-            printf("Enter Medication ID to delete: ");
-            scanf("%d", &medID);
-            printf("Enter Batch No.: ");
-            scanf("%d", &batch_no);
-            deleteMedication(&medIDTree, &mednameTree, &expDateTree, &supplierTree, medID, batch_no);
-            saveMedicationsToFile(medIDTree);
-            break;
-        }
-        case 4:
-        {
-            searchMedication();
-            break;
-        }
-        case 5:
-        {
-            stockAlerts(medIDTree);
-            break;
-        }
-        case 6:
-        {
-            char date[MAX_DATE_LENGTH];
-            printf("Enter current date (DD-MM-YYYY): ");
-            scanf(" %10s", date);
-            checkexpirydate(expDateTree, date);
-            break;
-        }
-        case 7:
-        {
-            char startDate[11], endDate[11];
-            printf("Enter the start date (DD-MM-YYYY): ");
-            scanf("%10s", startDate);
-            printf("Enter the end date (DD-MM-YYYY): ");
-            scanf("%10s", endDate);
-
-            printf("Medications with expiry dates between %s and %s:\n", startDate, endDate);
-            sortMedicationByExpiry(expDateTree, startDate, endDate);
-            printf("\n");
-            break;
-        }
-        case 8:
-        {
-            int medID, qtySold;
-            printf("Enter Medication ID to sell: ");
-            scanf("%d", &medID);
-            printf("Enter quantity to sell: ");
-            scanf("%d", &qtySold);
-            salesTracking(medIDTree, medID, qtySold);
-            saveMedicationsToFile(medIDTree);
-            break;
-        }
-        case 9:
-        {
-            supplierManagement();
-            saveMedicationsToFile(medIDTree);
-            break;
-        }
-        case 10:
-        {
-            top10Allrounders(supplierTree);
-            break;
-        }
-        case 11:
-        {
-            top10largestturnover(supplierTree);
-            break;
-        }
-        case 12:
-            printf("Exiting...\n");
-            saveMedicationsToFile(medIDTree);
-            break;
-        default:
-            printf("Invalid choice. Please try again.\n");
-        }
-    } while (choice != 12);
-
-    return 0;
+#define _GNU_SOURCE // accept4, pipe2
+#include <stdio.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/epoll.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <errno.h>
+#include <signal.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#define ORDER 4 // Order of the string-keyed B-trees
+#define MIN_KEYS ((ORDER - 1) / 2)
+#define INT_ORDER 16 // Order of the integer-keyed B-trees; a node's keys fill one AVX2 register pair
+#define INT_MIN_KEYS ((INT_ORDER - 1) / 2)
+#define MAX_SUPPLIERS 400    // Maximum suppliers in a batch
+#define MAX_BATCHES 100      // Maximum batches per medication
+#define MAX_MEDICATIONS 1000 // Maximum medications
+#define MAX_NAME_LENGTH 50   // Maximum length for names
+#define MAX_DATE_LENGTH 11
+#define ROLLUP_DAYS 64  // Days of per-medication daily sales kept in memory
+#define ROLLUP_WEEKS 64 // Weeks of per-medication weekly sales kept in memory
+
+typedef enum
+{
+    FAILURE,
+    SUCCESS
+} status_code;
+
+typedef enum
+{
+    false,
+    true
+} Boolean;
+
+int suppliers_active[MAX_SUPPLIERS] = {0}; // Array to track active suppliers
+Boolean quiet = false;                     // Suppresses load/save chatter (batch mode)
+
+pthread_rwlock_t index_lock = PTHREAD_RWLOCK_INITIALIZER; // Shared by sales, exclusive for writers (writeBegin)
+pthread_mutex_t supplier_lock = PTHREAD_MUTEX_INITIALIZER; // Guards supplier links and rankings during concurrent sales
+unsigned long long latest_snapshot_id = 0; // Newest snapshot; changes only while the trees are held exclusively
+
+// One batch drawn from during a sale
+typedef struct
+{
+    int batch_no;
+    int sold;
+    int remaining;
+} batch_draw;
+
+// Metrics by which suppliers are ranked for the top-K reports
+typedef enum
+{
+    RANK_BY_MEDS,     // Number of distinct medications supplied
+    RANK_BY_TURNOVER, // Units x unit price at receipt over every link, from the supply edges
+    RANK_METRICS
+} rank_metric;
+
+// Forward declaration
+typedef struct data_tag data;
+
+// One medication in a supplier's link set
+typedef struct
+{
+    data *med;      // NULL if the slot is free
+    int index;      // Position of med in the supplier's medications array
+    int first_link; // Newest of the supplier's links to batches of med
+} med_link_slot;
+
+// One supplier-batch link, kept by the supplier
+typedef struct
+{
+    data *med;
+    int batch; // Index of the batch in med->Batch
+    int slot;  // Position of the supplier in that batch's suppliers[]
+    int next;  // Next link of the same supplier and medication, -1 at the end
+    int edge;  // Row of the link in the supply edge table
+} supplier_link;
+
+// Supplier structure holds supplier details.
+typedef struct Supplier_tag
+{
+    int supplier_id;
+    char supp_name[MAX_NAME_LENGTH];
+    int qty_of_supply; // Units per delivery, recorded on each new link
+    long long contact;
+    data **medications; // Distinct medications linked, in no particular order; grows as needed
+    int med_count;
+    int med_capacity;
+    med_link_slot *med_set; // Open-addressed index of medications by pointer, at most half full
+    int med_set_capacity;   // Slots in med_set, a power of two (0 before the first link)
+    supplier_link *links;   // Every batch this supplier is linked to, in no particular order
+    int link_count;
+    int link_capacity;
+    long long supply_volume;    // Units supplied over every link
+    long long turnover;         // Units x unit price at receipt over every link
+    int rank_pos[RANK_METRICS]; // Position of this supplier in each ranking heap
+} supplier;
+
+// Batch structure holds information about one batch of a medication.
+typedef struct batch_tag
+{
+    int batch_no;
+    int qty_instock;
+    char exp_date[MAX_DATE_LENGTH];
+    supplier *suppliers[MAX_SUPPLIERS]; // Array of pointers to suppliers for this batch
+    int supplier_count;                 // Number of suppliers in this batch
+    int fefo_pos;                       // Slot of this batch in its medication's fefo_heap
+    int col_row;                        // Row of this batch in the batch columns
+} batch;
+
+// Units sold in one day or week of a rollup ring
+typedef struct
+{
+    int period; // Day or week number the units belong to, -1 if unused
+    int units;
+} rollup_slot;
+
+// Medication data structure holds medID, medname, an array of batches, and reorder level.
+typedef struct data_tag
+{
+    int medID;
+    char medname[MAX_NAME_LENGTH];
+    int batch_count;              // Number of batches for this medication
+    int fefo_heap[MAX_BATCHES];   // Batch indexes as a min-heap on expiry date
+    int reorder_lvl;
+    int priceperunit;
+    long long units_sold;             // Units sold over the whole sales ledger
+    rollup_slot daily[ROLLUP_DAYS];   // Units sold per day, indexed by day number % ROLLUP_DAYS
+    rollup_slot weekly[ROLLUP_WEEKS]; // Units sold per week, indexed by week number % ROLLUP_WEEKS
+    pthread_mutex_t lock;             // Held while a sale draws from this medication's batches
+    unsigned long long cow_version;   // Newest snapshot this record has been preserved for
+    int col_slot;                     // Slot of this medication in the batch columns
+    batch Batch[MAX_BATCHES];         // Last, so a snapshot's copy can stop after batch_count batches
+} data;
+
+// B-tree node for medication ID (integer key)
+typedef struct B
+{
+    int keys[INT_ORDER] __attribute__((aligned(32))); // Integer keys (medID); the last slot only pads SIMD loads
+    data *values[INT_ORDER - 1];   // Pointer to medication record
+    struct B *children[INT_ORDER]; // Child pointers
+    int num_keys;              // Number of keys in the node
+    int is_leaf;               // 1 if leaf, 0 otherwise
+    int subtree_size;          // Keys in this node and all of its descendants
+} B;
+
+// B-tree node for medication name (string key)
+typedef struct B_str
+{
+    char *keys[ORDER - 1];         // String keys (medname or expiry date)
+    data *values[ORDER - 1];       // Pointer to medication record
+    struct B_str *children[ORDER]; // Child pointers
+    int num_keys;                  // Number of keys
+    int is_leaf;                   // 1 if leaf, 0 otherwise
+    int subtree_size;              // Keys in this node and all of its descendants
+} B_str;
+
+// B-tree node for supplier (integer key)
+typedef struct B_supp
+{
+    int keys[INT_ORDER] __attribute__((aligned(32))); // supplier_id keys; the last slot only pads SIMD loads
+    supplier *values[INT_ORDER - 1];    // Pointer to supplier data
+    struct B_supp *children[INT_ORDER]; // Child pointers
+    int num_keys;
+    int is_leaf;
+    int subtree_size; // Must stay laid out like B: deleteFromBTreeSupp reuses deleteFromBTree
+} B_supp;
+
+supplier *search_supplier(B_supp *root, int supplier_id);
+void addMedicationGeneral(B **medIDTree, B_str **mednameTree, B_str **expDateTree, B_supp **supplierTree);
+void searchMedicationBymedId(int medId, B *medIDTree);
+void searchMedicationBymedname(char *medname, B_str *mednameTree);
+void searchMedication();
+void updateMedication(int medID);
+B *precedingNode(B *node, int index);
+B *successiveNode(B *node, int index);
+B *borrowFromPrev(B *node, int index);
+B *borrowFromNext(B *node, int index);
+B *mergeNodes(B *node, int index);
+B *deleteFromBTree(B *root, int key);
+B_str *mergeBTreeStr(B_str *node, int index);
+B_str *deleteFromBTreeStr(B_str *node, char *key, data *value);
+status_code queueExpiryRemoval(data *med, const char *exp_date);
+void drainExpiryRemovals();
+B_supp *deleteFromBTreeSupp(B_supp *root, int key);
+data *search_medID(B *root, int medID);
+data *search_medname(B_str *root, const char *medname);
+void deleteMedication(B **root, B_str **nameRoot, B_str **dateRoot, int medID, int batch_no);
+void checkexpirydate(char *currentdate);
+void stockAlerts();
+void sortMedicationByExpiry(B_str *node, const char *date1, const char *date2);
+void salesTracking(B *node, int medID, int qtySold);
+void initSalesRollups(data *med);
+void preserveRecord(data *med);
+void supplierManagement();
+
+//==========HEAP SORT FUNCTION==========//
+
+void swap(int *a, int *b)
+{
+    int temp = *a;
+    *a = *b;
+    *b = temp;
+}
+int left(int i)
+{
+    return (2 * i + 1);
+}
+int right(int i)
+{
+    return (2 * i + 2);
+}
+int parent(int i)
+{
+    return (i - 1) / 2;
+}
+void MaxHeapify(int A[], int ID[], int n, int i)
+{
+    int largest = i;
+    int l = left(i);
+    int r = right(i);
+
+    if (l < n && A[l] > A[largest])
+        largest = l;
+
+    if (r < n && A[r] > A[largest])
+        largest = r;
+
+    if (largest != i)
+    {
+        swap(&A[i], &A[largest]);
+        swap(&ID[i], &ID[largest]);
+        MaxHeapify(A, ID, n, largest);
+    }
+}
+
+void BuildMaxHeap(int A[], int ID[], int n)
+{
+    for (int i = n / 2 - 1; i >= 0; i--)
+        MaxHeapify(A, ID, n, i);
+}
+
+void Heapsort(int A[], int ID[], int n)
+{
+    BuildMaxHeap(A, ID, n);
+    for (int i = n - 1; i > 0; i--)
+    {
+        swap(&A[0], &A[i]);
+        swap(&ID[0], &ID[i]);
+        MaxHeapify(A, ID, i, 0);
+    }
+}
+//==========BATCH COLUMNS==========//
+
+// A columnar shadow of the batch fields full-inventory sweeps read: one row per batch holding its
+// expiry as a day number, units in stock, unit price and the owning medication's slot. Rows never
+// move while in use, so a sale updates its own rows under just its medication lock. Freed rows are
+// blanked (never expiring, empty, slot 0) and recycled, which lets every sweep run branch-free over
+// all rows without skipping the free ones.
+
+#define EMPTY_ROW_EXPIRY 0x7fffffff // Expiry of a free row: later than any real date
+#define EXPIRY_WARNING_DAYS 30      // Batches expiring within this many days are reported as due soon
+
+typedef struct
+{
+    int *expiry; // Days since 1970-01-01
+    int *qty;
+    int *price;
+    int *med;    // Slot of the owning medication in meds
+    int rows;    // Rows handed out so far, in use or free
+    int row_capacity;
+    int *free_rows;
+    int free_row_count;
+    data **meds; // Medication in each slot, NULL if the slot is free
+    int slots;
+    int slot_capacity;
+    int *free_slots;
+    int free_slot_count;
+} batch_columns;
+
+batch_columns columns = {0};
+pthread_mutex_t columns_lock = PTHREAD_MUTEX_INITIALIZER; // Guards the free row list during concurrent sales
+
+// Days since 1970-01-01 of a YYYY-MM-DD date.
+int dateToDay(const char *date)
+{
+    int y = 0, m = 1, d = 1;
+    sscanf(date, "%d-%d-%d", &y, &m, &d);
+    y -= m <= 2;
+    int era = (y >= 0 ? y : y - 399) / 400;
+    int yoe = y - era * 400;
+    int doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+// Writes the YYYY-MM-DD date of a day number into date (MAX_DATE_LENGTH bytes).
+void dayToDate(int day, char *date)
+{
+    day += 719468;
+    int era = (day >= 0 ? day : day - 146096) / 146097;
+    int doe = day - era * 146097;
+    int yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int mp = (5 * doy + 2) / 153;
+    int d = doy - (153 * mp + 2) / 5 + 1;
+    int m = mp < 10 ? mp + 3 : mp - 9;
+    unsigned year = (unsigned)(yoe + era * 400 + (m <= 2)) % 10000;
+    snprintf(date, MAX_DATE_LENGTH, "%04u-%02u-%02u", year, (unsigned)m % 100, (unsigned)d % 100);
+}
+
+status_code growColumn(int **column, int capacity)
+{
+    int *grown = (int *)realloc(*column, capacity * sizeof(int));
+    if (!grown)
+        return FAILURE;
+    *column = grown;
+    return SUCCESS;
+}
+
+// Gives med a slot. Writers only.
+status_code columnsAddMedication(data *med)
+{
+    if (columns.free_slot_count > 0)
+    {
+        med->col_slot = columns.free_slots[--columns.free_slot_count];
+        columns.meds[med->col_slot] = med;
+        return SUCCESS;
+    }
+    if (columns.slots == columns.slot_capacity)
+    {
+        int capacity = columns.slot_capacity ? columns.slot_capacity * 2 : 256;
+        data **meds = (data **)realloc(columns.meds, capacity * sizeof(data *));
+        if (!meds)
+            return FAILURE;
+        columns.meds = meds;
+        if (growColumn(&columns.free_slots, capacity) == FAILURE)
+            return FAILURE;
+        columns.slot_capacity = capacity;
+    }
+    med->col_slot = columns.slots++;
+    columns.meds[med->col_slot] = med;
+    return SUCCESS;
+}
+
+// Frees med's slot once its batches are gone. Writers only.
+void columnsRemoveMedication(data *med)
+{
+    columns.meds[med->col_slot] = NULL;
+    columns.free_slots[columns.free_slot_count++] = med->col_slot;
+}
+
+// Makes room for extra more rows. Writers only.
+status_code columnsReserve(int extra)
+{
+    if (columns.rows + extra <= columns.row_capacity)
+        return SUCCESS;
+    int capacity = columns.row_capacity ? columns.row_capacity : 1024;
+    while (capacity < columns.rows + extra)
+        capacity *= 2;
+    if (growColumn(&columns.expiry, capacity) == FAILURE || growColumn(&columns.qty, capacity) == FAILURE ||
+        growColumn(&columns.price, capacity) == FAILURE || growColumn(&columns.med, capacity) == FAILURE ||
+        growColumn(&columns.free_rows, capacity) == FAILURE)
+        return FAILURE;
+    columns.row_capacity = capacity;
+    return SUCCESS;
+}
+
+// Returns the row of a new batch of med, or -1 if out of memory. Writers only.
+int columnsAddBatch(data *med, int qty_instock, const char *exp_date)
+{
+    int row;
+    if (columns.free_row_count > 0)
+        row = columns.free_rows[--columns.free_row_count];
+    else if (columnsReserve(1) == SUCCESS)
+        row = columns.rows++;
+    else
+        return -1;
+    columns.expiry[row] = dateToDay(exp_date);
+    columns.qty[row] = qty_instock;
+    columns.price[row] = med->priceperunit;
+    columns.med[row] = med->col_slot;
+    return row;
+}
+
+// Blanks a removed batch's row and queues it for reuse.
+void columnsRemoveBatch(const batch *b)
+{
+    pthread_mutex_lock(&columns_lock);
+    columns.expiry[b->col_row] = EMPTY_ROW_EXPIRY;
+    columns.qty[b->col_row] = 0;
+    columns.price[b->col_row] = 0;
+    columns.med[b->col_row] = 0;
+    columns.free_rows[columns.free_row_count++] = b->col_row;
+    pthread_mutex_unlock(&columns_lock);
+}
+
+void columnsSetQty(const batch *b)
+{
+    columns.qty[b->col_row] = b->qty_instock;
+}
+
+void columnsSetPrice(const data *med)
+{
+    for (int j = 0; j < med->batch_count; j++)
+        columns.price[med->Batch[j].col_row] = med->priceperunit;
+}
+
+// Units and stock value over every row, and the part of them held in expired batches
+typedef struct
+{
+    long long units;
+    long long value;
+    long long expired_units;
+    long long expired_value;
+} sweep_totals;
+
+// Stores in hits the rows expiring on or before last_day and returns how many there are.
+int selectExpiringScalar(const int *expiry, int rows, int last_day, int *hits)
+{
+    int count = 0;
+    for (int r = 0; r < rows; r++)
+    {
+        hits[count] = r;
+        count += expiry[r] <= last_day;
+    }
+    return count;
+}
+
+// Sums units and value over the rows, counting rows expiring before before_day as expired.
+void sweepTotalsScalar(const int *expiry, const int *qty, const int *price, int rows, int before_day,
+                       sweep_totals *totals)
+{
+    long long units = 0, value = 0, expired_units = 0, expired_value = 0;
+    for (int r = 0; r < rows; r++)
+    {
+        long long q = qty[r], v = q * price[r];
+        long long expired = -(long long)(expiry[r] < before_day);
+        units += q;
+        value += v;
+        expired_units += q & expired;
+        expired_value += v & expired;
+    }
+    totals->units = units;
+    totals->value = value;
+    totals->expired_units = expired_units;
+    totals->expired_value = expired_value;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2"))) int selectExpiringAVX2(const int *expiry, int rows, int last_day, int *hits)
+{
+    __m256i limit = _mm256_set1_epi32(last_day + 1);
+    int count = 0, r = 0;
+    for (; r + 8 <= rows; r += 8)
+    {
+        __m256i due = _mm256_cmpgt_epi32(limit, _mm256_loadu_si256((const __m256i *)(expiry + r)));
+        unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(due));
+        while (mask)
+        {
+            hits[count++] = r + __builtin_ctz(mask);
+            mask &= mask - 1;
+        }
+    }
+    for (; r < rows; r++)
+    {
+        hits[count] = r;
+        count += expiry[r] <= last_day;
+    }
+    return count;
+}
+
+// Widens the eight 32-bit lanes of v and adds them to the four 64-bit lanes of sum.
+__attribute__((target("avx2"))) __m256i addWidened(__m256i sum, __m256i v)
+{
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v)));
+    return _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1)));
+}
+
+// Adds the 64-bit products of the eight lane pairs of a and b to the four lanes of sum.
+__attribute__((target("avx2"))) __m256i addProducts(__m256i sum, __m256i a, __m256i b)
+{
+    sum = _mm256_add_epi64(sum, _mm256_mul_epi32(a, b));
+    return _mm256_add_epi64(sum, _mm256_mul_epi32(_mm256_srli_epi64(a, 32), _mm256_srli_epi64(b, 32)));
+}
+
+__attribute__((target("avx2"))) long long sumLanes(__m256i v)
+{
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, v);
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+__attribute__((target("avx2"))) void sweepTotalsAVX2(const int *expiry, const int *qty, const int *price, int rows,
+                                                      int before_day, sweep_totals *totals)
+{
+    __m256i before = _mm256_set1_epi32(before_day);
+    __m256i units = _mm256_setzero_si256(), value = _mm256_setzero_si256();
+    __m256i expired_units = _mm256_setzero_si256(), expired_value = _mm256_setzero_si256();
+    int r = 0;
+    for (; r + 8 <= rows; r += 8)
+    {
+        __m256i q = _mm256_loadu_si256((const __m256i *)(qty + r));
+        __m256i p = _mm256_loadu_si256((const __m256i *)(price + r));
+        __m256i expired = _mm256_cmpgt_epi32(before, _mm256_loadu_si256((const __m256i *)(expiry + r)));
+        __m256i q_expired = _mm256_and_si256(q, expired);
+        units = addWidened(units, q);
+        expired_units = addWidened(expired_units, q_expired);
+        value = addProducts(value, q, p);
+        expired_value = addProducts(expired_value, q_expired, p);
+    }
+    sweepTotalsScalar(expiry + r, qty + r, price + r, rows - r, before_day, totals);
+    totals->units += sumLanes(units);
+    totals->value += sumLanes(value);
+    totals->expired_units += sumLanes(expired_units);
+    totals->expired_value += sumLanes(expired_value);
+}
+#endif
+
+typedef struct
+{
+    const char *name;
+    int (*selectExpiring)(const int *expiry, int rows, int last_day, int *hits);
+    void (*totals)(const int *expiry, const int *qty, const int *price, int rows, int before_day,
+                   sweep_totals *totals);
+} sweep_kernels;
+
+// Every kernel set the running CPU supports, best last.
+int sweepKernelImpls(sweep_kernels impls[])
+{
+    int count = 0;
+    impls[count++] = (sweep_kernels){"scalar", selectExpiringScalar, sweepTotalsScalar};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        impls[count++] = (sweep_kernels){"avx2", selectExpiringAVX2, sweepTotalsAVX2};
+#endif
+    return count;
+}
+
+sweep_kernels sweep;
+pthread_once_t sweep_once = PTHREAD_ONCE_INIT;
+
+void chooseSweepKernels()
+{
+    sweep_kernels impls[2];
+    sweep = impls[sweepKernelImpls(impls) - 1];
+}
+
+sweep_kernels *sweepKernels()
+{
+    pthread_once(&sweep_once, chooseSweepKernels);
+    return &sweep;
+}
+
+// Adds each row's units to its medication's entry in stock (one per slot, zeroed by the caller).
+void stockBySlot(long long *stock)
+{
+    for (int r = 0; r < columns.rows; r++)
+        stock[columns.med[r]] += columns.qty[r];
+}
+
+int compareExpiringRows(const void *a, const void *b)
+{
+    int x = *(const int *)a, y = *(const int *)b;
+    if (columns.expiry[x] != columns.expiry[y])
+        return columns.expiry[x] < columns.expiry[y] ? -1 : 1;
+    int id_x = columns.meds[columns.med[x]]->medID, id_y = columns.meds[columns.med[y]]->medID;
+    return (id_x > id_y) - (id_x < id_y);
+}
+
+// Returns the rows expiring on or before last_day ordered by expiry and then medication ID, or
+// NULL if out of memory. *count receives how many there are.
+int *expiringRows(int last_day, int *count)
+{
+    int *hits = (int *)malloc((columns.rows ? columns.rows : 1) * sizeof(int));
+    if (!hits)
+        return NULL;
+    *count = sweepKernels()->selectExpiring(columns.expiry, columns.rows, last_day, hits);
+    qsort(hits, *count, sizeof(int), compareExpiringRows);
+    return hits;
+}
+
+// A medication at or below its reorder level
+typedef struct
+{
+    data *med;
+    long long stock;
+} stock_alert;
+
+int compareStockAlerts(const void *a, const void *b)
+{
+    int x = ((const stock_alert *)a)->med->medID, y = ((const stock_alert *)b)->med->medID;
+    return (x > y) - (x < y);
+}
+
+// Returns the medications whose stock is at or below their reorder level ordered by medication
+// ID, or NULL if out of memory. *count receives how many there are.
+stock_alert *lowStockAlerts(int *count)
+{
+    long long *stock = (long long *)calloc(columns.slots ? columns.slots : 1, sizeof(long long));
+    stock_alert *alerts = (stock_alert *)malloc((columns.slots ? columns.slots : 1) * sizeof(stock_alert));
+    if (!stock || !alerts)
+    {
+        free(stock);
+        free(alerts);
+        return NULL;
+    }
+    stockBySlot(stock);
+
+    *count = 0;
+    for (int slot = 0; slot < columns.slots; slot++)
+    {
+        data *med = columns.meds[slot];
+        if (med != NULL && stock[slot] <= med->reorder_lvl)
+            alerts[(*count)++] = (stock_alert){med, stock[slot]};
+    }
+    free(stock);
+    qsort(alerts, *count, sizeof(stock_alert), compareStockAlerts);
+    return alerts;
+}
+
+//==========SUPPLIER RANKINGS==========//
+
+// Each ranking is an indexed max-heap of suppliers. Every supplier remembers its
+// slot in rank_pos, so a link, sale or supplier change re-heapifies in O(log n).
+typedef struct
+{
+    supplier **heap;
+    int size;
+    int capacity;
+} supplier_rank;
+
+supplier_rank supplierRankings[RANK_METRICS];
+
+long long supplierScore(supplier *s, rank_metric metric)
+{
+    if (metric == RANK_BY_MEDS)
+        return s->med_count;
+    return s->turnover;
+}
+
+// Returns 1 if a ranks above b; ties go to the lower supplier ID.
+int rankedAbove(supplier *a, supplier *b, rank_metric metric)
+{
+    long long score_a = supplierScore(a, metric);
+    long long score_b = supplierScore(b, metric);
+    if (score_a != score_b)
+        return score_a > score_b;
+    return a->supplier_id < b->supplier_id;
+}
+
+void rankSwap(supplier_rank *rank, rank_metric metric, int i, int j)
+{
+    supplier *temp = rank->heap[i];
+    rank->heap[i] = rank->heap[j];
+    rank->heap[j] = temp;
+    rank->heap[i]->rank_pos[metric] = i;
+    rank->heap[j]->rank_pos[metric] = j;
+}
+
+void rankSiftUp(supplier_rank *rank, rank_metric metric, int i)
+{
+    while (i > 0 && rankedAbove(rank->heap[i], rank->heap[parent(i)], metric))
+    {
+        rankSwap(rank, metric, i, parent(i));
+        i = parent(i);
+    }
+}
+
+void rankSiftDown(supplier_rank *rank, rank_metric metric, int i)
+{
+    while (1)
+    {
+        int largest = i;
+        int l = left(i);
+        int r = right(i);
+
+        if (l < rank->size && rankedAbove(rank->heap[l], rank->heap[largest], metric))
+            largest = l;
+        if (r < rank->size && rankedAbove(rank->heap[r], rank->heap[largest], metric))
+            largest = r;
+        if (largest == i)
+            return;
+
+        rankSwap(rank, metric, i, largest);
+        i = largest;
+    }
+}
+
+void rankAddSupplier(supplier *s)
+{
+    for (int m = 0; m < RANK_METRICS; m++)
+    {
+        supplier_rank *rank = &supplierRankings[m];
+        if (rank->size == rank->capacity)
+        {
+            int new_capacity = rank->capacity ? rank->capacity * 2 : 64;
+            supplier **grown = (supplier **)realloc(rank->heap, new_capacity * sizeof(supplier *));
+            if (!grown)
+            {
+                printf("Memory allocation failed for supplier rankings.\n");
+                s->rank_pos[m] = -1;
+                continue;
+            }
+            rank->heap = grown;
+            rank->capacity = new_capacity;
+        }
+        rank->heap[rank->size] = s;
+        s->rank_pos[m] = rank->size++;
+        rankSiftUp(rank, m, s->rank_pos[m]);
+    }
+}
+
+void rankRemoveSupplier(supplier *s)
+{
+    for (int m = 0; m < RANK_METRICS; m++)
+    {
+        supplier_rank *rank = &supplierRankings[m];
+        int pos = s->rank_pos[m];
+        if (pos < 0 || pos >= rank->size || rank->heap[pos] != s)
+            continue;
+
+        rank->size--;
+        if (pos != rank->size)
+        {
+            rankSwap(rank, m, pos, rank->size);
+            rankSiftUp(rank, m, pos);
+            rankSiftDown(rank, m, pos);
+        }
+        s->rank_pos[m] = -1;
+    }
+}
+
+// Restores heap order after any change to a supplier's med_count or turnover.
+void rankUpdateSupplier(supplier *s)
+{
+    for (int m = 0; m < RANK_METRICS; m++)
+    {
+        supplier_rank *rank = &supplierRankings[m];
+        int pos = s->rank_pos[m];
+        if (pos < 0 || pos >= rank->size || rank->heap[pos] != s)
+            continue;
+        rankSiftUp(rank, m, pos);
+        rankSiftDown(rank, m, s->rank_pos[m]);
+    }
+}
+
+// Writes up to k best-ranked suppliers into out, best first, and returns how many were written.
+// The heap is explored best-first from its root with a small candidate heap, so this costs
+// O(k log k) regardless of how many suppliers exist.
+int topKSuppliers(rank_metric metric, int k, supplier **out)
+{
+    supplier_rank *rank = &supplierRankings[metric];
+    if (k <= 0 || rank->size == 0)
+        return 0;
+
+    // Every pop pushes at most two children, so the candidates never exceed k + 1
+    int *candidates = (int *)malloc((k + 2) * sizeof(int));
+    if (!candidates)
+    {
+        printf("Memory allocation failed for top-K query.\n");
+        return 0;
+    }
+    int num_candidates = 1;
+    candidates[0] = 0;
+
+    int found = 0;
+    while (found < k && num_candidates > 0)
+    {
+        int best = candidates[0];
+        out[found++] = rank->heap[best];
+
+        // Pop the best candidate
+        candidates[0] = candidates[--num_candidates];
+        for (int i = 0;;)
+        {
+            int largest = i, l = left(i), r = right(i);
+            if (l < num_candidates && rankedAbove(rank->heap[candidates[l]], rank->heap[candidates[largest]], metric))
+                largest = l;
+            if (r < num_candidates && rankedAbove(rank->heap[candidates[r]], rank->heap[candidates[largest]], metric))
+                largest = r;
+            if (largest == i)
+                break;
+            swap(&candidates[i], &candidates[largest]);
+            i = largest;
+        }
+
+        // Push its children in the ranking heap
+        int children[2] = {left(best), right(best)};
+        for (int c = 0; c < 2; c++)
+        {
+            if (children[c] >= rank->size)
+                continue;
+            int i = num_candidates++;
+            candidates[i] = children[c];
+            while (i > 0 && rankedAbove(rank->heap[candidates[i]], rank->heap[candidates[parent(i)]], metric))
+            {
+                swap(&candidates[i], &candidates[parent(i)]);
+                i = parent(i);
+            }
+        }
+    }
+
+    free(candidates);
+    return found;
+}
+
+//==========SUPPLY EDGES==========//
+
+// Every supplier-batch link is also a row of a columnar edge table: the supplier's ID, the batch's
+// row in the batch columns, the units that supplier delivered to that batch and the unit price
+// when they were received. Supply volume and turnover reports are one pass over these flat
+// columns instead of a walk of every medication, batch and supplier. Like the batch rows, freed
+// rows are blanked (no supplier or batch, no units, no price) and recycled, so a pass never
+// skips any. Writers, or sales under supplier_lock.
+
+typedef struct
+{
+    int *supplier; // Supplier ID, -1 if the row is free
+    int *batch;    // Row of the batch in the batch columns, -1 if the row is free
+    int *qty;      // Units supplied
+    int *price;    // Unit price at receipt
+    int rows;      // Rows handed out so far, in use or free
+    int row_capacity;
+    int *free_rows;
+    int free_row_count;
+} supply_edge_table;
+
+supply_edge_table supply_edges = {0};
+
+// Returns the row of a new edge, or -1 if out of memory.
+int addSupplyEdge(int supplier_id, int batch_row, int qty, int price)
+{
+    int row;
+    if (supply_edges.free_row_count > 0)
+        row = supply_edges.free_rows[--supply_edges.free_row_count];
+    else
+    {
+        if (supply_edges.rows == supply_edges.row_capacity)
+        {
+            int capacity = supply_edges.row_capacity ? supply_edges.row_capacity * 2 : 1024;
+            if (growColumn(&supply_edges.supplier, capacity) == FAILURE ||
+                growColumn(&supply_edges.batch, capacity) == FAILURE ||
+                growColumn(&supply_edges.qty, capacity) == FAILURE ||
+                growColumn(&supply_edges.price, capacity) == FAILURE ||
+                growColumn(&supply_edges.free_rows, capacity) == FAILURE)
+                return -1;
+            supply_edges.row_capacity = capacity;
+        }
+        row = supply_edges.rows++;
+    }
+    supply_edges.supplier[row] = supplier_id;
+    supply_edges.batch[row] = batch_row;
+    supply_edges.qty[row] = qty;
+    supply_edges.price[row] = price;
+    return row;
+}
+
+// Blanks an edge row and queues it for reuse.
+void removeSupplyEdge(int row)
+{
+    supply_edges.supplier[row] = -1;
+    supply_edges.batch[row] = -1;
+    supply_edges.qty[row] = 0;
+    supply_edges.price[row] = 0;
+    supply_edges.free_rows[supply_edges.free_row_count++] = row;
+}
+
+// Open-addressed map from supplier ID to a dense index, at most half full. Lets totals be kept
+// per supplier whatever the range of IDs.
+typedef struct
+{
+    int *ids;     // Supplier ID in each slot
+    int *indexes; // Dense index of that ID, -1 if the slot is free
+    int capacity; // Slots, a power of two (0 before the first ID)
+    int count;    // IDs held; they own indexes 0..count-1
+} supplier_index;
+
+int supplierIdHash(int supplier_id, int capacity)
+{
+    unsigned long long x = (unsigned long long)(unsigned)supplier_id * 0x9E3779B97F4A7C15ULL;
+    return (int)(x >> 32) & (capacity - 1);
+}
+
+// Returns the dense index of supplier_id, or -1 if it is not in the map.
+int findSupplierIndex(const supplier_index *map, int supplier_id)
+{
+    if (map->capacity == 0)
+        return -1;
+    int mask = map->capacity - 1;
+    for (int i = supplierIdHash(supplier_id, map->capacity);; i = (i + 1) & mask)
+    {
+        if (map->indexes[i] < 0)
+            return -1;
+        if (map->ids[i] == supplier_id)
+            return map->indexes[i];
+    }
+}
+
+void placeSupplierIndex(int *ids, int *indexes, int capacity, int supplier_id, int index)
+{
+    int i = supplierIdHash(supplier_id, capacity);
+    while (indexes[i] >= 0)
+        i = (i + 1) & (capacity - 1);
+    ids[i] = supplier_id;
+    indexes[i] = index;
+}
+
+// Returns the dense index of supplier_id, giving it the next one if it is new, or -1 if the map
+// could not grow.
+int addSupplierIndex(supplier_index *map, int supplier_id)
+{
+    int index = findSupplierIndex(map, supplier_id);
+    if (index >= 0)
+        return index;
+    if (2 * (map->count + 1) > map->capacity)
+    {
+        int capacity = map->capacity ? map->capacity * 2 : 64;
+        int *ids = (int *)malloc(capacity * sizeof(int));
+        int *indexes = (int *)malloc(capacity * sizeof(int));
+        if (!ids || !indexes)
+        {
+            free(ids);
+            free(indexes);
+            return -1;
+        }
+        for (int i = 0; i < capacity; i++)
+            indexes[i] = -1;
+        for (int i = 0; i < map->capacity; i++)
+        {
+            if (map->indexes[i] >= 0)
+                placeSupplierIndex(ids, indexes, capacity, map->ids[i], map->indexes[i]);
+        }
+        free(map->ids);
+        free(map->indexes);
+        map->ids = ids;
+        map->indexes = indexes;
+        map->capacity = capacity;
+    }
+    placeSupplierIndex(map->ids, map->indexes, map->capacity, supplier_id, map->count);
+    return map->count++;
+}
+
+void freeSupplierIndex(supplier_index *map)
+{
+    free(map->ids);
+    free(map->indexes);
+    map->ids = NULL;
+    map->indexes = NULL;
+    map->capacity = 0;
+    map->count = 0;
+}
+
+// Supply of one supplier
+typedef struct
+{
+    int supplier_id;
+    int links;
+    long long volume;
+    long long turnover;
+} supply_total;
+
+// Supply per supplier, in ascending supplier ID order.
+typedef struct
+{
+    supply_total *entries;
+    int count;
+} supply_totals;
+
+int compareSupplyTotals(const void *a, const void *b)
+{
+    int x = ((const supply_total *)a)->supplier_id;
+    int y = ((const supply_total *)b)->supplier_id;
+    return (x > y) - (x < y);
+}
+
+// Fills totals in one pass over the edge table. Returns FAILURE if memory ran out; totals is
+// then empty. The caller frees totals->entries.
+status_code sumSupplyEdges(supply_totals *totals)
+{
+    supplier_index map = {NULL, NULL, 0, 0};
+    int capacity = 0;
+    totals->entries = NULL;
+    totals->count = 0;
+    const int *supplier_ids = supply_edges.supplier;
+    const int *batches = supply_edges.batch;
+    const int *qty = supply_edges.qty;
+    const int *price = supply_edges.price;
+    for (int row = 0; row < supply_edges.rows; row++)
+    {
+        if (batches[row] < 0) // Free row
+            continue;
+        int index = addSupplierIndex(&map, supplier_ids[row]);
+        if (index == capacity && index >= 0)
+        {
+            int grown_capacity = capacity ? capacity * 2 : 64;
+            supply_total *grown = (supply_total *)realloc(totals->entries, grown_capacity * sizeof(supply_total));
+            if (grown)
+            {
+                totals->entries = grown;
+                capacity = grown_capacity;
+            }
+        }
+        if (index < 0 || index >= capacity)
+        {
+            free(totals->entries);
+            totals->entries = NULL;
+            totals->count = 0;
+            freeSupplierIndex(&map);
+            return FAILURE;
+        }
+        supply_total *t = &totals->entries[index];
+        if (index == totals->count)
+        {
+            t->supplier_id = supplier_ids[row];
+            t->links = 0;
+            t->volume = 0;
+            t->turnover = 0;
+            totals->count++;
+        }
+        t->volume += qty[row];
+        t->turnover += (long long)qty[row] * price[row];
+        t->links++;
+    }
+    freeSupplierIndex(&map);
+    qsort(totals->entries, totals->count, sizeof(supply_total), compareSupplyTotals);
+    return SUCCESS;
+}
+
+//==========SUPPLIER-BATCH LINKS==========//
+
+// Every supplier keeps the medications it is linked to in an array for listing and in a hash
+// set keyed by the medication pointer for membership. It also keeps a table of its links with
+// back-pointers to each (medication, batch, slot) it occupies; the links to one medication are
+// chained from that medication's set slot. Removing a supplier or a batch therefore touches
+// exactly the links involved, and unlinking one batch knows in O(1) whether the medication stays
+// on the list. Slots and batch indexes in the table follow every shift in suppliers[] and every
+// batch moved by removeBatchAt. All of it grows without limit. Writers, or sales under
+// supplier_lock.
+
+int medSlotHash(const data *med, int capacity)
+{
+    unsigned long long x = (unsigned long long)(uintptr_t)med * 0x9E3779B97F4A7C15ULL;
+    return (int)(x >> 32) & (capacity - 1);
+}
+
+// Returns the set slot holding med, or -1 if s is not linked to it.
+int findMedicationSlot(const supplier *s, const data *med)
+{
+    if (s->med_set_capacity == 0)
+        return -1;
+    int mask = s->med_set_capacity - 1;
+    for (int i = medSlotHash(med, s->med_set_capacity);; i = (i + 1) & mask)
+    {
+        if (s->med_set[i].med == med)
+            return i;
+        if (s->med_set[i].med == NULL)
+            return -1;
+    }
+}
+
+Boolean supplierHasMedication(supplier *s, data *med)
+{
+    return findMedicationSlot(s, med) >= 0;
+}
+
+void placeMedicationSlot(med_link_slot *set, int capacity, med_link_slot slot)
+{
+    int i = medSlotHash(slot.med, capacity);
+    while (set[i].med != NULL)
+        i = (i + 1) & (capacity - 1);
+    set[i] = slot;
+}
+
+// Returns the link of s to batch batch of med, or NULL if there is none.
+supplier_link *findSupplierLink(supplier *s, const data *med, int batch)
+{
+    int pos = findMedicationSlot(s, med);
+    if (pos < 0)
+        return NULL;
+    for (int l = s->med_set[pos].first_link; l >= 0; l = s->links[l].next)
+    {
+        if (s->links[l].batch == batch)
+            return &s->links[l];
+    }
+    return NULL;
+}
+
+// Records that s sits in the given slot of batch batch of med with its supply in the given edge
+// row, adding med to the set and the array if it is new. Fails only when out of memory, leaving s unchanged.
+status_code supplierAddLink(supplier *s, data *med, int batch, int slot, int edge)
+{
+    if (s->link_count == s->link_capacity)
+    {
+        int capacity = s->link_capacity ? s->link_capacity * 2 : 8;
+        supplier_link *grown = (supplier_link *)realloc(s->links, capacity * sizeof(supplier_link));
+        if (!grown)
+            return FAILURE;
+        s->links = grown;
+        s->link_capacity = capacity;
+    }
+
+    int pos = findMedicationSlot(s, med);
+    if (pos < 0)
+    {
+        if (s->med_count == s->med_capacity)
+        {
+            int capacity = s->med_capacity ? s->med_capacity * 2 : 8;
+            data **grown = (data **)realloc(s->medications, capacity * sizeof(data *));
+            if (!grown)
+                return FAILURE;
+            s->medications = grown;
+            s->med_capacity = capacity;
+        }
+        if (2 * (s->med_count + 1) > s->med_set_capacity)
+        {
+            int capacity = s->med_set_capacity ? s->med_set_capacity * 2 : 16;
+            med_link_slot *set = (med_link_slot *)calloc(capacity, sizeof(med_link_slot));
+            if (!set)
+                return FAILURE;
+            for (int i = 0; i < s->med_set_capacity; i++)
+            {
+                if (s->med_set[i].med != NULL)
+                    placeMedicationSlot(set, capacity, s->med_set[i]);
+            }
+            free(s->med_set);
+            s->med_set = set;
+            s->med_set_capacity = capacity;
+        }
+
+        med_link_slot entry = {med, s->med_count, -1};
+        s->medications[s->med_count++] = med;
+        placeMedicationSlot(s->med_set, s->med_set_capacity, entry);
+        pos = findMedicationSlot(s, med);
+    }
+
+    supplier_link link = {med, batch, slot, s->med_set[pos].first_link, edge};
+    s->med_set[pos].first_link = s->link_count;
+    s->links[s->link_count++] = link;
+    return SUCCESS;
+}
+
+// Takes the set slot at pos out of s and drops its medication from the array, which moves the
+// last medication into the hole.
+void removeMedicationSlot(supplier *s, int pos)
+{
+    int mask = s->med_set_capacity - 1;
+    int index = s->med_set[pos].index;
+    int last = --s->med_count;
+    if (index != last)
+    {
+        s->medications[index] = s->medications[last];
+        s->med_set[findMedicationSlot(s, s->medications[index])].index = index;
+    }
+
+    // Shift back later entries of the probe run so that lookups never meet a gap early
+    int hole = pos;
+    for (int j = (pos + 1) & mask; s->med_set[j].med != NULL; j = (j + 1) & mask)
+    {
+        int home = medSlotHash(s->med_set[j].med, s->med_set_capacity);
+        Boolean stays = hole <= j ? (hole < home && home <= j) : (hole < home || home <= j);
+        if (!stays)
+        {
+            s->med_set[hole] = s->med_set[j];
+            hole = j;
+        }
+    }
+    s->med_set[hole].med = NULL;
+}
+
+// Drops the link of s to batch batch of med; med leaves s once none of its batches is linked.
+void supplierRemoveLink(supplier *s, data *med, int batch)
+{
+    int pos = findMedicationSlot(s, med);
+    if (pos < 0)
+        return;
+    int *from = &s->med_set[pos].first_link;
+    while (*from >= 0 && s->links[*from].batch != batch)
+        from = &s->links[*from].next;
+    if (*from < 0)
+        return;
+    int removed = *from;
+    *from = s->links[removed].next;
+    if (s->med_set[pos].first_link < 0)
+        removeMedicationSlot(s, pos);
+
+    // Move the last link into the hole and repoint whatever referred to it
+    int last = --s->link_count;
+    if (removed != last)
+    {
+        s->links[removed] = s->links[last];
+        int *ref = &s->med_set[findMedicationSlot(s, s->links[removed].med)].first_link;
+        while (*ref != last)
+            ref = &s->links[*ref].next;
+        *ref = removed;
+    }
+}
+
+// Batch from of med now lives at index to; repoints its suppliers' links.
+void moveBatchLinks(data *med, int from, int to)
+{
+    batch *b = &med->Batch[to];
+    if (b->supplier_count == 0)
+        return;
+    pthread_mutex_lock(&supplier_lock);
+    for (int k = 0; k < b->supplier_count; k++)
+    {
+        supplier_link *link = b->suppliers[k] ? findSupplierLink(b->suppliers[k], med, from) : NULL;
+        if (link)
+            link->batch = to;
+    }
+    pthread_mutex_unlock(&supplier_lock);
+}
+
+void releaseSupplier(void *ptr)
+{
+    supplier *s = (supplier *)ptr;
+    free(s->medications);
+    free(s->med_set);
+    free(s->links);
+    free(s);
+}
+
+Boolean batchHasSupplier(batch *b, supplier *s)
+{
+    for (int k = 0; k < b->supplier_count; k++)
+    {
+        if (b->suppliers[k] == s)
+            return true;
+    }
+    return false;
+}
+
+// Links supplier s to batch b of med as the supplier of qty units received at price each, and
+// keeps the supplier's medication list, edge rows and rankings in step. Fails if the supplier is
+// already on the batch, the batch is full or memory runs out.
+status_code linkSupplierWithSupply(data *med, batch *b, supplier *s, int qty, int price)
+{
+    if (batchHasSupplier(b, s) || b->supplier_count >= MAX_SUPPLIERS)
+        return FAILURE;
+    int edge = addSupplyEdge(s->supplier_id, b->col_row, qty, price);
+    if (edge < 0)
+        return FAILURE;
+    if (supplierAddLink(s, med, (int)(b - med->Batch), b->supplier_count, edge) == FAILURE)
+    {
+        removeSupplyEdge(edge);
+        return FAILURE;
+    }
+
+    preserveRecord(med);
+    b->suppliers[b->supplier_count++] = s;
+    s->supply_volume += qty;
+    s->turnover += (long long)qty * price;
+    rankUpdateSupplier(s);
+    return SUCCESS;
+}
+
+// Links s to batch b of med as a delivery of its usual quantity at today's price.
+status_code linkSupplierToBatch(data *med, batch *b, supplier *s)
+{
+    return linkSupplierWithSupply(med, b, s, s->qty_of_supply, med->priceperunit);
+}
+
+// Removes the supplier in the given slot of batch b. The medication is dropped from the
+// supplier's list once no other batch of med is linked to that supplier.
+void unlinkSupplierFromBatch(data *med, batch *b, int slot)
+{
+    preserveRecord(med);
+    int index = (int)(b - med->Batch);
+    supplier *s = b->suppliers[slot];
+    for (int k = slot; k < b->supplier_count - 1; k++)
+    {
+        b->suppliers[k] = b->suppliers[k + 1];
+        supplier_link *link = b->suppliers[k] ? findSupplierLink(b->suppliers[k], med, index) : NULL;
+        if (link)
+            link->slot = k;
+    }
+    b->supplier_count--;
+
+    if (s == NULL)
+        return;
+    supplier_link *link = findSupplierLink(s, med, index);
+    if (link)
+    {
+        s->supply_volume -= supply_edges.qty[link->edge];
+        s->turnover -= (long long)supply_edges.qty[link->edge] * supply_edges.price[link->edge];
+        removeSupplyEdge(link->edge);
+    }
+    supplierRemoveLink(s, med, index);
+    rankUpdateSupplier(s);
+}
+
+// Unlinks every supplier from batch b, typically just before the batch is removed.
+void unlinkBatchSuppliers(data *med, batch *b)
+{
+    if (b->supplier_count == 0)
+        return;
+    pthread_mutex_lock(&supplier_lock);
+    while (b->supplier_count > 0)
+        unlinkSupplierFromBatch(med, b, b->supplier_count - 1);
+    pthread_mutex_unlock(&supplier_lock);
+}
+
+// Changes the unit price of med. Stock already supplied keeps the price it was received at.
+void setMedicationPrice(data *med, int new_price)
+{
+    if (new_price == med->priceperunit)
+        return;
+    preserveRecord(med);
+    med->priceperunit = new_price;
+    columnsSetPrice(med);
+}
+
+//==========FEFO BATCH QUEUE==========//
+
+// Each medication keeps a min-heap of indexes into its Batch[] array ordered by expiry date
+// (first-expired, first-out), and every batch remembers its slot in fefo_pos. The batch to sell
+// from is always fefo_heap[0]; removing one costs O(log b) and never moves the other batches.
+
+int fefoEarlier(data *med, int a, int b)
+{
+    int cmp = strcmp(med->Batch[a].exp_date, med->Batch[b].exp_date);
+    if (cmp != 0)
+        return cmp < 0;
+    return med->Batch[a].batch_no < med->Batch[b].batch_no;
+}
+
+void fefoSwap(data *med, int i, int j)
+{
+    int temp = med->fefo_heap[i];
+    med->fefo_heap[i] = med->fefo_heap[j];
+    med->fefo_heap[j] = temp;
+    med->Batch[med->fefo_heap[i]].fefo_pos = i;
+    med->Batch[med->fefo_heap[j]].fefo_pos = j;
+}
+
+void fefoSiftUp(data *med, int i)
+{
+    while (i > 0 && fefoEarlier(med, med->fefo_heap[i], med->fefo_heap[parent(i)]))
+    {
+        fefoSwap(med, i, parent(i));
+        i = parent(i);
+    }
+}
+
+void fefoSiftDown(data *med, int i)
+{
+    while (1)
+    {
+        int smallest = i;
+        int l = left(i);
+        int r = right(i);
+
+        if (l < med->batch_count && fefoEarlier(med, med->fefo_heap[l], med->fefo_heap[smallest]))
+            smallest = l;
+        if (r < med->batch_count && fefoEarlier(med, med->fefo_heap[r], med->fefo_heap[smallest]))
+            smallest = r;
+        if (smallest == i)
+            return;
+
+        fefoSwap(med, i, smallest);
+        i = smallest;
+    }
+}
+
+// Queues Batch[index]; the batch must already be counted in med->batch_count.
+void fefoPush(data *med, int index)
+{
+    int pos = med->batch_count - 1;
+    med->fefo_heap[pos] = index;
+    med->Batch[index].fefo_pos = pos;
+    fefoSiftUp(med, pos);
+}
+
+// Returns the index of the earliest-expiring batch, or -1 if med has none.
+int fefoPeek(data *med)
+{
+    return med->batch_count > 0 ? med->fefo_heap[0] : -1;
+}
+
+// Returns the index of the earliest batch still in date on as_of (YYYY-MM-DD), or -1. Expired
+// batches form the top of the heap, so only they and their direct children are examined.
+// If expired_stock is not NULL it receives the units held in expired batches.
+int fefoFirstUnexpired(data *med, const char *as_of, int *expired_stock)
+{
+    int stack[MAX_BATCHES];
+    int depth = 0, best = -1;
+    if (expired_stock)
+        *expired_stock = 0;
+    if (med->batch_count > 0)
+        stack[depth++] = 0;
+
+    while (depth > 0)
+    {
+        int pos = stack[--depth];
+        int index = med->fefo_heap[pos];
+        if (strcmp(med->Batch[index].exp_date, as_of) >= 0)
+        {
+            if (best < 0 || fefoEarlier(med, index, best))
+                best = index;
+            continue;
+        }
+
+        if (expired_stock)
+            *expired_stock += med->Batch[index].qty_instock;
+        if (left(pos) < med->batch_count)
+            stack[depth++] = left(pos);
+        if (right(pos) < med->batch_count)
+            stack[depth++] = right(pos);
+    }
+    return best;
+}
+
+// Removes Batch[index] from med. The last batch is moved into the hole, so only the heap slot
+// of that one batch has to be repointed. Callers unlink suppliers and index entries first.
+void removeBatchAt(data *med, int index)
+{
+    int pos = med->Batch[index].fefo_pos;
+    int last = med->batch_count - 1;
+    columnsRemoveBatch(&med->Batch[index]);
+
+    // Take the batch out of the heap
+    if (pos != last)
+    {
+        fefoSwap(med, pos, last);
+    }
+    med->batch_count--;
+    if (pos < med->batch_count)
+    {
+        fefoSiftUp(med, pos);
+        fefoSiftDown(med, pos);
+    }
+
+    // Fill the hole in Batch[] with the last batch
+    if (index != last)
+    {
+        med->Batch[index] = med->Batch[last];
+        med->fefo_heap[med->Batch[index].fefo_pos] = index;
+        moveBatchLinks(med, last, index);
+    }
+}
+
+//==========LATENCY HISTOGRAMS==========//
+
+// Log-linear histogram in the style of HdrHistogram: values below LATENCY_SUB_BUCKETS ns are
+// exact, larger ones land in one of LATENCY_SUB_BUCKETS linear slots per power of two, which
+// keeps every percentile within ~6% of the true value at a fixed 8 KB per histogram.
+#define LATENCY_SUB_BUCKET_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKETS (64 * LATENCY_SUB_BUCKETS)
+
+typedef struct
+{
+    long long counts[LATENCY_BUCKETS];
+    long long total;
+    long long max;
+} latency_histogram;
+
+long long now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+// Xorshift32 step for benchmark and generator streams; state must start nonzero.
+unsigned int nextRandom(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return *state = x;
+}
+
+int latencyBucket(long long ns)
+{
+    if (ns < LATENCY_SUB_BUCKETS)
+        return ns < 0 ? 0 : (int)ns;
+    int exponent = 63 - __builtin_clzll((unsigned long long)ns);
+    int shift = exponent - LATENCY_SUB_BUCKET_BITS;
+    int mantissa = (int)(ns >> shift) - LATENCY_SUB_BUCKETS;
+    return (shift + 1) * LATENCY_SUB_BUCKETS + mantissa;
+}
+
+// Highest value that maps to the given bucket.
+long long latencyBucketLimit(int bucket)
+{
+    if (bucket < LATENCY_SUB_BUCKETS)
+        return bucket;
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    long long mantissa = bucket % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS;
+    return ((mantissa + 1) << shift) - 1;
+}
+
+// Safe to call from several threads at once.
+void recordLatency(latency_histogram *h, long long ns)
+{
+    __atomic_add_fetch(&h->counts[latencyBucket(ns)], 1, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&h->total, 1, __ATOMIC_RELAXED);
+    long long max = __atomic_load_n(&h->max, __ATOMIC_RELAXED);
+    while (ns > max && !__atomic_compare_exchange_n(&h->max, &max, ns, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+}
+
+// Returns the latency (ns) at or below which `percentile` percent of the samples fall.
+long long latencyPercentile(latency_histogram *h, double percentile)
+{
+    if (h->total == 0)
+        return 0;
+    long long wanted = (long long)(percentile / 100.0 * h->total + 0.5);
+    if (wanted < 1)
+        wanted = 1;
+
+    long long seen = 0;
+    for (int b = 0; b < LATENCY_BUCKETS; b++)
+    {
+        seen += h->counts[b];
+        if (seen >= wanted)
+        {
+            long long limit = latencyBucketLimit(b);
+            return limit < h->max ? limit : h->max;
+        }
+    }
+    return h->max;
+}
+
+void printLatencyPercentiles(const char *label, latency_histogram *h)
+{
+    if (h->total == 0)
+    {
+        printf("%s: no samples yet.\n", label);
+        return;
+    }
+    printf("%s (%lld samples): p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+           label, h->total,
+           latencyPercentile(h, 50) / 1000.0, latencyPercentile(h, 90) / 1000.0,
+           latencyPercentile(h, 99) / 1000.0, latencyPercentile(h, 99.9) / 1000.0,
+           h->max / 1000.0);
+}
+
+//==========OPERATION STATS==========//
+
+// One latency histogram and error counter per operation kind. Menu operations, batch and
+// server commands are timed as a whole (never including time spent waiting for input); the
+// PHASE_ kinds time internal steps that those operations share.
+typedef enum
+{
+    OP_ADD,
+    OP_UPDATE,
+    OP_DELETE,
+    OP_SEARCH,
+    OP_SALE,
+    OP_STOCK_ALERTS,
+    OP_EXPIRY_CHECK,
+    OP_EXPIRY_RANGE,
+    OP_TOP_REPORT,
+    OP_SALES_REPORT,
+    OP_SUPPLIER,
+    OP_PURGE,
+    OP_OTHER,
+    PHASE_TREE_DESCENT,
+    PHASE_BATCH_SORT,
+    PHASE_SAVE,
+    PHASE_LOAD,
+    PHASE_LEDGER_REPLAY,
+    PHASE_INDEX_REBUILD,
+    OP_KINDS
+} op_kind;
+
+const char *op_names[OP_KINDS] = {"add", "update", "delete", "search", "sale", "stock_alerts",
+                                  "expiry_check", "expiry_range", "top_report", "sales_report", "supplier", "purge",
+                                  "other", "tree_descent", "batch_sort", "save", "load", "ledger_replay", "index_rebuild"};
+
+typedef struct
+{
+    latency_histogram latency; // Also counts the operations
+    long long errors;          // Operations that failed or were rejected
+} op_stats;
+
+op_stats operation_stats[OP_KINDS];
+Boolean stats_enabled = true; // Cleared by --no-stats or the statistics menu
+
+// With --trace, every timed operation and phase is also kept as a span in a ring buffer that
+// holds the most recent trace_capacity spans. At exit the buffer is written as Chrome trace
+// JSON, which chrome://tracing and ui.perfetto.dev open directly. Spans of one thread nest, so
+// a sale shows its tree descent inside it.
+#define TRACE_DEFAULT_SPANS 65536
+
+typedef struct
+{
+    long long start; // ns, CLOCK_MONOTONIC
+    long long end;
+    int tid;
+    op_kind kind;
+} trace_span;
+
+trace_span *trace_ring = NULL;
+unsigned long long trace_capacity = 0;
+unsigned long long trace_recorded = 0; // Spans ever recorded; the next goes to slot trace_recorded % trace_capacity
+const char *trace_path = NULL;
+long long trace_origin = 0; // Timestamps in the file are relative to this
+Boolean trace_enabled = false;
+__thread int trace_tid = 0;
+
+void traceSpan(op_kind kind, long long start, long long end)
+{
+    if (trace_tid == 0)
+        trace_tid = (int)syscall(SYS_gettid);
+    unsigned long long slot = __atomic_fetch_add(&trace_recorded, 1, __ATOMIC_RELAXED) % trace_capacity;
+    trace_ring[slot].start = start;
+    trace_ring[slot].end = end;
+    trace_ring[slot].tid = trace_tid;
+    trace_ring[slot].kind = kind;
+}
+
+// Writes the buffered spans, oldest first. Registered with atexit by startTracing.
+void flushTrace()
+{
+    if (!trace_enabled)
+        return;
+    __atomic_store_n(&trace_enabled, false, __ATOMIC_RELAXED);
+    FILE *out = fopen(trace_path, "w");
+    if (!out)
+    {
+        fprintf(stderr, "Cannot write trace file %s\n", trace_path);
+        return;
+    }
+
+    unsigned long long recorded = __atomic_load_n(&trace_recorded, __ATOMIC_ACQUIRE);
+    unsigned long long first = recorded > trace_capacity ? recorded - trace_capacity : 0;
+    int pid = (int)getpid();
+    fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+    fprintf(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"pharmacy\"}}", pid);
+    for (unsigned long long i = first; i < recorded; i++)
+    {
+        trace_span *span = &trace_ring[i % trace_capacity];
+        fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%d,\"tid\":%d}",
+                op_names[span->kind], span->kind > OP_OTHER ? "phase" : "op", (span->start - trace_origin) / 1000.0,
+                (span->end - span->start) / 1000.0, pid, span->tid);
+    }
+    fprintf(out, "\n]}\n");
+    fclose(out);
+    if (first > 0)
+        fprintf(stderr, "Trace kept the last %llu of %llu spans.\n", trace_capacity, recorded);
+}
+
+// Starts recording spans for a trace written to path at exit.
+status_code startTracing(const char *path, unsigned long long capacity)
+{
+    trace_ring = (trace_span *)calloc(capacity, sizeof(trace_span));
+    if (!trace_ring)
+        return FAILURE;
+    trace_capacity = capacity;
+    trace_path = path;
+    trace_origin = now_ns();
+    trace_enabled = true;
+    atexit(flushTrace);
+    return SUCCESS;
+}
+
+// Starts timing an operation. Returns 0 when neither stats nor tracing are on, which makes the
+// matching opEnd a no-op, so a disabled build pays two loads and one branch per operation.
+long long opBegin()
+{
+    if (__atomic_load_n(&stats_enabled, __ATOMIC_RELAXED) || __atomic_load_n(&trace_enabled, __ATOMIC_RELAXED))
+        return now_ns();
+    return 0;
+}
+
+// Ends one piece of an operation that is timed in pieces, such as an update that waits for input
+// between its lookup and its write. The piece gets its own trace span; returns its duration, to be
+// passed on to opEndAfter with the last piece.
+long long opPause(op_kind kind, long long start)
+{
+    if (start == 0)
+        return 0;
+    long long end = now_ns();
+    if (__atomic_load_n(&trace_enabled, __ATOMIC_RELAXED))
+        traceSpan(kind, start, end);
+    return end - start;
+}
+
+// Ends the last piece of an operation whose earlier pieces took `elapsed` nanoseconds. The latency
+// recorded is the sum, so the gaps between the pieces are left out.
+void opEndAfter(op_kind kind, long long start, long long elapsed, Boolean failed)
+{
+    if (start == 0)
+        return;
+    long long end = now_ns();
+    if (__atomic_load_n(&stats_enabled, __ATOMIC_RELAXED))
+    {
+        recordLatency(&operation_stats[kind].latency, elapsed + end - start);
+        if (failed)
+            __atomic_add_fetch(&operation_stats[kind].errors, 1, __ATOMIC_RELAXED);
+    }
+    if (__atomic_load_n(&trace_enabled, __ATOMIC_RELAXED))
+        traceSpan(kind, start, end);
+}
+
+void opEnd(op_kind kind, long long start, Boolean failed)
+{
+    opEndAfter(kind, start, 0, failed);
+}
+
+void resetOperationStats()
+{
+    memset(operation_stats, 0, sizeof(operation_stats));
+}
+
+// Writes one CSV row per operation kind that has samples; latencies are in nanoseconds.
+void dumpOperationStats(FILE *out)
+{
+    fprintf(out, "op,count,errors,p50_ns,p90_ns,p99_ns,p999_ns,max_ns\n");
+    for (int k = 0; k < OP_KINDS; k++)
+    {
+        latency_histogram *h = &operation_stats[k].latency;
+        if (h->total == 0)
+            continue;
+        fprintf(out, "%s,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n", op_names[k], h->total, operation_stats[k].errors,
+                latencyPercentile(h, 50), latencyPercentile(h, 90), latencyPercentile(h, 99),
+                latencyPercentile(h, 99.9), h->max);
+    }
+}
+
+void printOperationStats()
+{
+    printf("Statistics are %s.\n", stats_enabled ? "enabled" : "disabled");
+    printf("%-14s %10s %8s %10s %10s %10s %10s %10s\n", "Operation", "Count", "Errors",
+           "p50 us", "p90 us", "p99 us", "p99.9 us", "max us");
+    Boolean any = false;
+    for (int k = 0; k < OP_KINDS; k++)
+    {
+        latency_histogram *h = &operation_stats[k].latency;
+        if (h->total == 0)
+            continue;
+        any = true;
+        printf("%-14s %10lld %8lld %10.1f %10.1f %10.1f %10.1f %10.1f\n", op_names[k], h->total,
+               operation_stats[k].errors, latencyPercentile(h, 50) / 1000.0, latencyPercentile(h, 90) / 1000.0,
+               latencyPercentile(h, 99) / 1000.0, latencyPercentile(h, 99.9) / 1000.0, h->max / 1000.0);
+    }
+    if (!any)
+        printf("No operations recorded yet.\n");
+}
+
+status_code dumpOperationStatsToFile(const char *path)
+{
+    FILE *out = fopen(path, "w");
+    if (!out)
+        return FAILURE;
+    dumpOperationStats(out);
+    return fclose(out) == 0 ? SUCCESS : FAILURE;
+}
+
+void operationStatsMenu()
+{
+    int choice;
+    do
+    {
+        printf("\nOperation Statistics\n");
+        printf("1. Show\n");
+        printf("2. Dump to file\n");
+        printf("3. %s\n", stats_enabled ? "Disable" : "Enable");
+        printf("4. Reset\n");
+        printf("5. Back\n");
+        printf("Enter your choice: ");
+        if (scanf("%d", &choice) != 1)
+            return;
+
+        switch (choice)
+        {
+        case 1:
+            printOperationStats();
+            break;
+        case 2:
+        {
+            char path[256];
+            printf("Enter file name: ");
+            if (scanf("%255s", path) != 1)
+                return;
+            if (dumpOperationStatsToFile(path) == SUCCESS)
+                printf("Statistics written to %s.\n", path);
+            else
+                printf("Could not write %s.\n", path);
+            break;
+        }
+        case 3:
+            __atomic_store_n(&stats_enabled, !stats_enabled, __ATOMIC_RELAXED);
+            printf("Statistics %s.\n", stats_enabled ? "enabled" : "disabled");
+            break;
+        case 4:
+            resetOperationStats();
+            printf("Statistics reset.\n");
+            break;
+        case 5:
+            break;
+        default:
+            printf("Invalid choice. Please try again.\n");
+        }
+    } while (choice != 5);
+}
+
+//==========WORKLOAD RECORDING==========//
+
+// With --record, every menu operation is appended to a log as the batch command that repeats it
+// (see BATCH MODE), followed by "save" wherever the menu saves. runReplay plays such a log back
+// against a data file. Operations abandoned before all of their input was read are not logged.
+
+FILE *workload_log = NULL;
+
+// Appends one command line to the workload log, if recording.
+void recordWorkload(const char *format, ...)
+{
+    if (!workload_log)
+        return;
+    va_list args;
+    va_start(args, format);
+    vfprintf(workload_log, format, args);
+    va_end(args);
+    fputc('\n', workload_log);
+    fflush(workload_log); // A session that crashes keeps everything up to its last operation
+}
+
+status_code startRecording(const char *path)
+{
+    workload_log = fopen(path, "w");
+    if (!workload_log)
+        return FAILURE;
+    time_t now = time(NULL);
+    fprintf(workload_log, "# pharmacy workload recorded %s", ctime(&now));
+    return SUCCESS;
+}
+
+//==========EPOCH-BASED RECLAMATION==========//
+
+// Lookups and range scans of the index trees take no locks while one writer at a time changes
+// them. Every structural change is bracketed by writeBegin/writeEnd, which hold index_lock
+// exclusively and keep index_version odd while the trees are in flux; a reader samples the
+// version, searches, and retries if it moved. Memory a writer unlinks (nodes, string keys,
+// medication and supplier records) is retired rather than freed, and released only once no
+// reader that entered before it was unlinked is still inside its read section.
+
+#define MAX_READER_THREADS 64 // Threads that can be inside a read section at the same time
+#define RETIRE_BATCH 64       // Retired blocks that trigger a reclamation pass
+
+typedef struct
+{
+    unsigned long long epoch; // Epoch the reader entered, 0 outside a read section
+    int in_use;               // Claimed by a live thread
+    char pad[64 - sizeof(unsigned long long) - sizeof(int)]; // One reader per cache line
+} reader_slot;
+
+typedef struct
+{
+    void *ptr;
+    void (*release)(void *);
+    unsigned long long epoch; // Global epoch when the block was retired
+} retired_block;
+
+unsigned long long global_epoch = 1;
+unsigned long long index_version = 0; // Odd while a writer is changing the index trees
+reader_slot reader_slots[MAX_READER_THREADS];
+pthread_key_t reader_slot_key;
+pthread_once_t reader_slot_once = PTHREAD_ONCE_INIT;
+__thread int my_reader_slot = -1;
+__thread int read_depth = 0;
+__thread int write_depth = 0;
+
+// Owned by the writer holding index_lock
+retired_block *retired_blocks = NULL;
+int retired_count = 0;
+int retired_capacity = 0;
+
+void releaseReaderSlot(void *slot)
+{
+    __atomic_store_n(&reader_slots[(long)slot - 1].in_use, 0, __ATOMIC_RELEASE);
+}
+
+void createReaderSlotKey()
+{
+    pthread_key_create(&reader_slot_key, releaseReaderSlot);
+}
+
+// Gives the calling thread a reader slot for its lifetime, waiting if all are taken.
+void claimReaderSlot()
+{
+    pthread_once(&reader_slot_once, createReaderSlotKey);
+    for (;;)
+    {
+        for (int i = 0; i < MAX_READER_THREADS; i++)
+        {
+            int expected = 0;
+            if (__atomic_compare_exchange_n(&reader_slots[i].in_use, &expected, 1, false,
+                                            __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            {
+                my_reader_slot = i;
+                pthread_setspecific(reader_slot_key, (void *)(long)(i + 1));
+                return;
+            }
+        }
+        sched_yield();
+    }
+}
+
+void readBegin()
+{
+    if (read_depth++ > 0)
+        return;
+    if (my_reader_slot < 0)
+        claimReaderSlot();
+
+    // Publish the epoch, then make sure the writer had not moved past it in the meantime
+    reader_slot *slot = &reader_slots[my_reader_slot];
+    unsigned long long epoch;
+    do
+    {
+        epoch = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+        __atomic_store_n(&slot->epoch, epoch, __ATOMIC_SEQ_CST);
+    } while (epoch != __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST));
+}
+
+void readEnd()
+{
+    if (--read_depth > 0)
+        return;
+    __atomic_store_n(&reader_slots[my_reader_slot].epoch, 0, __ATOMIC_RELEASE);
+}
+
+// Waits for any change in progress to finish and returns the version to validate against.
+unsigned long long readVersion()
+{
+    unsigned long long version;
+    while ((version = __atomic_load_n(&index_version, __ATOMIC_ACQUIRE)) & 1)
+        sched_yield();
+    return version;
+}
+
+// True if no writer touched the trees since readVersion returned version.
+Boolean readValidate(unsigned long long version)
+{
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&index_version, __ATOMIC_RELAXED) == version;
+}
+
+// Defers release(ptr) until no reader can still reach ptr. Writers only.
+void retireMemory(void *ptr, void (*release)(void *))
+{
+    if (ptr == NULL)
+        return;
+    if (retired_count == retired_capacity)
+    {
+        int new_capacity = retired_capacity ? retired_capacity * 2 : RETIRE_BATCH * 2;
+        retired_block *grown = (retired_block *)realloc(retired_blocks, new_capacity * sizeof(retired_block));
+        if (!grown)
+            return; // Leaking the block is safe; freeing it under a reader is not
+        retired_blocks = grown;
+        retired_capacity = new_capacity;
+    }
+    retired_blocks[retired_count].ptr = ptr;
+    retired_blocks[retired_count].release = release;
+    retired_blocks[retired_count].epoch = __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+    retired_count++;
+}
+
+void retireFree(void *ptr)
+{
+    retireMemory(ptr, free);
+}
+
+void releaseMedication(void *med)
+{
+    pthread_mutex_destroy(&((data *)med)->lock);
+    free(med);
+}
+
+// Starts a new epoch and releases every block retired before the oldest active reader entered.
+void reclaimRetired()
+{
+    unsigned long long oldest = __atomic_add_fetch(&global_epoch, 1, __ATOMIC_SEQ_CST);
+    for (int i = 0; i < MAX_READER_THREADS; i++)
+    {
+        unsigned long long epoch = __atomic_load_n(&reader_slots[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < oldest)
+            oldest = epoch;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < retired_count; i++)
+    {
+        if (retired_blocks[i].epoch < oldest)
+            retired_blocks[i].release(retired_blocks[i].ptr);
+        else
+            retired_blocks[kept++] = retired_blocks[i];
+    }
+    retired_count = kept;
+}
+
+// Brackets a change to the index trees. Calls nest; only the outermost pair locks.
+void writeBegin()
+{
+    if (write_depth++ > 0)
+        return;
+    pthread_rwlock_wrlock(&index_lock);
+    __atomic_add_fetch(&index_version, 1, __ATOMIC_SEQ_CST);
+    drainExpiryRemovals();
+}
+
+void writeEnd()
+{
+    if (--write_depth > 0)
+        return;
+    __atomic_add_fetch(&index_version, 1, __ATOMIC_RELEASE);
+    if (retired_count >= RETIRE_BATCH)
+        reclaimRetired();
+    pthread_rwlock_unlock(&index_lock);
+}
+
+//==========KEY SEARCH==========//
+
+// Slot search inside an integer-keyed node: returns how many of keys[0..n) are smaller than
+// key, which is both the position of key if present and the child to descend into otherwise.
+// The vector versions compare a whole node at once and count the set mask bits; lanes past n
+// are masked off, so the padding slot and keys beyond num_keys may hold anything.
+
+int keySlotScalar(const int *keys, int n, int key)
+{
+    int i = 0;
+    while (i < n && key > keys[i])
+        i++;
+    return i;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2"))) int keySlotSSE2(const int *keys, int n, int key)
+{
+    __m128i k = _mm_set1_epi32(key);
+    unsigned mask = 0;
+    for (int i = 0; i < INT_ORDER; i += 4)
+    {
+        __m128i lt = _mm_cmpgt_epi32(k, _mm_load_si128((const __m128i *)(keys + i)));
+        mask |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(lt)) << i;
+    }
+    return __builtin_popcount(mask & ((1u << n) - 1));
+}
+
+__attribute__((target("avx2"))) int keySlotAVX2(const int *keys, int n, int key)
+{
+    __m256i k = _mm256_set1_epi32(key);
+    unsigned mask = 0;
+    for (int i = 0; i < INT_ORDER; i += 8)
+    {
+        __m256i lt = _mm256_cmpgt_epi32(k, _mm256_load_si256((const __m256i *)(keys + i)));
+        mask |= (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(lt)) << i;
+    }
+    return __builtin_popcount(mask & ((1u << n) - 1));
+}
+#endif
+
+typedef struct
+{
+    const char *name;
+    int (*search)(const int *keys, int n, int key);
+} key_search_impl;
+
+// Every implementation the running CPU supports, best last.
+int keySearchImpls(key_search_impl impls[])
+{
+    int count = 0;
+    impls[count++] = (key_search_impl){"scalar", keySlotScalar};
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("sse2"))
+        impls[count++] = (key_search_impl){"sse2", keySlotSSE2};
+    if (__builtin_cpu_supports("avx2"))
+        impls[count++] = (key_search_impl){"avx2", keySlotAVX2};
+#endif
+    return count;
+}
+
+int keySlotResolve(const int *keys, int n, int key);
+
+// Starts at the resolver, which swaps in the best implementation on first use.
+int (*keySlot)(const int *keys, int n, int key) = keySlotResolve;
+
+int keySlotResolve(const int *keys, int n, int key)
+{
+    key_search_impl impls[3];
+    int count = keySearchImpls(impls);
+    __atomic_store_n(&keySlot, impls[count - 1].search, __ATOMIC_RELAXED);
+    return impls[count - 1].search(keys, n, key);
+}
+
+void convert_date_format(const char *input_date, char *output_date)
+{
+    // Assuming input_date is in the format "DD-MM-YYYY"
+    // output_date should be a buffer of at least 11 bytes
+    char day[3], month[3], year[5];
+
+    // Extract parts using sscanf
+    sscanf(input_date, "%2s-%2s-%4s", day, month, year);
+
+    // Rearrange into YYYY-MM-DD
+    sprintf(output_date, "%s-%s-%s", year, month, day);
+}
+
+void reverse_date_format(const char *input_date, char *output_date)
+{
+    // Assuming input_date is in the format "YYYY-MM-DD"
+    // output_date should be a buffer of at least 11 bytes
+    char day[3], month[3], year[5];
+
+    // Extract parts using sscanf
+    sscanf(input_date, "%4s-%2s-%2s", year, month, day);
+
+    // Rearrange into DD-MM-YYYY
+    sprintf(output_date, "%s-%s-%s", day, month, year);
+}
+
+B *create_node()
+{
+    B *new_node = (B *)aligned_alloc(32, sizeof(B));
+    new_node->num_keys = 0;
+    new_node->is_leaf = 1;
+    new_node->subtree_size = 0;
+    for (int i = 0; i < INT_ORDER; i++)
+        new_node->children[i] = NULL;
+    return new_node;
+}
+
+// Recomputes node->subtree_size from its own keys and its children's counts.
+void recount_node(B *node)
+{
+    int size = node->num_keys;
+    if (!node->is_leaf)
+    {
+        for (int i = 0; i <= node->num_keys; i++)
+        {
+            if (node->children[i])
+                size += node->children[i]->subtree_size;
+        }
+    }
+    node->subtree_size = size;
+}
+
+void split_child(B *parent, int index, B *child)
+{
+    B *new_child = create_node();
+    new_child->is_leaf = child->is_leaf;
+    new_child->num_keys = (INT_ORDER / 2) - 1;
+
+    for (int i = 0; i < (INT_ORDER / 2) - 1; i++)
+    {
+        new_child->keys[i] = child->keys[i + (INT_ORDER / 2)];
+        new_child->values[i] = child->values[i + (INT_ORDER / 2)];
+    }
+
+    if (!child->is_leaf)
+    {
+        for (int i = 0; i < INT_ORDER / 2; i++)
+            new_child->children[i] = child->children[i + (INT_ORDER / 2)];
+    }
+
+    child->num_keys = (INT_ORDER / 2) - 1;
+
+    for (int i = parent->num_keys; i >= index + 1; i--)
+        parent->children[i + 1] = parent->children[i];
+    __atomic_thread_fence(__ATOMIC_RELEASE); // Lock-free readers must only reach a complete node
+    parent->children[index + 1] = new_child;
+
+    for (int i = parent->num_keys - 1; i >= index; i--)
+    {
+        parent->keys[i + 1] = parent->keys[i];
+        parent->values[i + 1] = parent->values[i];
+    }
+
+    parent->keys[index] = child->keys[(INT_ORDER / 2) - 1];
+    parent->values[index] = child->values[(INT_ORDER / 2) - 1];
+    parent->num_keys++;
+
+    // The parent's total is unchanged; only the two halves need recounting
+    recount_node(child);
+    recount_node(new_child);
+}
+
+void insert_non_full(B *node, int key, data *value)
+{
+    int i = node->num_keys - 1;
+
+    if (node->is_leaf)
+    {
+        while (i >= 0 && key < node->keys[i])
+        {
+            node->keys[i + 1] = node->keys[i];
+            node->values[i + 1] = node->values[i];
+            i--;
+        }
+        node->keys[i + 1] = key;
+        node->values[i + 1] = value;
+        node->num_keys++;
+        node->subtree_size++;
+    }
+    else
+    {
+        while (i >= 0 && key < node->keys[i])
+            i--;
+        i++;
+        if (node->children[i]->num_keys == INT_ORDER - 1)
+        {
+            split_child(node, i, node->children[i]);
+            if (key > node->keys[i])
+                i++;
+        }
+        insert_non_full(node->children[i], key, value);
+        node->subtree_size++;
+    }
+}
+void insert_int(B **root, int key, data *value)
+{
+    if (*root == NULL)
+    {
+        *root = create_node();
+        (*root)->keys[0] = key;
+        (*root)->values[0] = value;
+        (*root)->num_keys = 1;
+        (*root)->subtree_size = 1;
+    }
+    else
+    {
+        if ((*root)->num_keys == INT_ORDER - 1)
+        {
+            B *new_root = create_node();
+            new_root->is_leaf = 0;
+            new_root->children[0] = *root;
+            split_child(new_root, 0, *root);
+            recount_node(new_root);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            *root = new_root;
+        }
+        insert_non_full(*root, key, value);
+    }
+}
+
+B *medIDTree = NULL;
+B_str *mednameTree = NULL;
+B_str *expDateTree = NULL;
+B_supp *supplierTree = NULL;
+
+// Expiry entries of batches that sales emptied. Sales only hold index_lock shared, so they
+// cannot change the trees; the entries are queued and removed by the next writer before it
+// does anything else, which also keeps a medication from being retired while one still points
+// at it.
+typedef struct
+{
+    char exp_date[MAX_DATE_LENGTH];
+    data *med;
+} expiry_removal;
+
+expiry_removal *expiry_removals = NULL;
+int expiry_removal_count = 0;
+int expiry_removal_capacity = 0;
+pthread_mutex_t expiry_removal_lock = PTHREAD_MUTEX_INITIALIZER;
+
+status_code queueExpiryRemoval(data *med, const char *exp_date)
+{
+    if (write_depth > 0)
+    {
+        expDateTree = deleteFromBTreeStr(expDateTree, (char *)exp_date, med);
+        return SUCCESS;
+    }
+    pthread_mutex_lock(&expiry_removal_lock);
+    if (expiry_removal_count == expiry_removal_capacity)
+    {
+        int capacity = expiry_removal_capacity ? expiry_removal_capacity * 2 : 64;
+        expiry_removal *grown = (expiry_removal *)realloc(expiry_removals, capacity * sizeof(expiry_removal));
+        if (grown == NULL)
+        {
+            pthread_mutex_unlock(&expiry_removal_lock);
+            printf("Memory allocation failed for expiry removal.\n");
+            return FAILURE;
+        }
+        expiry_removals = grown;
+        expiry_removal_capacity = capacity;
+    }
+    expiry_removal *r = &expiry_removals[expiry_removal_count++];
+    strcpy(r->exp_date, exp_date);
+    r->med = med;
+    pthread_mutex_unlock(&expiry_removal_lock);
+    return SUCCESS;
+}
+
+// Called by writeBegin with index_lock held exclusively
+void drainExpiryRemovals()
+{
+    pthread_mutex_lock(&expiry_removal_lock);
+    for (int i = 0; i < expiry_removal_count; i++)
+    {
+        expDateTree = deleteFromBTreeStr(expDateTree, expiry_removals[i].exp_date, expiry_removals[i].med);
+    }
+    expiry_removal_count = 0;
+    pthread_mutex_unlock(&expiry_removal_lock);
+}
+
+B_str *create_node_str()
+{
+    B_str *new_node = (B_str *)malloc(sizeof(B_str));
+    new_node->num_keys = 0;
+    new_node->is_leaf = 1;
+    new_node->subtree_size = 0;
+    for (int i = 0; i < ORDER; i++)
+        new_node->children[i] = NULL;
+    return new_node;
+}
+
+void recount_node_str(B_str *node)
+{
+    int size = node->num_keys;
+    if (!node->is_leaf)
+    {
+        for (int i = 0; i <= node->num_keys; i++)
+        {
+            if (node->children[i])
+                size += node->children[i]->subtree_size;
+        }
+    }
+    node->subtree_size = size;
+}
+
+void split_child_str(B_str *parent, int index, B_str *child)
+{
+    B_str *new_child = create_node_str();
+    new_child->is_leaf = child->is_leaf;
+    new_child->num_keys = (ORDER / 2) - 1;
+
+    for (int i = 0; i < (ORDER / 2) - 1; i++)
+    {
+        new_child->keys[i] = child->keys[i + (ORDER / 2)];
+        new_child->values[i] = child->values[i + (ORDER / 2)];
+    }
+
+    if (!child->is_leaf)
+    {
+        for (int i = 0; i < ORDER / 2; i++)
+            new_child->children[i] = child->children[i + (ORDER / 2)];
+    }
+
+    child->num_keys = (ORDER / 2) - 1;
+
+    for (int i = parent->num_keys; i >= index + 1; i--)
+        parent->children[i + 1] = parent->children[i];
+    __atomic_thread_fence(__ATOMIC_RELEASE); // Lock-free readers must only reach a complete node
+    parent->children[index + 1] = new_child;
+
+    for (int i = parent->num_keys - 1; i >= index; i--)
+    {
+        parent->keys[i + 1] = parent->keys[i];
+        parent->values[i + 1] = parent->values[i];
+    }
+
+    parent->keys[index] = child->keys[(ORDER / 2) - 1];
+    parent->values[index] = child->values[(ORDER / 2) - 1];
+    parent->num_keys++;
+
+    // The parent's total is unchanged; only the two halves need recounting
+    recount_node_str(child);
+    recount_node_str(new_child);
+}
+
+// Orders string-tree entries by key and then by record address. Keys repeat (medications share
+// expiry dates and may share names), and so can whole entries: expDateTree holds one entry per
+// batch, so a medication with two batches expiring on the same day has two identical (date,
+// record) entries. A delete removes one of the matches; since they are interchangeable, the
+// tree ends up the same whichever one it removes.
+int compareEntryStr(const char *key, const data *value, const char *other_key, const data *other_value)
+{
+    int cmp = strcmp(key, other_key);
+    if (cmp != 0)
+        return cmp;
+    return ((uintptr_t)value > (uintptr_t)other_value) - ((uintptr_t)value < (uintptr_t)other_value);
+}
+
+void insert_non_full_str(B_str *node, char *key, data *value)
+{
+    int i = node->num_keys - 1;
+    if (node->is_leaf)
+    {
+        while (i >= 0 && compareEntryStr(key, value, node->keys[i], node->values[i]) < 0)
+        {
+            node->keys[i + 1] = node->keys[i];
+            node->values[i + 1] = node->values[i];
+            i--;
+        }
+        node->keys[i + 1] = strdup(key);
+        node->values[i + 1] = value;
+        node->num_keys++;
+        node->subtree_size++;
+    }
+    else
+    {
+        while (i >= 0 && compareEntryStr(key, value, node->keys[i], node->values[i]) < 0)
+            i--;
+        i++;
+        if (node->children[i]->num_keys == ORDER - 1)
+        {
+            split_child_str(node, i, node->children[i]);
+            if (compareEntryStr(key, value, node->keys[i], node->values[i]) > 0)
+                i++;
+        }
+        insert_non_full_str(node->children[i], key, value);
+        node->subtree_size++;
+    }
+}
+
+void insert_str(B_str **root, char *key, data *value)
+{
+    if (*root == NULL)
+    {
+        *root = create_node_str();
+        (*root)->keys[0] = strdup(key);
+        (*root)->values[0] = value;
+        (*root)->num_keys = 1;
+        (*root)->subtree_size = 1;
+    }
+    else
+    {
+        if ((*root)->num_keys == ORDER - 1)
+        {
+            B_str *new_root = create_node_str();
+            new_root->is_leaf = 0;
+            new_root->children[0] = *root;
+            split_child_str(new_root, 0, *root);
+            recount_node_str(new_root);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            *root = new_root;
+        }
+        insert_non_full_str(*root, key, value);
+    }
+}
+
+B_supp *create_node_supp()
+{
+    B_supp *new_node = (B_supp *)aligned_alloc(32, sizeof(B_supp));
+    new_node->num_keys = 0;
+    new_node->is_leaf = 1;
+    new_node->subtree_size = 0;
+    for (int i = 0; i < INT_ORDER; i++)
+        new_node->children[i] = NULL;
+    return new_node;
+}
+
+void recount_node_supp(B_supp *node)
+{
+    recount_node((B *)node);
+}
+
+void split_child_supp(B_supp *parent, int index, B_supp *child)
+{
+    B_supp *new_child = create_node_supp();
+    new_child->is_leaf = child->is_leaf;
+    new_child->num_keys = (INT_ORDER / 2) - 1;
+
+    for (int i = 0; i < (INT_ORDER / 2) - 1; i++)
+    {
+        new_child->keys[i] = child->keys[i + (INT_ORDER / 2)];
+        new_child->values[i] = child->values[i + (INT_ORDER / 2)];
+    }
+
+    if (!child->is_leaf)
+    {
+        for (int i = 0; i < INT_ORDER / 2; i++)
+            new_child->children[i] = child->children[i + (INT_ORDER / 2)];
+    }
+
+    child->num_keys = (INT_ORDER / 2) - 1;
+
+    for (int i = parent->num_keys; i >= index + 1; i--)
+        parent->children[i + 1] = parent->children[i];
+    __atomic_thread_fence(__ATOMIC_RELEASE); // Lock-free readers must only reach a complete node
+    parent->children[index + 1] = new_child;
+
+    for (int i = parent->num_keys - 1; i >= index; i--)
+    {
+        parent->keys[i + 1] = parent->keys[i];
+        parent->values[i + 1] = parent->values[i];
+    }
+
+    parent->keys[index] = child->keys[(INT_ORDER / 2) - 1];
+    parent->values[index] = child->values[(INT_ORDER / 2) - 1];
+    parent->num_keys++;
+
+    // The parent's total is unchanged; only the two halves need recounting
+    recount_node_supp(child);
+    recount_node_supp(new_child);
+}
+
+void insert_non_full_supp(B_supp *node, int key, supplier *value)
+{
+    int i = node->num_keys - 1;
+    if (node->is_leaf)
+    {
+        while (i >= 0 && key < node->keys[i])
+        {
+            node->keys[i + 1] = node->keys[i];
+            node->values[i + 1] = node->values[i];
+            i--;
+        }
+        node->keys[i + 1] = key;
+        node->values[i + 1] = value;
+        node->num_keys++;
+        node->subtree_size++;
+    }
+    else
+    {
+        while (i >= 0 && key < node->keys[i])
+            i--;
+        i++;
+        if (node->children[i]->num_keys == INT_ORDER - 1)
+        {
+            split_child_supp(node, i, node->children[i]);
+            if (key > node->keys[i])
+                i++;
+        }
+        insert_non_full_supp(node->children[i], key, value);
+        node->subtree_size++;
+    }
+}
+
+void insert_supp(B_supp **root, int key, supplier *value)
+{
+    // The tree stores the caller's supplier itself: batches and rankings hold the same pointer
+    if (*root == NULL)
+    {
+        *root = create_node_supp();
+        (*root)->keys[0] = key;
+        (*root)->values[0] = value;
+        (*root)->num_keys = 1;
+        (*root)->subtree_size = 1;
+    }
+    else
+    {
+        if ((*root)->num_keys == INT_ORDER - 1)
+        {
+            B_supp *new_root = create_node_supp();
+            new_root->is_leaf = 0;
+            new_root->children[0] = *root;
+            split_child_supp(new_root, 0, *root);
+            recount_node_supp(new_root);
+            __atomic_thread_fence(__ATOMIC_RELEASE);
+            *root = new_root;
+        }
+        insert_non_full_supp(*root, key, value);
+    }
+}
+supplier *search_supplier(B_supp *root, int supplier_id)
+{
+    if (root == NULL)
+        return NULL;
+
+    // Find the first key greater than or equal to supplier_id
+    int i = keySlot(root->keys, root->num_keys, supplier_id);
+
+    // If the key is found, return the associated supplier data
+    if (i < root->num_keys && root->keys[i] == supplier_id)
+        return root->values[i];
+
+    // If the node is a leaf, the key doesn't exist
+    if (root->is_leaf)
+        return NULL;
+
+    // Search in the appropriate child node
+    return search_supplier(root->children[i], supplier_id);
+}
+// Returns the medication with medID, creating and indexing it first if it does not exist yet.
+data *findOrCreateMedication(B **medIDTree, B_str **mednameTree, int medID, const char *medname,
+                             int priceperunit, int reorder_lvl)
+{
+    writeBegin();
+    data *med = search_medID(*medIDTree, medID);
+    if (med != NULL)
+    {
+        writeEnd();
+        return med;
+    }
+
+    med = (data *)malloc(sizeof(data));
+    if (!med || columnsAddMedication(med) == FAILURE)
+    {
+        free(med);
+        writeEnd();
+        return NULL;
+    }
+
+    // Initialize medication
+    med->medID = medID;
+    strncpy(med->medname, medname, MAX_NAME_LENGTH);
+    med->medname[MAX_NAME_LENGTH - 1] = '\0';
+    med->reorder_lvl = reorder_lvl;
+    med->priceperunit = priceperunit;
+    med->batch_count = 0;
+    initSalesRollups(med);
+    pthread_mutex_init(&med->lock, NULL);
+    med->cow_version = latest_snapshot_id; // Not part of any open snapshot
+
+    insert_int(medIDTree, med->medID, med);
+    insert_str(mednameTree, med->medname, med);
+    writeEnd();
+    return med;
+}
+
+// Appends a batch to med, queues it for FEFO sales and indexes its expiry date (YYYY-MM-DD).
+// Returns NULL when the medication already holds MAX_BATCHES batches.
+batch *addBatchToMedication(B_str **expDateTree, data *med, int batch_no, int qty_instock, const char *exp_date)
+{
+    if (med->batch_count >= MAX_BATCHES)
+        return NULL;
+
+    writeBegin();
+    int row = columnsAddBatch(med, qty_instock, exp_date);
+    if (row < 0)
+    {
+        writeEnd();
+        return NULL;
+    }
+    preserveRecord(med);
+    // Initialize new batch
+    int index = med->batch_count;
+    batch *newBatch = &med->Batch[index];
+    newBatch->col_row = row;
+    newBatch->batch_no = batch_no;
+    newBatch->qty_instock = qty_instock;
+    strncpy(newBatch->exp_date, exp_date, MAX_DATE_LENGTH);
+    newBatch->exp_date[MAX_DATE_LENGTH - 1] = '\0';
+    newBatch->supplier_count = 0;
+    med->batch_count++;
+    fefoPush(med, index);
+    insert_str(expDateTree, newBatch->exp_date, med);
+    writeEnd();
+    return newBatch;
+}
+
+// Allocates a supplier, indexes it in supplierTree and registers it with the rankings.
+supplier *createSupplier(B_supp **supplierTree, int supplier_id, const char *supp_name, int qty_of_supply, long long contact)
+{
+    supplier *s = (supplier *)malloc(sizeof(supplier));
+    if (!s)
+        return NULL;
+
+    s->supplier_id = supplier_id;
+    strncpy(s->supp_name, supp_name, MAX_NAME_LENGTH);
+    s->supp_name[MAX_NAME_LENGTH - 1] = '\0';
+    s->qty_of_supply = qty_of_supply;
+    s->contact = contact;
+    s->medications = NULL;
+    s->med_count = 0;
+    s->med_capacity = 0;
+    s->med_set = NULL;
+    s->med_set_capacity = 0;
+    s->links = NULL;
+    s->link_count = 0;
+    s->link_capacity = 0;
+    s->supply_volume = 0;
+    s->turnover = 0;
+
+    writeBegin();
+    if (supplier_id >= 0 && supplier_id < MAX_SUPPLIERS)
+        suppliers_active[supplier_id] = 1;
+    insert_supp(supplierTree, supplier_id, s);
+    rankAddSupplier(s);
+    writeEnd();
+    return s;
+}
+
+void addMedicationGeneral(B **medIDTree, B_str **mednameTree, B_str **expDateTree, B_supp **supplierTree)
+{
+    // Input medication data
+    int medID, batch_no, priceperunit, qty_instock, reorder_lvl;
+    char medname[MAX_NAME_LENGTH];
+    char exp_date[MAX_DATE_LENGTH];
+
+    printf("\n=== Add New Medication ===\n");
+    printf("Enter Medication ID: ");
+    scanf("%d", &medID);
+    printf("Enter Medication Name: ");
+    scanf(" %[^\n]", medname);
+    printf("Enter Batch Number: ");
+    scanf("%d", &batch_no);
+    printf("Enter Price per Unit: ");
+    scanf("%d", &priceperunit);
+    printf("Enter Quantity in Stock: ");
+    scanf("%d", &qty_instock);
+    printf("Enter Expiry Date (YYYY-MM-DD): ");
+    scanf(" %10s", exp_date);
+    printf("Enter Reorder Level: ");
+    scanf("%d", &reorder_lvl);
+
+    // Medication search or create; the supplier prompts below are not timed
+    long long start = opBegin();
+    data *med = findOrCreateMedication(medIDTree, mednameTree, medID, medname, priceperunit, reorder_lvl);
+    if (!med)
+    {
+        opEnd(OP_ADD, start, true);
+        printf("Memory allocation failed for medication\n");
+        return;
+    }
+
+    batch *newBatch = addBatchToMedication(expDateTree, med, batch_no, qty_instock, exp_date);
+    opEnd(OP_ADD, start, newBatch == NULL);
+    if (newBatch == NULL)
+    {
+        printf("Error: Maximum batches (%d) reached for this medication\n", MAX_BATCHES);
+        return;
+    }
+
+    // Supplier handling
+    int supplier_id;
+    printf("\n=== Supplier Information ===\n");
+    printf("Enter Supplier ID: ");
+    scanf("%d", &supplier_id);
+
+    char formatted_exp[MAX_DATE_LENGTH];
+    reverse_date_format(exp_date, formatted_exp); // Batch commands take DD-MM-YYYY
+    supplier *existingSupplier = search_supplier(*supplierTree, supplier_id);
+    if (existingSupplier == NULL)
+    {
+        // New supplier
+        char supp_name[MAX_NAME_LENGTH];
+        int qty_of_supply;
+        long long contact;
+        printf("Enter Supplier Name: ");
+        scanf(" %[^\n]", supp_name);
+        printf("Enter Quantity Supplied: ");
+        scanf("%d", &qty_of_supply);
+        printf("Enter Supplier Contact: ");
+        scanf("%lld", &contact);
+        recordWorkload("add,%d,%s,%d,%d,%d,%s,%d,%d,%s,%d,%lld", medID, medname, batch_no, priceperunit,
+                       qty_instock, formatted_exp, reorder_lvl, supplier_id, supp_name, qty_of_supply, contact);
+
+        existingSupplier = createSupplier(supplierTree, supplier_id, supp_name, qty_of_supply, contact);
+        if (!existingSupplier)
+        {
+            printf("Memory allocation failed for supplier\n");
+            return;
+        }
+    }
+    else
+    {
+        recordWorkload("add,%d,%s,%d,%d,%d,%s,%d,%d", medID, medname, batch_no, priceperunit, qty_instock,
+                       formatted_exp, reorder_lvl, supplier_id);
+    }
+
+    // Link supplier to batch; this also links the medication to the supplier
+    if (linkSupplierToBatch(med, newBatch, existingSupplier) == SUCCESS)
+    {
+        printf("Supplier linked to batch successfully.\n");
+    }
+    else if (newBatch->supplier_count >= MAX_SUPPLIERS)
+    {
+        printf("Warning: Maximum suppliers (%d) reached for this batch\n", MAX_SUPPLIERS);
+    }
+    else
+    {
+        printf("Memory allocation failed for the supplier link\n");
+    }
+}
+
+void inorderBTree(B *root)
+{
+    if (root != NULL)
+    {
+        for (int i = 0; i < root->num_keys; i++)
+        {
+            inorderBTree(root->children[i]);
+            printf("%d ", root->keys[i]); // Print medID
+        }
+        inorderBTree(root->children[root->num_keys]);
+    }
+}
+
+void inorderBTreeStr(B_str *root)
+{
+    if (root != NULL)
+    {
+        for (int i = 0; i < root->num_keys; i++)
+        {
+            inorderBTreeStr(root->children[i]);
+            printf("%s ", root->keys[i]); // Print medname or exp_date
+        }
+        inorderBTreeStr(root->children[root->num_keys]);
+    }
+}
+void inorderBTreeExp(B_str *root)
+{
+    if (root != NULL)
+    {
+        for (int i = 0; i < root->num_keys; i++)
+        {
+            inorderBTreeExp(root->children[i]);
+
+            // Convert and print the date in DD-MM-YYYY format
+            char formatted_date[11];
+            reverse_date_format(root->keys[i], formatted_date);
+            printf("%s ", formatted_date);
+        }
+        inorderBTreeExp(root->children[root->num_keys]);
+    }
+}
+
+void inorderBTreeSupp(B_supp *root)
+{
+    if (root != NULL)
+    {
+        for (int i = 0; i < root->num_keys; i++)
+        {
+            // Traverse left child first
+            inorderBTreeSupp(root->children[i]);
+
+            // Print supplier details
+            printf("Supplier ID: %d\n", root->keys[i]);
+            printf("Supplier Name: %s\n", root->values[i]->supp_name);
+            printf("Quantity of Supply: %d\n", root->values[i]->qty_of_supply);
+            printf("Contact: %lld\n", root->values[i]->contact);
+            printf("Medications Supplied:\n");
+            if (root->values[i]->med_count > 0)
+            {
+
+                for (int j = 0; j < root->values[i]->med_count; j++)
+                {
+                    if (root->values[i]->medications[j] != NULL)
+                    {
+                        printf("  - %s (ID: %d)\n",
+                               root->values[i]->medications[j]->medname,
+                               root->values[i]->medications[j]->medID);
+                    }
+                }
+            }
+            else
+            {
+                printf("  (No medications recorded)\n");
+            }
+            printf("\n");
+        }
+        // Traverse rightmost child
+        inorderBTreeSupp(root->children[root->num_keys]);
+    }
+}
+void searchMedicationBymedId(int medId, B *medIDTree)
+{
+    long long start = opBegin();
+    B *current = medIDTree;
+    while (current != NULL)
+    {
+        int i = 0;
+        while (i < current->num_keys && medId > current->keys[i])
+        {
+            i++;
+        }
+
+        if (i < current->num_keys && medId == current->keys[i])
+        {
+            data *med = current->values[i];
+            printf("\nMedication Details:\n");
+            printf("ID: %d\n", med->medID);
+            printf("Name: %s\n", med->medname);
+            printf("Price per unit: %d\n", med->priceperunit);
+            printf("Reorder level: %d\n", med->reorder_lvl);
+            printf("Batch Count: %d\n", med->batch_count);
+
+            for (int j = 0; j < med->batch_count; j++)
+            {
+                printf("\nBatch %d:\n", j + 1);
+                printf("  Batch No: %d\n", med->Batch[j].batch_no);
+                printf("  Expiry Date: %s\n", med->Batch[j].exp_date);
+                printf("  Quantity in Stock: %d\n", med->Batch[j].qty_instock);
+                printf("  Suppliers: ");
+
+                if (med->Batch[j].supplier_count == 0)
+                {
+                    printf("None\n");
+                }
+                else
+                {
+                    for (int k = 0; k < med->Batch[j].supplier_count; k++)
+                    {
+                        if (med->Batch[j].suppliers[k])
+                        {
+                            printf("%s (ID: %d)",
+                                   med->Batch[j].suppliers[k]->supp_name,
+                                   med->Batch[j].suppliers[k]->supplier_id);
+                            if (k < med->Batch[j].supplier_count - 1)
+                                printf(", ");
+                        }
+                    }
+                    printf("\n");
+                }
+            }
+            opEnd(OP_SEARCH, start, false);
+            return;
+        }
+
+        if (current->is_leaf)
+        {
+            break;
+        }
+        else
+        {
+            current = current->children[i];
+        }
+    }
+    opEnd(OP_SEARCH, start, true);
+    printf("Medication with ID %d not found.\n", medId);
+}
+
+void searchMedicationBymedname(char *medname, B_str *mednameTree)
+{
+    long long start = opBegin();
+    B_str *current = mednameTree;
+    while (current != NULL)
+    {
+        int i = 0;
+        while (i < current->num_keys && strcmp(medname, current->keys[i]) > 0)
+        {
+            i++;
+        }
+        if (i < current->num_keys && strcmp(medname, current->keys[i]) == 0)
+        {
+            printf("Medication found: Name %s\n", medname);
+            printf("ID: %d\n", current->values[i]->medID);
+            printf("Batch Count: %d\n", current->values[i]->batch_count);
+            for (int j = 0; j < current->values[i]->batch_count; j++)
+            {
+                printf("Batch No: %d, Expiry Date: %s, Quantity in Stock: %d\n",
+                       current->values[i]->Batch[j].batch_no,
+                       current->values[i]->Batch[j].exp_date,
+                       current->values[i]->Batch[j].qty_instock);
+            }
+            printf("Reorder Level: %d\n", current->values[i]->reorder_lvl);
+            opEnd(OP_SEARCH, start, false);
+            return;
+        }
+        if (current->is_leaf)
+        {
+            break;
+        }
+        else
+        {
+            current = current->children[i];
+        }
+    }
+    opEnd(OP_SEARCH, start, true);
+    printf("Medication with name %s not found.\n", medname);
+}
+void updateMedication(int medID)
+{
+    // Search for existing medication by medID. Only the lookup and the final write are timed,
+    // the prompts in between are not.
+    long long start = opBegin();
+    data *med = search_medID(medIDTree, medID);
+    if (med == NULL)
+    {
+        opEnd(OP_UPDATE, start, true);
+        recordWorkload("update,%d,-1,-1,-1", medID);
+        printf("Medication with ID %d not found.\n", medID);
+        return;
+    }
+    else
+    {
+        long long lookup = opPause(OP_UPDATE, start);
+        printf("enter the new price of medication\n");
+        int new_price;
+        scanf("%d", &new_price);
+        setMedicationPrice(med, new_price);
+        printf("enter the batch number whose quantity is to be updated");
+        int batch_no;
+        scanf("%d", &batch_no);
+        int i;
+        for (i = 0; i < med->batch_count; i++)
+        {
+            if (med->Batch[i].batch_no == batch_no)
+            {
+                break;
+            }
+        }
+        if (i == med->batch_count)
+        {
+            opEndAfter(OP_UPDATE, start ? opBegin() : 0, lookup, true);
+            recordWorkload("update,%d,%d,-1,-1", medID, new_price);
+            printf("Batch number %d not found for medication ID %d.\n", batch_no, medID);
+            return;
+        }
+        printf("enter the new quantity of medication\n");
+        int new_qty;
+        scanf("%d", &new_qty);
+        long long write = start ? opBegin() : 0;
+        preserveRecord(med);
+        med->Batch[i].qty_instock = new_qty;
+        columnsSetQty(&med->Batch[i]);
+        opEndAfter(OP_UPDATE, write, lookup, false);
+        recordWorkload("update,%d,%d,%d,%d", medID, new_price, batch_no, new_qty);
+        printf("Batch number %d updated successfully for medication ID %d.\n", batch_no, medID);
+    }
+}
+
+B *precedingNode(B *node, int index)
+{
+    B *current = node->children[index];
+    while (current->children[0] != NULL)
+        current = current->children[current->num_keys];
+    return current;
+}
+
+B *successiveNode(B *node, int index)
+{
+    B *current = node->children[index + 1];
+    while (current->children[0] != NULL)
+        current = current->children[0];
+    return current;
+}
+
+B *borrowFromPrev(B *node, int index)
+{
+    B *child = node->children[index];
+    B *sibling = node->children[index - 1];
+
+    for (int i = child->num_keys - 1; i >= 0; i--)
+    {
+        child->keys[i + 1] = child->keys[i];
+        child->values[i + 1] = child->values[i];
+    }
+
+    if (!child->is_leaf)
+    {
+        for (int i = child->num_keys; i >= 0; i--)
+            child->children[i + 1] = child->children[i];
+    }
+
+    child->keys[0] = node->keys[index - 1];
+    child->values[0] = node->values[index - 1];
+
+    if (!child->is_leaf)
+        child->children[0] = sibling->children[sibling->num_keys];
+
+    node->keys[index - 1] = sibling->keys[sibling->num_keys - 1];
+    node->values[index - 1] = sibling->values[sibling->num_keys - 1];
+
+    child->num_keys++;
+    sibling->num_keys--;
+    recount_node(child);
+    recount_node(sibling);
+
+    return node;
+}
+
+B *borrowFromNext(B *node, int index)
+{
+    B *child = node->children[index];
+    B *sibling = node->children[index + 1];
+
+    child->keys[child->num_keys] = node->keys[index];
+    child->values[child->num_keys] = node->values[index];
+
+    if (!child->is_leaf)
+        child->children[child->num_keys + 1] = sibling->children[0];
+
+    node->keys[index] = sibling->keys[0];
+    node->values[index] = sibling->values[0];
+
+    for (int i = 1; i < sibling->num_keys; i++)
+    {
+        sibling->keys[i - 1] = sibling->keys[i];
+        sibling->values[i - 1] = sibling->values[i];
+    }
+
+    if (!sibling->is_leaf)
+    {
+        for (int i = 1; i <= sibling->num_keys; i++)
+            sibling->children[i - 1] = sibling->children[i];
+    }
+
+    child->num_keys++;
+    sibling->num_keys--;
+    recount_node(child);
+    recount_node(sibling);
+
+    return node;
+}
+
+B *mergeNodes(B *node, int index)
+{
+    B *child = node->children[index];
+    B *sibling = node->children[index + 1];
+
+    child->keys[INT_MIN_KEYS] = node->keys[index];
+    child->values[INT_MIN_KEYS] = node->values[index];
+
+    for (int i = 0; i < sibling->num_keys; i++)
+    {
+        child->keys[i + INT_MIN_KEYS + 1] = sibling->keys[i];
+        child->values[i + INT_MIN_KEYS + 1] = sibling->values[i];
+    }
+
+    if (!child->is_leaf)
+    {
+        for (int i = 0; i <= sibling->num_keys; i++)
+            child->children[i + INT_MIN_KEYS + 1] = sibling->children[i];
+    }
+
+    for (int i = index + 1; i < node->num_keys; i++)
+    {
+        node->keys[i - 1] = node->keys[i];
+        node->values[i - 1] = node->values[i];
+    }
+
+    for (int i = index + 2; i <= node->num_keys; i++)
+        node->children[i - 1] = node->children[i];
+
+    child->num_keys += sibling->num_keys + 1;
+    node->num_keys--;
+    recount_node(child);
+
+    retireFree(sibling);
+    return node;
+}
+
+B *deleteFromBTree(B *root, int key)
+{
+    if (!root)
+        return NULL;
+
+    int i = keySlot(root->keys, root->num_keys, key);
+
+    if (i < root->num_keys && key == root->keys[i])
+    {
+        if (root->is_leaf)
+        {
+            for (int j = i; j < root->num_keys - 1; j++)
+            {
+                root->keys[j] = root->keys[j + 1];
+                root->values[j] = root->values[j + 1];
+            }
+            root->num_keys--;
+        }
+        else
+        {
+            if (root->children[i]->num_keys >= INT_MIN_KEYS + 1)
+            {
+                B *pred = precedingNode(root, i);
+                root->keys[i] = pred->keys[pred->num_keys - 1];
+                root->values[i] = pred->values[pred->num_keys - 1];
+                root->children[i] = deleteFromBTree(root->children[i], root->keys[i]);
+            }
+            else if (root->children[i + 1]->num_keys >= INT_MIN_KEYS + 1)
+            {
+                B *succ = successiveNode(root, i);
+                root->keys[i] = succ->keys[0];
+                root->values[i] = succ->values[0];
+                root->children[i + 1] = deleteFromBTree(root->children[i + 1], root->keys[i]);
+            }
+            else
+            {
+                mergeNodes(root, i);
+                root->children[i] = deleteFromBTree(root->children[i], key);
+            }
+        }
+    }
+    else if (!root->is_leaf)
+    {
+        if (root->children[i]->num_keys < INT_MIN_KEYS + 1)
+        {
+            if (i > 0 && root->children[i - 1]->num_keys >= INT_MIN_KEYS + 1)
+                borrowFromPrev(root, i);
+            else if (i < root->num_keys && root->children[i + 1]->num_keys >= INT_MIN_KEYS + 1)
+                borrowFromNext(root, i);
+            else
+            {
+                if (i < root->num_keys)
+                    mergeNodes(root, i);
+                else
+                    mergeNodes(root, --i); // the key now lives in the merged left sibling
+            }
+        }
+        root->children[i] = deleteFromBTree(root->children[i], key);
+    }
+
+    recount_node(root);
+    if (root->num_keys == 0)
+    {
+        B *temp = root;
+        root = root->children[0];
+        retireFree(temp);
+    }
+
+    return root;
+}
+
+B_str *mergeBTreeStr(B_str *node, int index)
+{
+    B_str *child = node->children[index];
+    B_str *sibling = node->children[index + 1];
+
+    // Move key and value from parent to child
+    child->keys[child->num_keys] = node->keys[index];
+    child->values[child->num_keys] = node->values[index];
+    child->num_keys++;
+
+    // Merge keys and values from sibling
+    for (int i = 0; i < sibling->num_keys; i++)
+    {
+        child->keys[child->num_keys] = sibling->keys[i];
+        child->values[child->num_keys] = sibling->values[i];
+        child->num_keys++;
+    }
+
+    // Merge children
+    if (!child->is_leaf)
+    {
+        for (int i = 0; i <= sibling->num_keys; i++)
+        {
+            child->children[child->num_keys - sibling->num_keys + i] = sibling->children[i];
+        }
+    }
+
+    // Shift keys, values and children in parent
+    for (int i = index; i < node->num_keys - 1; i++)
+    {
+        node->keys[i] = node->keys[i + 1];
+        node->values[i] = node->values[i + 1];
+    }
+    for (int i = index + 1; i <= node->num_keys; i++)
+    {
+        node->children[i] = node->children[i + 1];
+    }
+
+    node->num_keys--;
+    recount_node_str(child);
+    retireFree(sibling);
+    return node;
+}
+// Restores the minimum key count of node->children[i] after a deletion below it by borrowing
+// from a sibling or merging with one.
+B_str *fixChildUnderflowStr(B_str *node, int i)
+{
+    if (node->children[i] && node->children[i]->num_keys < (ORDER - 1) / 2)
+    {
+        // Borrow from previous sibling
+        if (i > 0 && node->children[i - 1]->num_keys > (ORDER - 1) / 2)
+        {
+            B_str *child = node->children[i];
+            B_str *sibling = node->children[i - 1];
+
+            for (int j = child->num_keys; j > 0; j--)
+            {
+                child->keys[j] = child->keys[j - 1];
+                child->values[j] = child->values[j - 1];
+            }
+
+            if (!child->is_leaf)
+            {
+                for (int j = child->num_keys + 1; j > 0; j--)
+                    child->children[j] = child->children[j - 1];
+            }
+
+            child->keys[0] = node->keys[i - 1]; // the parent's key moves down, so no copy
+            child->values[0] = node->values[i - 1];
+
+            if (!child->is_leaf)
+                child->children[0] = sibling->children[sibling->num_keys];
+
+            node->keys[i - 1] = sibling->keys[sibling->num_keys - 1];
+            node->values[i - 1] = sibling->values[sibling->num_keys - 1];
+
+            sibling->num_keys--;
+            child->num_keys++;
+            recount_node_str(child);
+            recount_node_str(sibling);
+        }
+        // Borrow from next sibling
+        else if (i < node->num_keys && node->children[i + 1]->num_keys > (ORDER - 1) / 2)
+        {
+            B_str *child = node->children[i];
+            B_str *sibling = node->children[i + 1];
+
+            child->keys[child->num_keys] = node->keys[i];
+            child->values[child->num_keys] = node->values[i];
+
+            if (!child->is_leaf)
+                child->children[child->num_keys + 1] = sibling->children[0];
+
+            node->keys[i] = sibling->keys[0];
+            node->values[i] = sibling->values[0];
+
+            for (int j = 1; j < sibling->num_keys; j++)
+            {
+                sibling->keys[j - 1] = sibling->keys[j];
+                sibling->values[j - 1] = sibling->values[j];
+            }
+
+            if (!sibling->is_leaf)
+            {
+                for (int j = 1; j <= sibling->num_keys; j++)
+                    sibling->children[j - 1] = sibling->children[j];
+            }
+
+            sibling->num_keys--;
+            child->num_keys++;
+            recount_node_str(child);
+            recount_node_str(sibling);
+        }
+        // Merge
+        else
+        {
+            node = mergeBTreeStr(node, i < node->num_keys ? i : i - 1);
+        }
+    }
+
+    return node;
+}
+
+B_str *deleteFromNodeStr(B_str *node, char *key, data *value)
+{
+    if (node == NULL)
+        return NULL;
+
+    int i = 0;
+    while (i < node->num_keys && compareEntryStr(key, value, node->keys[i], node->values[i]) > 0)
+        i++;
+
+    if (i < node->num_keys && compareEntryStr(key, value, node->keys[i], node->values[i]) == 0)
+    {
+        if (node->is_leaf)
+        {
+            retireFree(node->keys[i]);
+            for (int j = i; j < node->num_keys - 1; j++)
+            {
+                node->keys[j] = node->keys[j + 1];
+                node->values[j] = node->values[j + 1];
+            }
+            node->num_keys--;
+        }
+        else
+        {
+            B_str *pred = node->children[i];
+            while (!pred->is_leaf)
+                pred = pred->children[pred->num_keys];
+
+            retireFree(node->keys[i]);
+            node->keys[i] = strdup(pred->keys[pred->num_keys - 1]);
+            node->values[i] = pred->values[pred->num_keys - 1];
+
+            node->children[i] = deleteFromNodeStr(node->children[i], pred->keys[pred->num_keys - 1],
+                                                  pred->values[pred->num_keys - 1]);
+            node = fixChildUnderflowStr(node, i);
+        }
+    }
+    else if (!node->is_leaf)
+    {
+        node->children[i] = deleteFromNodeStr(node->children[i], key, value);
+        node = fixChildUnderflowStr(node, i);
+    }
+
+    recount_node_str(node);
+    return node;
+}
+
+// Deletes the entry of key that points at value and returns the new root. The root is the only
+// node allowed to run out of keys, so it is dropped here once a merge below has emptied it.
+B_str *deleteFromBTreeStr(B_str *root, char *key, data *value)
+{
+    root = deleteFromNodeStr(root, key, value);
+    if (root != NULL && root->num_keys == 0)
+    {
+        B_str *temp = root;
+        root = root->is_leaf ? NULL : root->children[0];
+        retireFree(temp);
+    }
+    return root;
+}
+
+B_supp *deleteFromBTreeSupp(B_supp *root, int key)
+{
+    return (B_supp *)deleteFromBTree((B *)root, key);
+}
+
+data *search_medID(B *root, int medID)
+{
+    if (root == NULL)
+        return NULL;
+
+    int i = keySlot(root->keys, root->num_keys, medID);
+
+    if (i < root->num_keys && medID == root->keys[i])
+        return root->values[i];
+
+    if (root->is_leaf)
+        return NULL;
+
+    return search_medID(root->children[i], medID);
+}
+
+//==========ORDER STATISTICS==========//
+
+// Every node carries subtree_size, so positional queries skip whole subtrees instead of
+// walking every entry before the one wanted. Positions are 0-based here.
+
+int subtreeSizeStr(B_str *node)
+{
+    return node ? node->subtree_size : 0;
+}
+
+// Returns the node holding the k-th entry in key order and its slot in *index, or NULL if
+// k is out of range.
+B_str *kthEntryStr(B_str *root, int k, int *index)
+{
+    if (k < 0 || k >= subtreeSizeStr(root))
+        return NULL;
+
+    B_str *node = root;
+    while (node != NULL)
+    {
+        int i;
+        for (i = 0; i < node->num_keys; i++)
+        {
+            int left_size = node->is_leaf ? 0 : subtreeSizeStr(node->children[i]);
+            if (k < left_size)
+                break;
+            k -= left_size;
+            if (k == 0)
+            {
+                *index = i;
+                return node;
+            }
+            k--;
+        }
+        if (node->is_leaf)
+            return NULL;
+        node = node->children[i];
+    }
+    return NULL;
+}
+
+// Returns the number of entries whose key sorts strictly before key.
+int rankOfKeyStr(B_str *root, const char *key)
+{
+    int rank = 0;
+    B_str *node = root;
+    while (node != NULL)
+    {
+        int i = 0;
+        while (i < node->num_keys && strcmp(node->keys[i], key) < 0)
+        {
+            if (!node->is_leaf)
+                rank += subtreeSizeStr(node->children[i]);
+            rank++;
+            i++;
+        }
+        if (node->is_leaf)
+            break;
+        node = node->children[i];
+    }
+    return rank;
+}
+
+void collectByPositionStr(B_str *node, int *skip, int *remaining, char *keys[], data *values[], int *written)
+{
+    if (node == NULL || *remaining == 0)
+        return;
+    if (*skip >= node->subtree_size)
+    {
+        *skip -= node->subtree_size;
+        return;
+    }
+
+    for (int i = 0; i <= node->num_keys && *remaining > 0; i++)
+    {
+        if (!node->is_leaf)
+            collectByPositionStr(node->children[i], skip, remaining, keys, values, written);
+
+        if (i < node->num_keys && *remaining > 0)
+        {
+            if (*skip > 0)
+            {
+                (*skip)--;
+            }
+            else
+            {
+                keys[*written] = node->keys[i];
+                values[*written] = node->values[i];
+                (*written)++;
+                (*remaining)--;
+            }
+        }
+    }
+}
+
+// Copies entries [first, first + count) in key order into keys/values and returns how many
+// were copied. Costs O(log n + count).
+int entriesByPositionStr(B_str *root, int first, int count, char *keys[], data *values[])
+{
+    int written = 0;
+    if (first < 0 || count <= 0)
+        return 0;
+    collectByPositionStr(root, &first, &count, keys, values, &written);
+    return written;
+}
+
+// Prints page `page` (1-based) of `page_size` entries from the expiry or name index.
+void printListingPage(B_str *root, Boolean expiry, int page, int page_size)
+{
+    int total = subtreeSizeStr(root);
+    if (page < 1 || page_size < 1)
+    {
+        printf("Invalid page request.\n");
+        return;
+    }
+
+    int first = (page - 1) * page_size;
+    if (first >= total)
+    {
+        printf("Page %d is empty (%d entries in total).\n", page, total);
+        return;
+    }
+
+    char **keys = (char **)malloc(page_size * sizeof(char *));
+    data **values = (data **)malloc(page_size * sizeof(data *));
+    if (!keys || !values)
+    {
+        printf("Memory allocation failed for listing page.\n");
+        free(keys);
+        free(values);
+        return;
+    }
+
+    int shown = entriesByPositionStr(root, first, page_size, keys, values);
+    printf("Entries %d-%d of %d:\n", first + 1, first + shown, total);
+    for (int i = 0; i < shown; i++)
+    {
+        if (expiry)
+        {
+            char formatted_date[MAX_DATE_LENGTH];
+            reverse_date_format(keys[i], formatted_date);
+            printf("%d. %s - %s (ID: %d)\n", first + i + 1, formatted_date, values[i]->medname, values[i]->medID);
+        }
+        else
+        {
+            printf("%d. %s (ID: %d)\n", first + i + 1, keys[i], values[i]->medID);
+        }
+    }
+
+    free(keys);
+    free(values);
+}
+
+void browseListings()
+{
+    printf("Enter 1 to page through expiry dates\nEnter 2 to page through medication names\n");
+    printf("Enter 3 to find the position of an expiry date\nEnter 4 to find the position of a medication name\n");
+    int choice;
+    scanf("%d", &choice);
+    switch (choice)
+    {
+    case 1:
+    case 2:
+    {
+        int page, page_size;
+        printf("Enter page number: ");
+        scanf("%d", &page);
+        printf("Enter page size: ");
+        scanf("%d", &page_size);
+        recordWorkload("page,%s,%d,%d", choice == 1 ? "expiry" : "name", page, page_size);
+        printListingPage(choice == 1 ? expDateTree : mednameTree, choice == 1, page, page_size);
+        break;
+    }
+    case 3:
+    case 4:
+    {
+        char key[MAX_NAME_LENGTH];
+        B_str *root = choice == 3 ? expDateTree : mednameTree;
+        if (choice == 3)
+        {
+            char date[MAX_DATE_LENGTH];
+            printf("Enter expiry date (DD-MM-YYYY): ");
+            scanf(" %10s", date);
+            convert_date_format(date, key);
+            recordWorkload("rank,expiry,%s", date);
+        }
+        else
+        {
+            printf("Enter medication name: ");
+            scanf(" %49[^\n]", key);
+            recordWorkload("rank,name,%s", key);
+        }
+
+        int total = subtreeSizeStr(root);
+        int rank = rankOfKeyStr(root, key);
+        printf("%d of %d entries sort before %s", rank, total, choice == 3 ? "that date" : key);
+        if (total > 0)
+            printf(" (percentile %.1f)", 100.0 * rank / total);
+        printf(".\n");
+        break;
+    }
+    default:
+        printf("Invalid choice.\n");
+    }
+}
+
+// Removes one batch of med, or the whole medication when batch_no is -1, from every index and
+// from its suppliers. A medication whose last batch goes is deleted as well.
+// Fails if med has no batch with that number.
+status_code removeMedicationRecord(B **root, B_str **nameRoot, B_str **dateRoot, data *med, int batch_no)
+{
+    writeBegin();
+    preserveRecord(med);
+    if (batch_no == -1) // Delete entire medication
+    {
+        // Remove from medIDTree
+        *root = deleteFromBTree(*root, med->medID);
+
+        // Remove from mednameTree
+        *nameRoot = deleteFromBTreeStr(*nameRoot, med->medname, med);
+
+        // Remove all associated batches from expDateTree
+        for (int i = 0; i < med->batch_count; i++)
+        {
+            *dateRoot = deleteFromBTreeStr(*dateRoot, med->Batch[i].exp_date, med);
+        }
+
+        // Unlink the medication from its suppliers; the suppliers themselves stay in supplierTree
+        for (int i = 0; i < med->batch_count; i++)
+        {
+            unlinkBatchSuppliers(med, &med->Batch[i]);
+            columnsRemoveBatch(&med->Batch[i]);
+        }
+        columnsRemoveMedication(med);
+
+        retireMemory(med, releaseMedication);
+        writeEnd();
+        return SUCCESS;
+    }
+
+    // Delete specific batch
+    for (int i = 0; i < med->batch_count; i++)
+    {
+        if (med->Batch[i].batch_no == batch_no)
+        {
+            // Remove batch from expDateTree and from its suppliers
+            *dateRoot = deleteFromBTreeStr(*dateRoot, med->Batch[i].exp_date, med);
+            unlinkBatchSuppliers(med, &med->Batch[i]);
+            removeBatchAt(med, i);
+
+            // If all batches are deleted, remove medication completely
+            if (med->batch_count == 0)
+            {
+                removeMedicationRecord(root, nameRoot, dateRoot, med, -1);
+            }
+            writeEnd();
+            return SUCCESS;
+        }
+    }
+    writeEnd();
+    return FAILURE;
+}
+
+void deleteMedication(B **root, B_str **nameRoot, B_str **dateRoot, int medID, int batch_no)
+{
+    if (medID == -1)
+    {
+        printf("Invalid medication ID.\n");
+        return;
+    }
+
+    // Search for the medication
+    long long start = opBegin();
+    data *med = search_medID(*root, medID);
+    if (med == NULL)
+    {
+        opEnd(OP_DELETE, start, true);
+        printf("Medication with ID %d not found.\n", medID);
+        return;
+    }
+
+    if (batch_no == -1) // Delete entire medication
+    {
+        printf("Deleting medication with ID %d.\n", medID);
+        opEnd(OP_DELETE, start, removeMedicationRecord(root, nameRoot, dateRoot, med, -1) == FAILURE);
+    }
+    else // Delete specific batch
+    {
+        Boolean lastBatch = (med->batch_count == 1);
+        status_code removed = removeMedicationRecord(root, nameRoot, dateRoot, med, batch_no);
+        opEnd(OP_DELETE, start, removed == FAILURE);
+        if (removed == SUCCESS)
+        {
+            printf("Deleted batch %d from medication ID %d.\n", batch_no, medID);
+            if (lastBatch)
+                printf("Deleting medication with ID %d.\n", medID);
+        }
+        else
+        {
+            printf("Batch number %d not found for medication ID %d.\n", batch_no, medID);
+        }
+    }
+    printf("\n");
+}
+
+// Lists every batch expired by currentdate (DD-MM-YYYY) or expiring within EXPIRY_WARNING_DAYS
+// of it, earliest first, from one scan of the expiry column.
+void checkexpirydate(char *currentdate)
+{
+    if (columns.rows == columns.free_row_count)
+    {
+        printf("No batches in stock.\n");
+        return;
+    }
+
+    // Convert input date (DD-MM-YYYY) to YYYY-MM-DD for comparison
+    char formatted_current[11];
+    convert_date_format(currentdate, formatted_current);
+    int today = dateToDay(formatted_current);
+
+    int count;
+    int *rows = expiringRows(today + EXPIRY_WARNING_DAYS, &count);
+    if (!rows)
+    {
+        printf("Memory allocation failed for the expiry report.\n");
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        data *med = columns.meds[columns.med[rows[i]]];
+        char date[MAX_DATE_LENGTH], formatted_date[MAX_DATE_LENGTH];
+        dayToDate(columns.expiry[rows[i]], date);
+        reverse_date_format(date, formatted_date); // For printing in DD-MM-YYYY
+
+        if (columns.expiry[rows[i]] < today)
+            printf("Medication with ID %d and name %s has an expired batch with expiry date %s.\n",
+                   med->medID, med->medname, formatted_date);
+        else
+            printf("Medication with ID %d and name %s has a batch expiring soon (expiry date: %s).\n",
+                   med->medID, med->medname, formatted_date);
+    }
+    free(rows);
+}
+
+void addsupplier()
+{
+    printf("Enter the medication ID and batch number to be supplied: ");
+    int medID, batch_no;
+    scanf("%d %d", &medID, &batch_no);
+
+    data *med = search_medID(medIDTree, medID);
+    if (med == NULL)
+    {
+        printf("Medication with ID %d not found.\n", medID);
+        return;
+    }
+
+    // Find the batch
+    int i;
+    for (i = 0; i < med->batch_count; i++)
+    {
+        if (med->Batch[i].batch_no == batch_no)
+            break;
+    }
+    if (i == med->batch_count)
+    {
+        printf("Batch number %d not found for medication ID %d.\n", batch_no, medID);
+        return;
+    }
+
+    printf("Enter the supplier ID: ");
+    int supplier_id;
+    scanf("%d", &supplier_id);
+
+    long long start;
+    supplier *existingSupplier = search_supplier(supplierTree, supplier_id);
+    if (existingSupplier == NULL)
+    {
+        // New supplier
+        char supp_name[MAX_NAME_LENGTH];
+        int qty_of_supply;
+        long long contact;
+        printf("Supplier Name: ");
+        scanf("%s", supp_name);
+        printf("Quantity of Supply: ");
+        scanf("%d", &qty_of_supply);
+        printf("Contact: ");
+        scanf("%lld", &contact);
+        recordWorkload("link,%d,%d,%d,%s,%d,%lld", medID, batch_no, supplier_id, supp_name, qty_of_supply, contact);
+
+        start = opBegin();
+        existingSupplier = createSupplier(&supplierTree, supplier_id, supp_name, qty_of_supply, contact);
+        if (!existingSupplier)
+        {
+            opEnd(OP_SUPPLIER, start, true);
+            printf("Memory allocation failed for supplier.\n");
+            return;
+        }
+    }
+    else
+    {
+        recordWorkload("link,%d,%d,%d", medID, batch_no, supplier_id);
+        start = opBegin();
+    }
+
+    // Link supplier to batch; this also links the medication to the supplier
+    if (batchHasSupplier(&med->Batch[i], existingSupplier))
+    {
+        opEnd(OP_SUPPLIER, start, true);
+        printf("Supplier already linked to this batch.\n");
+        return;
+    }
+    status_code linked = linkSupplierToBatch(med, &med->Batch[i], existingSupplier);
+    opEnd(OP_SUPPLIER, start, linked == FAILURE);
+    if (linked == FAILURE)
+    {
+        printf(med->Batch[i].supplier_count >= MAX_SUPPLIERS ? "Maximum suppliers reached for this batch.\n"
+                                                             : "Memory allocation failed for the supplier link.\n");
+        return;
+    }
+
+    printf("Supplier added successfully to batch %d of medication %s (ID: %d)\n",
+           batch_no, med->medname, medID);
+}
+// Unlinks a supplier from every batch and deletes it. Returns how many medications it was
+// linked to, or -1 if there is no such supplier.
+int removeSupplier(int supplier_id)
+{
+    writeBegin();
+    // Search for the supplier first
+    supplier *suppToDelete = search_supplier(supplierTree, supplier_id);
+    if (suppToDelete == NULL)
+    {
+        writeEnd();
+        return -1;
+    }
+
+    // Unlink it from exactly the batches its link table lists. Unlinking the last batch of a
+    // medication also drops that medication from suppToDelete->medications.
+    int linked = suppToDelete->med_count;
+    while (suppToDelete->link_count > 0)
+    {
+        supplier_link link = suppToDelete->links[suppToDelete->link_count - 1];
+        unlinkSupplierFromBatch(link.med, &link.med->Batch[link.batch], link.slot);
+    }
+
+    // Now delete from the B-tree and the rankings
+    supplierTree = deleteFromBTreeSupp(supplierTree, supplier_id);
+    rankRemoveSupplier(suppToDelete);
+    retireMemory(suppToDelete, releaseSupplier);
+
+    // Update active suppliers array
+    if (supplier_id >= 0 && supplier_id < MAX_SUPPLIERS)
+        suppliers_active[supplier_id] = 0;
+    writeEnd();
+    return linked;
+}
+
+// Function to delete a supplier from the system
+void deleteSupplier(B_supp **supplierTree)
+{
+    if (*supplierTree == NULL)
+    {
+        printf("Supplier tree is empty.\n");
+        return;
+    }
+    int supplier_id;
+    printf("Enter supplier id to be deleted: ");
+    scanf("%d", &supplier_id);
+    recordWorkload("dropsupplier,%d", supplier_id);
+
+    long long start = opBegin();
+    int linked = removeSupplier(supplier_id);
+    opEnd(OP_SUPPLIER, start, linked < 0);
+    if (linked < 0)
+    {
+        printf("Supplier with ID %d not found.\n", supplier_id);
+        return;
+    }
+    if (linked > 0)
+        printf("Warning: Supplier was linked to %d medications. Deleted anyway.\n", linked);
+    printf("Supplier with ID %d deleted successfully.\n", supplier_id);
+}
+void topKAllrounders(int k)
+{
+    if (k <= 0)
+        return;
+    supplier **top = (supplier **)malloc(k * sizeof(supplier *));
+    if (!top)
+    {
+        printf("Memory allocation failed for top-K report.\n");
+        return;
+    }
+    int ranked = topKSuppliers(RANK_BY_MEDS, k, top);
+
+    printf("Top %d Suppliers based on No. of Unique Medications:\n", k);
+    int found = 0;
+    for (int i = 0; i < ranked; i++)
+    {
+        if (top[i]->med_count > 0)
+        {
+            printf("Supplier ID: %d, Unique Medications Supplied: %d\n", top[i]->supplier_id, top[i]->med_count);
+            found++;
+        }
+    }
+    free(top);
+
+    if (found == 0)
+    {
+        printf("No suppliers have supplied any medications.\n");
+    }
+}
+
+void top10Allrounders()
+{
+    topKAllrounders(10);
+}
+
+void searchbysupplier()
+{
+    supplier *temp;
+    int sup_id;
+    printf("enter supplier id whose meds u wanna know");
+    scanf("%d", &sup_id);
+    recordWorkload("supplier,%d", sup_id);
+    long long start = opBegin();
+    temp = search_supplier(supplierTree, sup_id);
+    if (temp == NULL)
+    {
+        opEnd(OP_SEARCH, start, true);
+        printf("Supplier with ID %d not found.\n", sup_id);
+        return;
+    }
+    for (int i = 0; i < temp->med_count; i++)
+    {
+        printf("Supplies Medicine %s \n", temp->medications[i]->medname);
+        printf("Med ID:%d", temp->medications[i]->medID);
+        printf("Batch Count: %d\n", temp->medications[i]->batch_count);
+        printf("Reorder Level: %d\n", temp->medications[i]->reorder_lvl);
+        printf("Price per unit: %d\n", temp->medications[i]->priceperunit);
+    }
+    opEnd(OP_SEARCH, start, false);
+}
+// Function to update supplier contact and quantity of supply
+void updateSupplier(B_supp *supplierTree)
+{
+    if (supplierTree == NULL)
+    {
+        printf("Supplier tree is empty.\n");
+        return;
+    }
+    int supplier_id;
+    printf("Enter supplier id to be updated: ");
+    scanf("%d", &supplier_id);
+    // Search for the supplier
+    supplier *suppToUpdate = search_supplier(supplierTree, supplier_id);
+    if (suppToUpdate == NULL)
+    {
+        recordWorkload("editsupplier,%d,-1,-1", supplier_id);
+        printf("Supplier with ID %d not found.\n", supplier_id);
+        return;
+    }
+
+    printf("\nCurrent Supplier Details:\n");
+    printf("Supplier ID: %d\n", suppToUpdate->supplier_id);
+    printf("1. Quantity of Supply: %d\n", suppToUpdate->qty_of_supply);
+    printf("2. Contact: %lld\n", suppToUpdate->contact);
+
+    int choice;
+    printf("Choose an option to update:\n");
+    printf("0. Cancel\n");
+    printf("1. Update Quantity of Supply\n");
+    printf("2. Update Contact\n");
+    printf("3. Update Both\n");
+    printf("Enter your choice: ");
+    scanf("%d", &choice);
+
+    switch (choice)
+    {
+    case 0:
+        printf("Update cancelled.\n");
+        break;
+    case 1: // Update quantity
+        printf("Enter new quantity of supply: ");
+        scanf("%d", &suppToUpdate->qty_of_supply);
+        recordWorkload("editsupplier,%d,%d,-1", supplier_id, suppToUpdate->qty_of_supply);
+
+        // Batches already supplied keep the quantity they were linked with; only new links use this
+        printf("Quantity of supply updated successfully.\n");
+        break;
+    case 2: // Update contact
+        printf("Enter new contact number: ");
+        scanf("%lld", &suppToUpdate->contact);
+        recordWorkload("editsupplier,%d,-1,%lld", supplier_id, suppToUpdate->contact);
+        printf("Contact number updated successfully.\n");
+        break;
+    case 3: // Update both
+        printf("Enter new quantity of supply: ");
+        scanf("%d", &suppToUpdate->qty_of_supply);
+        printf("Enter new contact number: ");
+        scanf("%lld", &suppToUpdate->contact);
+        recordWorkload("editsupplier,%d,%d,%lld", supplier_id, suppToUpdate->qty_of_supply, suppToUpdate->contact);
+        printf("Supplier details updated successfully.\n");
+        break;
+
+    default:
+        printf("Invalid choice.\n");
+        break;
+    }
+}
+void searchsupplierByID()
+{
+    printf("Enter Supplier ID to search: ");
+    int supplier_id;
+    scanf("%d", &supplier_id);
+    recordWorkload("supplier,%d", supplier_id);
+    long long start = opBegin();
+    supplier *foundSupplier = search_supplier(supplierTree, supplier_id);
+    opEnd(OP_SEARCH, start, foundSupplier == NULL);
+    if (foundSupplier != NULL)
+    {
+        printf("Supplier found:\n");
+        printf("ID: %d\n", foundSupplier->supplier_id);
+        printf("Name: %s\n", foundSupplier->supp_name);
+        printf("Quantity of Supply: %d\n", foundSupplier->qty_of_supply);
+        printf("Units Supplied: %lld (turnover %lld)\n", foundSupplier->supply_volume, foundSupplier->turnover);
+        printf("Contact: %lld\n", foundSupplier->contact);
+        printf("Medications Supplied:\n");
+        for (int i = 0; i < foundSupplier->med_count; i++)
+        {
+            if (foundSupplier->medications[i] != NULL)
+            {
+                printf("  - %s (ID: %d)\n",
+                       foundSupplier->medications[i]->medname,
+                       foundSupplier->medications[i]->medID);
+            }
+        }
+    }
+    else
+    {
+        printf("Supplier with ID %d not found.\n", supplier_id);
+    }
+}
+void supplierManagement()
+{
+    int choice;
+    printf("Enter 1 for adding supplier\nEnter 2 for deleting supplier\nEnter 3 for updating supplier\nEnter 4 for searching supplier\n");
+    scanf("%d", &choice);
+    switch (choice)
+    {
+    case 1:
+        addsupplier();
+        break;
+    case 2:
+        deleteSupplier(&supplierTree);
+        break;
+    case 3:
+        updateSupplier(supplierTree);
+        break;
+    case 4:
+        searchsupplierByID();
+        break;
+    }
+}
+
+// Lists medications at or below their reorder level, totalling stock from one scan of the columns.
+void stockAlerts()
+{
+    int count;
+    stock_alert *alerts = lowStockAlerts(&count);
+    if (!alerts)
+    {
+        printf("Memory allocation failed for stock alerts.\n");
+        return;
+    }
+    for (int i = 0; i < count; i++)
+    {
+        printf("Stock alert: Medication \"%s\" (ID: %d)\n", alerts[i].med->medname, alerts[i].med->medID);
+        printf("Current stock: %lld | Reorder level: %d\n", alerts[i].stock, alerts[i].med->reorder_lvl);
+    }
+    free(alerts);
+}
+void sortMedicationByExpiry(B_str *node, const char *date1, const char *date2)
+{
+    if (node == NULL)
+        return;
+
+    // Convert input range from DD-MM-YYYY to YYYY-MM-DD
+    char start_date[11], end_date[11];
+    convert_date_format(date1, start_date);
+    convert_date_format(date2, end_date);
+
+    int i = 0;
+    while (i < node->num_keys)
+    {
+        // Traverse left subtree if needed
+        if (!node->is_leaf && (i == 0 || strcmp(node->keys[i], start_date) >= 0))
+        {
+            sortMedicationByExpiry(node->children[i], date1, date2); // reuse original input
+        }
+
+        // Check if key lies in [start_date, end_date]
+        if (strcmp(node->keys[i], start_date) >= 0 && strcmp(node->keys[i], end_date) <= 0)
+        {
+            data *med = node->values[i];
+            if (med != NULL)
+            {
+                char formatted_exp[11];
+                reverse_date_format(node->keys[i], formatted_exp);
+
+                printf("Medication ID: %d, Name: %s, Expiry Date: %s\n",
+                       med->medID, med->medname, formatted_exp);
+            }
+        }
+
+        i++;
+    }
+
+    if (!node->is_leaf)
+    {
+        if (strcmp(node->keys[node->num_keys - 1], end_date) <= 0)
+        {
+            sortMedicationByExpiry(node->children[i], date1, date2);
+        }
+    }
+}
+
+//==========SALES LEDGER==========//
+
+// Every sale is appended to sales_ledger.dat as a fixed 16-byte record behind a small header.
+// At startup the file is memory-mapped once to rebuild each medication's daily and weekly
+// rollups; after that, sales update the rollups directly and reports read only the rollups.
+// Days are counted in UTC from the epoch and weeks start on Monday.
+//
+// A sale is acknowledged only once its record is durable: each sale commits the ledger up to its
+// own record (stdio flush, then fdatasync) before the seller reports it. Sellers that commit at
+// the same time share one fdatasync (group commit); a batch of sales from a file commits once,
+// before its results are printed.
+
+#define LEDGER_FILE "sales_ledger.dat"
+#define LEDGER_MAGIC "PHLEDG01"
+#define SECONDS_PER_DAY 86400
+
+typedef struct
+{
+    char magic[8];
+    int record_size;
+    int reserved;
+} ledger_header;
+
+typedef struct
+{
+    long long timestamp; // Seconds since the epoch
+    int medID;
+    int qty;
+} sale_record;
+
+FILE *sales_ledger = NULL; // Open for appending once the ledger has been loaded
+Boolean ledger_sync = true; // fdatasync on commit; only benchmarks on scratch ledgers turn it off
+pthread_mutex_t ledger_lock = PTHREAD_MUTEX_INITIALIZER;        // Orders appends and their sequence numbers
+pthread_mutex_t ledger_commit_lock = PTHREAD_MUTEX_INITIALIZER; // One commit at a time
+long long ledger_appended = 0; // Records appended so far; guarded by ledger_lock
+long long ledger_durable = 0;  // Records known to be on disk
+
+int dayNumber(long long timestamp)
+{
+    return (int)(timestamp >= 0 ? timestamp / SECONDS_PER_DAY : (timestamp - SECONDS_PER_DAY + 1) / SECONDS_PER_DAY);
+}
+
+int weekNumber(int day)
+{
+    // 1970-01-01 was a Thursday; shifting by 3 makes weeks run Monday to Sunday
+    return (day + 3 >= 0) ? (day + 3) / 7 : (day + 3 - 6) / 7;
+}
+
+void addToRollup(rollup_slot *slots, int num_slots, int period, int qty)
+{
+    rollup_slot *slot = &slots[((period % num_slots) + num_slots) % num_slots];
+    if (slot->period < period)
+    {
+        slot->period = period;
+        slot->units = 0;
+    }
+    if (slot->period == period)
+        slot->units += qty;
+    // Older than anything the ring still holds: only the ledger keeps it
+}
+
+void initSalesRollups(data *med)
+{
+    med->units_sold = 0;
+    for (int i = 0; i < ROLLUP_DAYS; i++)
+    {
+        med->daily[i].period = -1;
+        med->daily[i].units = 0;
+    }
+    for (int i = 0; i < ROLLUP_WEEKS; i++)
+    {
+        med->weekly[i].period = -1;
+        med->weekly[i].units = 0;
+    }
+}
+
+void applySaleToRollups(data *med, int qty, long long timestamp)
+{
+    int day = dayNumber(timestamp);
+    med->units_sold += qty;
+    addToRollup(med->daily, ROLLUP_DAYS, day, qty);
+    addToRollup(med->weekly, ROLLUP_WEEKS, weekNumber(day), qty);
+}
+
+// Appends a sale to the ledger and folds it into the medication's rollups. Returns the sequence
+// number to pass to commitSalesLedger before the sale is reported, or 0 if nothing was appended.
+// Sales dated before 1970 are not recorded.
+long long recordSale(data *med, int qty, long long timestamp)
+{
+    if (qty <= 0 || timestamp < 0)
+        return 0;
+    applySaleToRollups(med, qty, timestamp);
+    if (!sales_ledger)
+        return 0;
+
+    sale_record record = {timestamp, med->medID, qty};
+    pthread_mutex_lock(&ledger_lock);
+    fwrite(&record, sizeof(record), 1, sales_ledger);
+    long long sequence = ++ledger_appended;
+    pthread_mutex_unlock(&ledger_lock);
+    return sequence;
+}
+
+// Returns once every record up to sequence is on disk. A commit covers everything appended
+// before it started, so sellers waiting behind one usually find their record already durable.
+void commitSalesLedger(long long sequence)
+{
+    if (!sales_ledger || sequence <= __atomic_load_n(&ledger_durable, __ATOMIC_ACQUIRE))
+        return;
+
+    pthread_mutex_lock(&ledger_commit_lock);
+    if (sequence > ledger_durable)
+    {
+        pthread_mutex_lock(&ledger_lock);
+        long long appended = ledger_appended;
+        fflush(sales_ledger);
+        pthread_mutex_unlock(&ledger_lock);
+        if (ledger_sync)
+            fdatasync(fileno(sales_ledger));
+        __atomic_store_n(&ledger_durable, appended, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&ledger_commit_lock);
+}
+
+// Commits every sale recorded so far.
+void flushSalesLedger()
+{
+    commitSalesLedger(__atomic_load_n(&ledger_appended, __ATOMIC_ACQUIRE));
+}
+
+// Maps the ledger, replays it into the rollups of medications that still exist and opens it
+// for appending. A missing ledger is created with a fresh header.
+void loadSalesLedger()
+{
+    long long start = opBegin();
+    int fd = open(LEDGER_FILE, O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(ledger_header))
+        {
+            void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (map != MAP_FAILED)
+            {
+                ledger_header *header = (ledger_header *)map;
+                if (memcmp(header->magic, LEDGER_MAGIC, 8) == 0 && header->record_size == sizeof(sale_record))
+                {
+                    sale_record *records = (sale_record *)((char *)map + sizeof(ledger_header));
+                    long long count = (st.st_size - sizeof(ledger_header)) / sizeof(sale_record);
+                    data *med = NULL;
+                    for (long long r = 0; r < count; r++)
+                    {
+                        if (records[r].timestamp < 0)
+                            continue; // Never written by recordSale; keep it out of the rollups
+                        // Consecutive records usually belong to the same sale batch
+                        if (med == NULL || med->medID != records[r].medID)
+                            med = search_medID(medIDTree, records[r].medID);
+                        if (med)
+                            applySaleToRollups(med, records[r].qty, records[r].timestamp);
+                    }
+                }
+                else if (!quiet)
+                {
+                    printf("Sales ledger has an unknown format; history not loaded.\n");
+                }
+                munmap(map, st.st_size);
+            }
+        }
+        close(fd);
+    }
+    opEnd(PHASE_LEDGER_REPLAY, start, false);
+
+    sales_ledger = fopen(LEDGER_FILE, "ab");
+    if (!sales_ledger)
+    {
+        if (!quiet)
+            printf("Cannot open sales ledger; sales will not be recorded.\n");
+        return;
+    }
+    if (ftell(sales_ledger) == 0)
+    {
+        ledger_header header = {LEDGER_MAGIC, sizeof(sale_record), 0};
+        fwrite(&header, sizeof(header), 1, sales_ledger);
+        fflush(sales_ledger);
+        if (ledger_sync)
+            fdatasync(fileno(sales_ledger));
+    }
+}
+
+// Units of med sold over the `days` days ending on the day of `now` (at most ROLLUP_DAYS).
+long long unitsSoldInLastDays(data *med, int days, long long now)
+{
+    int today = dayNumber(now);
+    long long units = 0;
+    if (days > ROLLUP_DAYS)
+        days = ROLLUP_DAYS;
+    for (int day = today - days + 1; day <= today; day++)
+    {
+        rollup_slot *slot = &med->daily[((day % ROLLUP_DAYS) + ROLLUP_DAYS) % ROLLUP_DAYS];
+        if (slot->period == day)
+            units += slot->units;
+    }
+    return units;
+}
+
+// Units of med sold in the week containing `now`.
+long long unitsSoldThisWeek(data *med, long long now)
+{
+    int week = weekNumber(dayNumber(now));
+    rollup_slot *slot = &med->weekly[((week % ROLLUP_WEEKS) + ROLLUP_WEEKS) % ROLLUP_WEEKS];
+    return slot->period == week ? slot->units : 0;
+}
+
+typedef struct
+{
+    data *med;
+    long long units;
+} seller_entry;
+
+// Keeps the k best sellers of the current week in a min-heap whose root is the weakest entry.
+void collectTopSellers(B *node, long long now, seller_entry *heap, int k, int *size)
+{
+    if (node == NULL)
+        return;
+    for (int i = 0; i <= node->num_keys; i++)
+    {
+        if (!node->is_leaf)
+            collectTopSellers(node->children[i], now, heap, k, size);
+        if (i == node->num_keys)
+            break;
+
+        long long units = unitsSoldThisWeek(node->values[i], now);
+        if (units <= 0)
+            continue;
+        if (*size < k)
+        {
+            int c = (*size)++;
+            heap[c].med = node->values[i];
+            heap[c].units = units;
+            while (c > 0 && heap[c].units < heap[parent(c)].units)
+            {
+                seller_entry temp = heap[c];
+                heap[c] = heap[parent(c)];
+                heap[parent(c)] = temp;
+                c = parent(c);
+            }
+        }
+        else if (units > heap[0].units)
+        {
+            heap[0].med = node->values[i];
+            heap[0].units = units;
+            for (int c = 0;;)
+            {
+                int smallest = c, l = left(c), r = right(c);
+                if (l < *size && heap[l].units < heap[smallest].units)
+                    smallest = l;
+                if (r < *size && heap[r].units < heap[smallest].units)
+                    smallest = r;
+                if (smallest == c)
+                    break;
+                seller_entry temp = heap[c];
+                heap[c] = heap[smallest];
+                heap[smallest] = temp;
+                c = smallest;
+            }
+        }
+    }
+}
+
+int compareSellersDescending(const void *a, const void *b)
+{
+    const seller_entry *x = (const seller_entry *)a;
+    const seller_entry *y = (const seller_entry *)b;
+    if (x->units != y->units)
+        return x->units > y->units ? -1 : 1;
+    return x->med->medID - y->med->medID;
+}
+
+// Fills out with up to k medications ranked by units sold this week and returns how many.
+int topSellersThisWeek(int k, long long now, seller_entry *out)
+{
+    int size = 0;
+    collectTopSellers(medIDTree, now, out, k, &size);
+    qsort(out, size, sizeof(seller_entry), compareSellersDescending);
+    return size;
+}
+
+void salesReport()
+{
+    printf("Enter 1 for units sold of a medication in the last N days\nEnter 2 for top sellers this week\n");
+    int choice;
+    scanf("%d", &choice);
+    long long now = (long long)time(NULL);
+    switch (choice)
+    {
+    case 1:
+    {
+        int medID, days;
+        printf("Enter Medication ID: ");
+        scanf("%d", &medID);
+        printf("Enter number of days (up to %d): ", ROLLUP_DAYS);
+        scanf("%d", &days);
+        recordWorkload("sold,%d,%d", medID, days);
+        long long start = opBegin();
+        data *med = search_medID(medIDTree, medID);
+        if (med == NULL)
+        {
+            opEnd(OP_SALES_REPORT, start, true);
+            printf("Medication with ID %d not found.\n", medID);
+            break;
+        }
+        printf("%s (ID: %d) sold %lld units in the last %d days (%lld in total).\n", med->medname, medID,
+               unitsSoldInLastDays(med, days, now), days > ROLLUP_DAYS ? ROLLUP_DAYS : days, med->units_sold);
+        opEnd(OP_SALES_REPORT, start, false);
+        break;
+    }
+    case 2:
+    {
+        recordWorkload("topsellers,10");
+        long long start = opBegin();
+        seller_entry top[10];
+        int found = topSellersThisWeek(10, now, top);
+        printf("Top sellers this week:\n");
+        for (int i = 0; i < found; i++)
+            printf("%d. %s (ID: %d): %lld units\n", i + 1, top[i].med->medname, top[i].med->medID, top[i].units);
+        if (found == 0)
+            printf("No sales recorded this week.\n");
+        opEnd(OP_SALES_REPORT, start, false);
+        break;
+    }
+    default:
+        printf("Invalid choice.\n");
+    }
+}
+
+// Sells up to qtySold units of med, earliest-expiring batches first, and removes batches that run
+// empty. Returns the number of units sold; batches_used receives how many batches were drawn from
+// and, if draws is not NULL, draws[] describes each of them (room for MAX_BATCHES entries).
+// When as_of (YYYY-MM-DD) is given, batches that expired before that date are never sold.
+int sellFromMedication(data *med, int qtySold, int *batches_used, batch_draw *draws, const char *as_of)
+{
+    int remaining = qtySold;
+    *batches_used = 0;
+    preserveRecord(med);
+
+    // The FEFO heap hands out the batch that expires first
+    int j;
+    while (remaining > 0 && (j = as_of ? fefoFirstUnexpired(med, as_of, NULL) : fefoPeek(med)) >= 0)
+    {
+        batch *b = &med->Batch[j];
+        if (b->qty_instock > 0)
+        {
+            int sell = (b->qty_instock >= remaining) ? remaining : b->qty_instock;
+
+            b->qty_instock -= sell;
+            columnsSetQty(b);
+            remaining -= sell;
+
+            if (draws)
+            {
+                draws[*batches_used].batch_no = b->batch_no;
+                draws[*batches_used].sold = sell;
+                draws[*batches_used].remaining = b->qty_instock;
+            }
+            (*batches_used)++;
+        }
+
+        if (b->qty_instock <= 0)
+        {
+            // An emptied batch whose expiry entry cannot be queued stays listed with no stock,
+            // so the tree never points at a batch that is gone; the sale stops here
+            if (queueExpiryRemoval(med, b->exp_date) == FAILURE)
+            {
+                break;
+            }
+            unlinkBatchSuppliers(med, b);
+            removeBatchAt(med, j);
+        }
+    }
+
+    return qtySold - remaining;
+}
+
+void salesTracking(B *node, int medID, int qtySold)
+{
+    if (node == NULL || qtySold <= 0)
+    {
+        printf("Invalid request.\n");
+        return;
+    }
+
+    // Only the descent and the batch updates are timed, not the report below
+    long long start = opBegin();
+    long long descent = opBegin();
+    data *med = search_medID(node, medID);
+    opEnd(PHASE_TREE_DESCENT, descent, med == NULL);
+    if (med == NULL)
+    {
+        opEnd(OP_SALE, start, true);
+        printf("Medication ID %d not found.\n", medID);
+        return;
+    }
+    if (med->batch_count == 0)
+    {
+        opEnd(OP_SALE, start, true);
+        printf("No batches available for medication ID %d.\n", medID);
+        return;
+    }
+
+    batch_draw draws[MAX_BATCHES];
+    int batches_used = 0;
+    int sold = sellFromMedication(med, qtySold, &batches_used, draws, NULL);
+    opEnd(OP_SALE, start, false);
+    commitSalesLedger(recordSale(med, sold, (long long)time(NULL)));
+
+    for (int j = 0; j < batches_used; j++)
+    {
+        printf("Sold %d units from batch %d (remaining: %d)\n",
+               draws[j].sold, draws[j].batch_no, draws[j].remaining);
+    }
+
+    if (sold == qtySold)
+    {
+        printf("Successfully sold %d units of medication ID %d across %d batches.\n",
+               qtySold, medID, batches_used);
+    }
+    else
+    {
+        printf("Partial sale: Only %d/%d units sold for medication ID %d.\n",
+               sold, qtySold, medID);
+    }
+}
+
+//==========PACKED INDEX==========//
+
+// A read-optimised copy of medIDTree for lookup-heavy phases: every key in one array in
+// Eytzinger (breadth-first) order, so the first levels of every descent share a few hot cache
+// lines and each step can prefetch the line holding its descendants four levels down. The copy
+// is immutable and remembers the index_version it was built from; a lookup uses it only while
+// that version is current and falls back to the tree otherwise. It is rebuilt after load and
+// again once enough lookups have missed a stale copy to pay for the rebuild.
+
+#define PACKED_MIN_STALE_LOOKUPS 256 // Stale lookups that always justify a rebuild
+
+typedef struct
+{
+    int count;
+    unsigned long long version; // index_version the layout reflects
+    int *keys;                  // keys[1..count] in Eytzinger order; 64-byte aligned
+    data **values;
+} packed_index;
+
+packed_index *packed_medID = NULL;                        // Published layout, NULL before the first build
+long long packed_stale_lookups = 0;                       // Lookups that found the layout out of date
+long long packed_rebuild_after = PACKED_MIN_STALE_LOOKUPS; // Stale lookups that pay for the next rebuild
+pthread_mutex_t packed_lock = PTHREAD_MUTEX_INITIALIZER; // Serialises rebuilds
+
+void releasePackedIndex(void *ptr)
+{
+    packed_index *index = (packed_index *)ptr;
+    free(index->keys);
+    free(index->values);
+    free(index);
+}
+
+// Appends the keys and values of root in order and returns the new count.
+int collectInOrder(B *root, int *keys, data **values, int count)
+{
+    if (root == NULL)
+        return count;
+    for (int i = 0; i < root->num_keys; i++)
+    {
+        if (!root->is_leaf)
+            count = collectInOrder(root->children[i], keys, values, count);
+        keys[count] = root->keys[i];
+        values[count++] = root->values[i];
+    }
+    if (!root->is_leaf)
+        count = collectInOrder(root->children[root->num_keys], keys, values, count);
+    return count;
+}
+
+// Places sorted[next..] at node k and its subtree in Eytzinger order; returns the next unused.
+int fillEytzinger(packed_index *index, const int *keys, data **values, int next, int k)
+{
+    if (k > index->count)
+        return next;
+    next = fillEytzinger(index, keys, values, next, 2 * k);
+    index->keys[k] = keys[next];
+    index->values[k] = values[next++];
+    return fillEytzinger(index, keys, values, next, 2 * k + 1);
+}
+
+// Builds the packed layout of root, or returns NULL if out of memory.
+packed_index *buildPackedIndex(B *root)
+{
+    int count = root ? root->subtree_size : 0;
+    size_t key_bytes = ((count + 1) * sizeof(int) + 63) / 64 * 64;
+    packed_index *index = (packed_index *)malloc(sizeof(packed_index));
+    int *sorted_keys = (int *)malloc((count + 1) * sizeof(int));
+    data **sorted_values = (data **)malloc((count + 1) * sizeof(data *));
+    if (index)
+    {
+        index->keys = (int *)aligned_alloc(64, key_bytes);
+        index->values = (data **)malloc((count + 1) * sizeof(data *));
+    }
+    if (!index || !index->keys || !index->values || !sorted_keys || !sorted_values)
+    {
+        if (index)
+        {
+            free(index->keys);
+            free(index->values);
+        }
+        free(index);
+        free(sorted_keys);
+        free(sorted_values);
+        return NULL;
+    }
+
+    index->count = count;
+    collectInOrder(root, sorted_keys, sorted_values, 0);
+    fillEytzinger(index, sorted_keys, sorted_values, 0, 1);
+    free(sorted_keys);
+    free(sorted_values);
+    return index;
+}
+
+data *searchPacked(const packed_index *index, int medID)
+{
+    const int *keys = index->keys;
+    int k = 1;
+    while (k <= index->count)
+    {
+        __builtin_prefetch(keys + 16 * k); // 16 ints = one line: the 16 descendants 4 levels down
+        k = 2 * k + (keys[k] < medID);
+    }
+    k >>= __builtin_ffs(~k); // Undo the right turns taken after the last left turn
+    return (k != 0 && keys[k] == medID) ? index->values[k] : NULL;
+}
+
+// Rebuilds packed_medID from medIDTree. Does nothing inside a write section, where the trees
+// are about to change anyway.
+void rebuildPackedIndex()
+{
+    if (write_depth > 0)
+        return;
+    pthread_mutex_lock(&packed_lock);
+    pthread_rwlock_rdlock(&index_lock);
+    packed_index *old = packed_medID;
+    if (old == NULL || old->version != index_version)
+    {
+        long long start = opBegin();
+        packed_index *fresh = buildPackedIndex(medIDTree);
+        opEnd(PHASE_INDEX_REBUILD, start, fresh == NULL);
+        if (fresh)
+        {
+            fresh->version = index_version;
+            __atomic_store_n(&packed_medID, fresh, __ATOMIC_RELEASE);
+            __atomic_store_n(&packed_rebuild_after,
+                             fresh->count > PACKED_MIN_STALE_LOOKUPS ? fresh->count : PACKED_MIN_STALE_LOOKUPS,
+                             __ATOMIC_RELAXED);
+            // Writers are held off by index_lock and other rebuilds by packed_lock
+            retireMemory(old, releasePackedIndex);
+        }
+    }
+    __atomic_store_n(&packed_stale_lookups, 0, __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&index_lock);
+    pthread_mutex_unlock(&packed_lock);
+}
+
+// Finds medID through the packed layout if it reflects version, else through medIDTree. The
+// caller holds index_lock or validates version afterwards.
+data *findMedID(int medID, unsigned long long version)
+{
+    packed_index *index = __atomic_load_n(&packed_medID, __ATOMIC_ACQUIRE);
+    if (index != NULL && index->version == version)
+        return searchPacked(index, medID);
+    __atomic_add_fetch(&packed_stale_lookups, 1, __ATOMIC_RELAXED);
+    return search_medID(__atomic_load_n(&medIDTree, __ATOMIC_ACQUIRE), medID);
+}
+
+// Rebuilds the packed layout once the lookups that missed it add up to the cost of a rebuild.
+void maybeRebuildPackedIndex()
+{
+    if (__atomic_load_n(&packed_stale_lookups, __ATOMIC_RELAXED) >=
+        __atomic_load_n(&packed_rebuild_after, __ATOMIC_RELAXED))
+        rebuildPackedIndex();
+}
+
+//==========LOCK-FREE LOOKUPS==========//
+
+// Optimistic index lookups for readers. Call them between readBegin and readEnd and use the
+// returned records before readEnd; they never block on a writer, they retry instead.
+
+data *lookupMedID(int medID)
+{
+    data *med;
+    unsigned long long version;
+    do
+    {
+        version = readVersion();
+        med = findMedID(medID, version);
+    } while (!readValidate(version));
+    maybeRebuildPackedIndex();
+    return med;
+}
+
+data *lookupMedname(const char *medname)
+{
+    data *med;
+    unsigned long long version;
+    do
+    {
+        version = readVersion();
+        med = search_medname(__atomic_load_n(&mednameTree, __ATOMIC_ACQUIRE), medname);
+    } while (!readValidate(version));
+    return med;
+}
+
+supplier *lookupSupplier(int supplier_id)
+{
+    supplier *s;
+    unsigned long long version;
+    do
+    {
+        version = readVersion();
+        s = search_supplier(__atomic_load_n(&supplierTree, __ATOMIC_ACQUIRE), supplier_id);
+    } while (!readValidate(version));
+    return s;
+}
+
+// Copies up to max expiry-index entries with from <= date <= to (YYYY-MM-DD) into dates and
+// values and returns how many were copied.
+int lookupExpiryRange(const char *from, const char *to, char *dates[], data *values[], int max)
+{
+    int count;
+    unsigned long long version;
+    do
+    {
+        version = readVersion();
+        B_str *root = __atomic_load_n(&expDateTree, __ATOMIC_ACQUIRE);
+        int first = rankOfKeyStr(root, from);
+        count = 0;
+        while (count < max)
+        {
+            int got = entriesByPositionStr(root, first + count, max - count < 64 ? max - count : 64,
+                                           dates + count, values + count);
+            int in_range = 0;
+            while (in_range < got && strcmp(dates[count + in_range], to) <= 0)
+                in_range++;
+            count += in_range;
+            if (in_range < got || got == 0)
+                break;
+        }
+    } while (!readValidate(version));
+    return count;
+}
+
+//==========CONCURRENT SALES==========//
+
+// Sales from several counters may run on separate threads. A sale descends medIDTree under
+// the shared index lock and then holds only its medication's lock while batches are drawn,
+// so sales of different medications never wait for each other. Supplier bookkeeping for a
+// batch that sells out is serialised by supplier_lock (always taken after a medication lock).
+
+// Sells up to qty units of medID and records the sale. Returns the units sold, or -1 if the
+// medication does not exist.
+int concurrentSell(int medID, int qty, long long timestamp)
+{
+    pthread_rwlock_rdlock(&index_lock);
+    long long descent = opBegin();
+    data *med = findMedID(medID, index_version);
+    opEnd(PHASE_TREE_DESCENT, descent, med == NULL);
+    if (med == NULL)
+    {
+        pthread_rwlock_unlock(&index_lock);
+        maybeRebuildPackedIndex();
+        return -1;
+    }
+
+    pthread_mutex_lock(&med->lock);
+    int batches_used;
+    int sold = sellFromMedication(med, qty, &batches_used, NULL, NULL);
+    long long sequence = recordSale(med, sold, timestamp);
+    pthread_mutex_unlock(&med->lock);
+
+    pthread_rwlock_unlock(&index_lock);
+    commitSalesLedger(sequence); // Outside the locks, so concurrent sellers can share the commit
+    maybeRebuildPackedIndex();
+    return sold;
+}
+
+#define BENCH_MEDICATIONS 2048       // Medications in the synthetic benchmark inventory
+#define BENCH_SALES_PER_THREAD 500000 // Sales each benchmark thread performs per run
+
+typedef struct
+{
+    unsigned int seed;
+    int num_skus;   // Sales pick medication IDs 1..num_skus
+    long long sold; // Units this thread sold
+} bench_worker;
+
+void *salesBenchWorker(void *arg)
+{
+    bench_worker *w = (bench_worker *)arg;
+    unsigned int x = w->seed;
+    for (int i = 0; i < BENCH_SALES_PER_THREAD; i++)
+    {
+        // xorshift32: cheap, thread-local and reproducible
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        int sold = concurrentSell((int)(x % w->num_skus) + 1, 1, 0);
+        if (sold > 0)
+            w->sold += sold;
+    }
+    return NULL;
+}
+
+// Fills the empty in-memory trees with medications first_id..last_id (nothing is loaded or saved).
+status_code buildBenchInventory(int first_id, int last_id)
+{
+    for (int id = first_id; id <= last_id; id++)
+    {
+        char name[MAX_NAME_LENGTH];
+        snprintf(name, sizeof(name), "BenchMed%d", id);
+        data *med = findOrCreateMedication(&medIDTree, &mednameTree, id, name, 10, 0);
+        if (!med)
+        {
+            fprintf(stderr, "Memory allocation failed for benchmark inventory.\n");
+            return FAILURE;
+        }
+        // Enough stock that no batch sells out during a benchmark
+        for (int b = 0; b < 4; b++)
+        {
+            char exp_date[MAX_DATE_LENGTH];
+            snprintf(exp_date, sizeof(exp_date), "203%d-01-01", b);
+            addBatchToMedication(&expDateTree, med, b + 1, 1 << 30, exp_date);
+        }
+    }
+    return SUCCESS;
+}
+
+// Measures sale throughput for 1, 2, 4, ... max_threads threads, once with sales spread over
+// every medication and once with every thread selling the same one.
+// Prints CSV: skus,threads,sales,seconds,sales_per_sec,speedup
+int runSalesBenchmark(int max_threads)
+{
+    if (buildBenchInventory(1, BENCH_MEDICATIONS) == FAILURE)
+        return 1;
+    // Every thread would hit the same histogram counters and measure that instead of the sales
+    stats_enabled = false;
+
+    printf("skus,threads,sales,seconds,sales_per_sec,speedup\n");
+    int sku_counts[2] = {BENCH_MEDICATIONS, 1};
+    for (int s = 0; s < 2; s++)
+    {
+        double base = 0;
+        for (int threads = 1;; threads *= 2)
+        {
+            if (threads > max_threads)
+                threads = max_threads;
+            pthread_t tids[threads];
+            bench_worker workers[threads];
+            long long start = now_ns();
+            for (int t = 0; t < threads; t++)
+            {
+                workers[t].seed = 2463534242u + 7919u * t;
+                workers[t].num_skus = sku_counts[s];
+                workers[t].sold = 0;
+                pthread_create(&tids[t], NULL, salesBenchWorker, &workers[t]);
+            }
+            long long total = 0;
+            for (int t = 0; t < threads; t++)
+            {
+                pthread_join(tids[t], NULL);
+                total += workers[t].sold;
+            }
+            double seconds = (now_ns() - start) / 1e9;
+            double rate = total / seconds;
+            if (threads == 1)
+                base = rate;
+            printf("%d,%d,%lld,%.3f,%.0f,%.2f\n", sku_counts[s], threads, total, seconds, rate, rate / base);
+            if (threads == max_threads)
+                break;
+        }
+    }
+    return 0;
+}
+
+#define BENCH_LOOKUPS_PER_THREAD 500000 // Lookups each reader performs per run
+
+typedef struct
+{
+    unsigned int seed;
+    latency_histogram latency;
+} lookup_worker;
+
+int lookup_readers_running = 0; // Readers still working; the churn writer stops at zero
+
+void *lookupBenchReader(void *arg)
+{
+    lookup_worker *w = (lookup_worker *)arg;
+    unsigned int x = w->seed;
+    for (int i = 0; i < BENCH_LOOKUPS_PER_THREAD; i++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        long long start = now_ns();
+        readBegin();
+        data *med = lookupMedID((int)(x % BENCH_MEDICATIONS) + 1);
+        volatile int price = med ? med->priceperunit : 0;
+        (void)price;
+        readEnd();
+        recordLatency(&w->latency, now_ns() - start);
+    }
+    __atomic_sub_fetch(&lookup_readers_running, 1, __ATOMIC_RELEASE);
+    return NULL;
+}
+
+// Inserts and removes medications above the benchmark range until every reader is done, so
+// nodes are split, merged and retired throughout.
+void *lookupBenchWriter(void *arg)
+{
+    long long *writes = (long long *)arg;
+    int next = 0;
+    while (__atomic_load_n(&lookup_readers_running, __ATOMIC_ACQUIRE) > 0)
+    {
+        int id = BENCH_MEDICATIONS + 1 + next;
+        data *med = findOrCreateMedication(&medIDTree, &mednameTree, id, "BenchChurn", 10, 0);
+        if (med)
+            removeMedicationRecord(&medIDTree, &mednameTree, &expDateTree, med, -1);
+        next = (next + 1) % 4096;
+        *writes += 2;
+    }
+    return NULL;
+}
+
+// Measures lock-free lookup latency with `readers` threads, first with no writer and then with
+// one writer continuously changing the trees.
+// Prints CSV: writer,readers,lookups,writes,p50_ns,p99_ns,p999_ns,max_ns
+int runLookupBenchmark(int readers)
+{
+    if (buildBenchInventory(1, BENCH_MEDICATIONS) == FAILURE)
+        return 1;
+
+    lookup_worker *workers = (lookup_worker *)calloc(readers, sizeof(lookup_worker));
+    if (!workers)
+    {
+        fprintf(stderr, "Memory allocation failed for benchmark readers.\n");
+        return 1;
+    }
+
+    printf("writer,readers,lookups,writes,p50_ns,p99_ns,p999_ns,max_ns\n");
+    for (int with_writer = 0; with_writer < 2; with_writer++)
+    {
+        pthread_t tids[readers], writer;
+        long long writes = 0;
+        memset(workers, 0, readers * sizeof(lookup_worker));
+        lookup_readers_running = readers;
+        for (int t = 0; t < readers; t++)
+        {
+            workers[t].seed = 2463534242u + 7919u * t;
+            pthread_create(&tids[t], NULL, lookupBenchReader, &workers[t]);
+        }
+        if (with_writer)
+            pthread_create(&writer, NULL, lookupBenchWriter, &writes);
+
+        latency_histogram all;
+        memset(&all, 0, sizeof(all));
+        for (int t = 0; t < readers; t++)
+        {
+            pthread_join(tids[t], NULL);
+            for (int b = 0; b < LATENCY_BUCKETS; b++)
+                all.counts[b] += workers[t].latency.counts[b];
+            all.total += workers[t].latency.total;
+            if (workers[t].latency.max > all.max)
+                all.max = workers[t].latency.max;
+        }
+        if (with_writer)
+            pthread_join(writer, NULL);
+
+        printf("%s,%d,%lld,%lld,%lld,%lld,%lld,%lld\n", with_writer ? "churn" : "none", readers, all.total, writes,
+               latencyPercentile(&all, 50), latencyPercentile(&all, 99), latencyPercentile(&all, 99.9), all.max);
+    }
+    free(workers);
+    return 0;
+}
+
+#define SEARCH_BENCH_LOOKUPS 2000000 // Random lookups timed per key-search implementation
+
+void freeBenchTree(B *node)
+{
+    if (!node)
+        return;
+    if (!node->is_leaf)
+        for (int i = 0; i <= node->num_keys; i++)
+            freeBenchTree(node->children[i]);
+    free(node);
+}
+
+// Builds a medID tree of keys entries and times the same random lookups through each in-node
+// key search the CPU supports. Prints one CSV row per implementation.
+int runSearchBenchmark(int keys)
+{
+    B *root = NULL;
+    data record;
+    memset(&record, 0, sizeof(record));
+    for (int k = 1; k <= keys; k++)
+        insert_int(&root, k, &record);
+
+    key_search_impl impls[3];
+    int count = keySearchImpls(impls);
+    int (*selected)(const int *, int, int) = keySlot;
+
+    printf("impl,keys,lookups,ns_per_lookup,mlookups_per_sec\n");
+    for (int m = 0; m < count; m++)
+    {
+        keySlot = impls[m].search;
+        unsigned int x = 2463534242u;
+        long long found = 0;
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int l = 0; l < SEARCH_BENCH_LOOKUPS; l++)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            found += search_medID(root, (int)(x % keys) + 1) != NULL;
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        double ns = (end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec);
+        if (found != SEARCH_BENCH_LOOKUPS)
+        {
+            fprintf(stderr, "%s search missed %lld keys.\n", impls[m].name, SEARCH_BENCH_LOOKUPS - found);
+            keySlot = selected;
+            freeBenchTree(root);
+            return 2;
+        }
+        printf("%s,%d,%d,%.1f,%.2f\n", impls[m].name, keys, SEARCH_BENCH_LOOKUPS, ns / SEARCH_BENCH_LOOKUPS,
+               SEARCH_BENCH_LOOKUPS / ns * 1000.0);
+    }
+    keySlot = selected;
+    freeBenchTree(root);
+    return 0;
+}
+
+// Times random medID lookups through the B-tree and through its packed layout for inventories
+// of 1k, 10k, ... up to max_keys medications. Prints one CSV row per size and layout.
+int runLayoutBenchmark(int max_keys)
+{
+    data record;
+    memset(&record, 0, sizeof(record));
+    printf("keys,layout,lookups,ns_per_lookup,mlookups_per_sec\n");
+    for (int keys = 1000; keys <= max_keys; keys *= 10)
+    {
+        B *root = NULL;
+        for (int k = 1; k <= keys; k++)
+            insert_int(&root, k, &record);
+        packed_index *packed = buildPackedIndex(root);
+        if (!packed)
+        {
+            fprintf(stderr, "Memory allocation failed for the packed layout of %d keys.\n", keys);
+            freeBenchTree(root);
+            return 1;
+        }
+
+        for (int layout = 0; layout < 2; layout++)
+        {
+            unsigned int x = 2463534242u;
+            long long found = 0;
+            long long start = now_ns();
+            for (int l = 0; l < SEARCH_BENCH_LOOKUPS; l++)
+            {
+                x ^= x << 13;
+                x ^= x >> 17;
+                x ^= x << 5;
+                int medID = (int)(x % keys) + 1;
+                found += (layout ? searchPacked(packed, medID) : search_medID(root, medID)) != NULL;
+            }
+            double ns = now_ns() - start;
+            if (found != SEARCH_BENCH_LOOKUPS)
+            {
+                fprintf(stderr, "%s layout missed %lld keys.\n", layout ? "packed" : "btree",
+                        SEARCH_BENCH_LOOKUPS - found);
+                releasePackedIndex(packed);
+                freeBenchTree(root);
+                return 2;
+            }
+            printf("%d,%s,%d,%.1f,%.2f\n", keys, layout ? "packed" : "btree", SEARCH_BENCH_LOOKUPS,
+                   ns / SEARCH_BENCH_LOOKUPS, SEARCH_BENCH_LOOKUPS / ns * 1000.0);
+        }
+        releasePackedIndex(packed);
+        freeBenchTree(root);
+        if (keys > max_keys / 10)
+            break;
+    }
+    return 0;
+}
+
+#define SWEEP_BENCH_MEDICATIONS 100000 // Medication slots the synthetic sweep rows are spread over
+
+// Fills the batch columns with batches synthetic rows and times each sweep kernel the CPU
+// supports over them. Prints one CSV row per kernel set.
+int runSweepBenchmark(int batches)
+{
+    if (columnsReserve(batches) == FAILURE)
+    {
+        fprintf(stderr, "Memory allocation failed for %d benchmark rows.\n", batches);
+        return 1;
+    }
+    int today = dateToDay("2025-01-01");
+    unsigned int x = 2463534242u;
+    for (int r = 0; r < batches; r++)
+    {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        columns.expiry[r] = today - 365 + (int)(x % 1500);
+        columns.qty[r] = (int)(x >> 16) % 500;
+        columns.price[r] = 1 + (int)(x >> 8) % 100;
+        columns.med[r] = r % SWEEP_BENCH_MEDICATIONS;
+    }
+    columns.rows = batches;
+    columns.slots = SWEEP_BENCH_MEDICATIONS;
+
+    int *hits = (int *)malloc(batches * sizeof(int));
+    long long *stock = (long long *)malloc(SWEEP_BENCH_MEDICATIONS * sizeof(long long));
+    if (!hits || !stock)
+    {
+        fprintf(stderr, "Memory allocation failed for benchmark results.\n");
+        free(hits);
+        free(stock);
+        return 1;
+    }
+
+    sweep_kernels impls[2];
+    int count = sweepKernelImpls(impls);
+    sweep_totals first;
+    int first_due = 0;
+    printf("impl,batches,due,expired_value,expiry_ms,valuation_ms,stock_ms\n");
+    for (int m = 0; m < count; m++)
+    {
+        sweep_totals totals;
+        long long t0 = now_ns();
+        int due = impls[m].selectExpiring(columns.expiry, batches, today + EXPIRY_WARNING_DAYS, hits);
+        long long t1 = now_ns();
+        impls[m].totals(columns.expiry, columns.qty, columns.price, batches, today, &totals);
+        long long t2 = now_ns();
+        memset(stock, 0, SWEEP_BENCH_MEDICATIONS * sizeof(long long));
+        stockBySlot(stock);
+        long long t3 = now_ns();
+        if (m == 0)
+        {
+            first = totals;
+            first_due = due;
+        }
+        else if (due != first_due || memcmp(&totals, &first, sizeof(totals)) != 0)
+        {
+            fprintf(stderr, "%s kernels disagree with the scalar ones.\n", impls[m].name);
+            free(hits);
+            free(stock);
+            return 2;
+        }
+        printf("%s,%d,%d,%lld,%.2f,%.2f,%.2f\n", impls[m].name, batches, due, totals.expired_value, (t1 - t0) / 1e6,
+               (t2 - t1) / 1e6, (t3 - t2) / 1e6);
+    }
+    free(hits);
+    free(stock);
+    return 0;
+}
+
+//==========TREE MICROBENCHMARKS==========//
+
+// Drives each index tree's insert, search and delete directly, under sequential, random and
+// skewed key orders, and checks the B-tree invariants after every phase. Deletes are checked
+// halfway too, after every other key has gone, while borrows and merges are still reshaping the
+// tree rather than emptying it.
+
+#define TREE_BENCH_SKEW_WINDOW 64 // Skewed inserts are shuffled only within windows this long
+
+typedef enum
+{
+    KEYS_SEQUENTIAL,
+    KEYS_RANDOM,
+    KEYS_SKEWED,
+    KEY_ORDERS
+} key_order;
+
+const char *key_order_names[KEY_ORDERS] = {"sequential", "random", "skewed"};
+
+// Shape of a tree and the invariant violations found while measuring it
+typedef struct
+{
+    int height;
+    long long nodes;
+    long long keys;
+    int violations;
+} tree_shape;
+
+// Opens a hardware cache-miss counter for this thread, or returns -1 if the kernel or the
+// sandbox does not allow it.
+int openCacheMissCounter()
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+void startCounter(int fd)
+{
+    if (fd < 0)
+        return;
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+}
+
+// Returns the misses counted since startCounter, or -1 without a counter.
+long long stopCounter(int fd)
+{
+    long long count = -1;
+    if (fd < 0)
+        return -1;
+    ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd, &count, sizeof(count)) != sizeof(count))
+        return -1;
+    return count;
+}
+
+// Fills keys[0..n) with the keys 1..n in insertion (and deletion) order and probes[0..n) with
+// the keys searched for. Sequential inserts in ascending order and searches the same way; random
+// shuffles both; skewed inserts nearly in order (IDs handed out over time, shuffled within
+// small windows) and sends most searches to the newest few percent of keys.
+void makeBenchKeys(int *keys, int *probes, int n, key_order order)
+{
+    unsigned int state = 2463534242u;
+    for (int i = 0; i < n; i++)
+        keys[i] = i + 1;
+    int window = order == KEYS_RANDOM ? n : order == KEYS_SKEWED ? TREE_BENCH_SKEW_WINDOW : 1;
+    for (int start = 0; start < n; start += window)
+    {
+        int end = start + window < n ? start + window : n;
+        for (int i = end - 1; i > start; i--)
+        {
+            int j = start + (int)(nextRandom(&state) % (i - start + 1));
+            int temp = keys[i];
+            keys[i] = keys[j];
+            keys[j] = temp;
+        }
+    }
+    for (int i = 0; i < n; i++)
+    {
+        if (order != KEYS_SKEWED)
+            probes[i] = keys[i];
+        else
+        {
+            double u = (nextRandom(&state) % 1000000) / 1000000.0;
+            probes[i] = n - (int)(u * u * u * n); // Cubing a uniform draw piles it up near 0
+        }
+    }
+}
+
+// Walks an integer-keyed tree (B or B_supp) checking key order, node occupancy, leaf depth and
+// subtree sizes. Returns the number of keys below node.
+long long checkIntNode(B *node, int depth, Boolean is_root, const int *low, const int *high, tree_shape *shape)
+{
+    shape->nodes++;
+    if ((!is_root && node->num_keys < INT_MIN_KEYS) || node->num_keys > INT_ORDER - 1 || node->num_keys < 1)
+        shape->violations++;
+    for (int i = 0; i < node->num_keys; i++)
+    {
+        if ((i > 0 && node->keys[i - 1] >= node->keys[i]) || (low && node->keys[i] <= *low) ||
+            (high && node->keys[i] >= *high))
+            shape->violations++;
+    }
+
+    long long count = node->num_keys;
+    if (node->is_leaf)
+    {
+        if (shape->height == 0)
+            shape->height = depth;
+        else if (shape->height != depth)
+            shape->violations++;
+    }
+    else
+    {
+        for (int i = 0; i <= node->num_keys; i++)
+        {
+            if (node->children[i] == NULL)
+            {
+                shape->violations++;
+                continue;
+            }
+            count += checkIntNode(node->children[i], depth + 1, false, i > 0 ? &node->keys[i - 1] : low,
+                                  i < node->num_keys ? &node->keys[i] : high, shape);
+        }
+    }
+    if (count != node->subtree_size)
+        shape->violations++;
+    return count;
+}
+
+long long checkStrNode(B_str *node, int depth, Boolean is_root, const char *low, const char *high,
+                       tree_shape *shape)
+{
+    shape->nodes++;
+    if ((!is_root && node->num_keys < MIN_KEYS) || node->num_keys > ORDER - 1 || node->num_keys < 1)
+        shape->violations++;
+    for (int i = 0; i < node->num_keys; i++)
+    {
+        if ((i > 0 && strcmp(node->keys[i - 1], node->keys[i]) > 0) || (low && strcmp(node->keys[i], low) < 0) ||
+            (high && strcmp(node->keys[i], high) > 0))
+            shape->violations++;
+    }
+
+    long long count = node->num_keys;
+    if (node->is_leaf)
+    {
+        if (shape->height == 0)
+            shape->height = depth;
+        else if (shape->height != depth)
+            shape->violations++;
+    }
+    else
+    {
+        for (int i = 0; i <= node->num_keys; i++)
+        {
+            if (node->children[i] == NULL)
+            {
+                shape->violations++;
+                continue;
+            }
+            count += checkStrNode(node->children[i], depth + 1, false, i > 0 ? node->keys[i - 1] : low,
+                                  i < node->num_keys ? node->keys[i] : high, shape);
+        }
+    }
+    if (count != node->subtree_size)
+        shape->violations++;
+    return count;
+}
+
+// Checks a whole tree holding expected keys; root is a B, B_supp or B_str as is_str says.
+tree_shape checkTree(void *root, Boolean is_str, long long expected)
+{
+    tree_shape shape = {0, 0, 0, 0};
+    if (root != NULL)
+        shape.keys = is_str ? checkStrNode((B_str *)root, 1, true, NULL, NULL, &shape)
+                            : checkIntNode((B *)root, 1, true, NULL, NULL, &shape);
+    if (shape.keys != expected)
+        shape.violations++;
+    return shape;
+}
+
+typedef enum
+{
+    TREE_MEDID,    // B via insert_int / deleteFromBTree
+    TREE_NAME,     // B_str via insert_str / deleteFromBTreeStr
+    TREE_SUPPLIER, // B_supp via insert_supp / deleteFromBTreeSupp
+    TREE_TYPES
+} bench_tree;
+
+const char *bench_tree_names[TREE_TYPES] = {"medid", "name", "supplier"};
+
+// Runs one phase over every key and returns how many keys it found (search) or touched.
+long long runTreePhase(bench_tree tree, int phase, void **root, const int *keys, char **names, int n)
+{
+    static data record;
+    static supplier supp;
+    long long hits = 0;
+    for (int i = 0; i < n; i++)
+    {
+        switch (tree * 3 + phase)
+        {
+        case TREE_MEDID * 3 + 0:
+            insert_int((B **)root, keys[i], &record);
+            break;
+        case TREE_MEDID * 3 + 1:
+            hits += search_medID((B *)*root, keys[i]) != NULL;
+            break;
+        case TREE_MEDID * 3 + 2:
+            *root = deleteFromBTree((B *)*root, keys[i]);
+            break;
+        case TREE_NAME * 3 + 0:
+            insert_str((B_str **)root, names[i], &record);
+            break;
+        case TREE_NAME * 3 + 1:
+            hits += search_medname((B_str *)*root, names[i]) != NULL;
+            break;
+        case TREE_NAME * 3 + 2:
+            *root = deleteFromBTreeStr((B_str *)*root, names[i], &record);
+            break;
+        case TREE_SUPPLIER * 3 + 0:
+            insert_supp((B_supp **)root, keys[i], &supp);
+            break;
+        case TREE_SUPPLIER * 3 + 1:
+            hits += search_supplier((B_supp *)*root, keys[i]) != NULL;
+            break;
+        case TREE_SUPPLIER * 3 + 2:
+            *root = deleteFromBTreeSupp((B_supp *)*root, keys[i]);
+            break;
+        }
+    }
+    return phase == 1 ? hits : n;
+}
+
+// Measures insert, search and delete of n keys for every tree type and key order. Prints one
+// CSV row per phase; returns nonzero if any invariant check failed.
+int runTreeBenchmark(int n)
+{
+    int *keys = (int *)malloc(2 * (size_t)n * sizeof(int)); // Insertion order, then probes
+    char **names = (char **)malloc(2 * (size_t)n * sizeof(char *));
+    char *name_buf = (char *)malloc(2 * (size_t)n * 12);
+    if (!keys || !names || !name_buf)
+    {
+        fprintf(stderr, "Memory allocation failed for %d benchmark keys.\n", n);
+        free(keys);
+        free(names);
+        free(name_buf);
+        return 1;
+    }
+
+    int counter = openCacheMissCounter();
+    const char *steps[4] = {"insert", "search", "delete_half", "delete"};
+    int failed = 0;
+    printf("tree,keys,order,op,ns_per_op,cache_misses_per_op,height,nodes,violations\n");
+    for (int tree = 0; tree < TREE_TYPES; tree++)
+    {
+        for (int order = 0; order < KEY_ORDERS; order++)
+        {
+            makeBenchKeys(keys, keys + n, n, (key_order)order);
+            for (int i = 0; i < 2 * n; i++)
+            {
+                names[i] = name_buf + (size_t)i * 12;
+                snprintf(names[i], 12, "K%010d", keys[i]); // Zero padding keeps string and integer order alike
+            }
+
+            void *root = NULL;
+            for (int step = 0; step < 4; step++)
+            {
+                // Deletes run in two steps, every other key of the insertion order and then the
+                // rest, so the tree is checked while the delete rebalancing is half done. They
+                // reuse the probe half of the arrays, which the search step has finished with.
+                int phase = step < 2 ? step : 2;
+                int offset = step == 0 ? 0 : n;
+                int count = step < 2 ? n : step == 2 ? (n + 1) / 2 : n / 2;
+                if (step == 2)
+                {
+                    for (int i = 0; i < n; i++)
+                    {
+                        int from = i < (n + 1) / 2 ? 2 * i : 2 * (i - (n + 1) / 2) + 1;
+                        keys[n + i] = keys[from];
+                        names[n + i] = names[from];
+                    }
+                }
+                if (step == 3)
+                    offset = n + (n + 1) / 2;
+
+                startCounter(counter);
+                long long start = now_ns();
+                long long done = runTreePhase((bench_tree)tree, phase, &root, keys + offset, names + offset, count);
+                long long elapsed = now_ns() - start;
+                long long misses = stopCounter(counter);
+                reclaimRetired(); // Deleted nodes and keys were retired, not freed
+
+                long long remaining = step < 2 ? n : step == 2 ? n - count : 0;
+                tree_shape shape = checkTree(root, tree == TREE_NAME, remaining);
+                if (done != count)
+                    shape.violations++;
+                failed |= shape.violations != 0;
+
+                printf("%s,%d,%s,%s,%.1f,", bench_tree_names[tree], n, key_order_names[order], steps[step],
+                       count ? (double)elapsed / count : 0.0);
+                if (misses >= 0)
+                    printf("%.2f", count ? (double)misses / count : 0.0);
+                else
+                    printf("NA");
+                printf(",%d,%lld,%d\n", shape.height, shape.nodes, shape.violations);
+            }
+        }
+    }
+    if (counter >= 0)
+        close(counter);
+    free(keys);
+    free(names);
+    free(name_buf);
+    return failed ? 2 : 0;
+}
+
+//==========TREE HEALTH==========//
+
+// Shape and consistency of the four live index trees, cheap enough to run on demand after heavy
+// delete churn. Structural invariants come from checkTree. On top of that every key must lead
+// to a record that carries it, and each tree must hold as many keys as another structure says
+// it should: one ID and one name per medication slot in the batch columns, one expiry date per
+// batch row, and one supplier per entry in the supplier rankings.
+
+#define TREE_MAX_LEVELS 32 // Deeper levels are folded into the last one; a healthy tree is far shallower
+
+typedef enum
+{
+    HEALTH_MEDID,
+    HEALTH_NAME,
+    HEALTH_EXPIRY,
+    HEALTH_SUPPLIER,
+    HEALTH_TREES
+} health_tree;
+
+const char *health_tree_names[HEALTH_TREES] = {"medid", "name", "expiry", "supplier"};
+
+typedef struct
+{
+    tree_shape shape;                      // Height, nodes, keys and structural violations
+    long long expected;                    // Keys the tree should hold
+    long long level_keys[TREE_MAX_LEVELS]; // Keys per level, root first
+    long long duplicates;                  // Keys equal to their in-order predecessor
+    long long bad_values;                  // Keys whose record does not carry that key
+    double fill;                           // Keys over key slots across all nodes
+} tree_health;
+
+int healthLevel(int depth)
+{
+    return depth < TREE_MAX_LEVELS ? depth : TREE_MAX_LEVELS - 1;
+}
+
+// In-order walk of a B or B_supp subtree; prev tracks the last key seen for duplicate counting.
+void surveyIntNode(B *node, int depth, Boolean suppliers, const int **prev, tree_health *health)
+{
+    health->level_keys[healthLevel(depth)] += node->num_keys;
+    for (int i = 0; i <= node->num_keys; i++)
+    {
+        if (!node->is_leaf && node->children[i])
+            surveyIntNode(node->children[i], depth + 1, suppliers, prev, health);
+        if (i == node->num_keys)
+            break;
+
+        if (*prev && **prev == node->keys[i])
+            health->duplicates++;
+        *prev = &node->keys[i];
+        if (suppliers)
+        {
+            supplier *s = ((B_supp *)node)->values[i];
+            if (s == NULL || s->supplier_id != node->keys[i])
+                health->bad_values++;
+        }
+        else if (node->values[i] == NULL || node->values[i]->medID != node->keys[i])
+        {
+            health->bad_values++;
+        }
+    }
+}
+
+Boolean medicationHasExpiry(const data *med, const char *exp_date)
+{
+    for (int j = 0; j < med->batch_count; j++)
+    {
+        if (strcmp(med->Batch[j].exp_date, exp_date) == 0)
+            return true;
+    }
+    return false;
+}
+
+void surveyStrNode(B_str *node, int depth, Boolean expiry, const char **prev, tree_health *health)
+{
+    health->level_keys[healthLevel(depth)] += node->num_keys;
+    for (int i = 0; i <= node->num_keys; i++)
+    {
+        if (!node->is_leaf && node->children[i])
+            surveyStrNode(node->children[i], depth + 1, expiry, prev, health);
+        if (i == node->num_keys)
+            break;
+
+        if (*prev && strcmp(*prev, node->keys[i]) == 0)
+            health->duplicates++;
+        *prev = node->keys[i];
+        data *med = node->values[i];
+        if (med == NULL || (expiry ? !medicationHasExpiry(med, node->keys[i]) : strcmp(med->medname, node->keys[i]) != 0))
+            health->bad_values++;
+    }
+}
+
+// Surveys one live tree. Callers must keep writers out meanwhile.
+void treeHealth(health_tree tree, tree_health *health)
+{
+    memset(health, 0, sizeof(*health));
+    long long medications = columns.slots - columns.free_slot_count;
+    int max_keys = tree == HEALTH_NAME || tree == HEALTH_EXPIRY ? ORDER - 1 : INT_ORDER - 1;
+    const int *prev_int = NULL;
+    const char *prev_str = NULL;
+    switch (tree)
+    {
+    case HEALTH_MEDID:
+        health->expected = medications;
+        health->shape = checkTree(medIDTree, false, health->expected);
+        if (medIDTree)
+            surveyIntNode(medIDTree, 0, false, &prev_int, health);
+        break;
+    case HEALTH_NAME:
+        health->expected = medications;
+        health->shape = checkTree(mednameTree, true, health->expected);
+        if (mednameTree)
+            surveyStrNode(mednameTree, 0, false, &prev_str, health);
+        break;
+    case HEALTH_EXPIRY:
+        health->expected = columns.rows - columns.free_row_count;
+        health->shape = checkTree(expDateTree, true, health->expected);
+        if (expDateTree)
+            surveyStrNode(expDateTree, 0, true, &prev_str, health);
+        break;
+    default:
+        health->expected = supplierRankings[RANK_BY_MEDS].size;
+        health->shape = checkTree(supplierTree, false, health->expected);
+        if (supplierTree)
+            surveyIntNode((B *)supplierTree, 0, true, &prev_int, health);
+        break;
+    }
+    if (health->shape.nodes > 0)
+        health->fill = (double)health->shape.keys / (health->shape.nodes * max_keys);
+}
+
+// Surveys every tree as a writer, so expiry entries still queued by sales are gone first.
+// Returns the number of trees with structural violations or bad values.
+int surveyTrees(tree_health health[HEALTH_TREES])
+{
+    int violations = 0;
+    writeBegin();
+    for (int t = 0; t < HEALTH_TREES; t++)
+    {
+        treeHealth(t, &health[t]);
+        violations += health[t].shape.violations + (health[t].bad_values > 0);
+    }
+    writeEnd();
+    return violations;
+}
+
+// Writes the non-empty levels as "k0/k1/..." into out.
+void formatLevelKeys(const tree_health *health, char *out, size_t size)
+{
+    size_t used = 0;
+    out[0] = '\0';
+    for (int level = 0; level < TREE_MAX_LEVELS && level < health->shape.height && used < size; level++)
+        used += snprintf(out + used, size - used, "%s%lld", level ? "/" : "", health->level_keys[level]);
+}
+
+void printTreeHealth()
+{
+    long long start = now_ns();
+    tree_health health[HEALTH_TREES];
+    surveyTrees(health);
+    long long elapsed = now_ns() - start;
+
+    printf("%-9s %6s %9s %10s %10s %6s %10s %10s %10s  %s\n", "Tree", "Height", "Nodes", "Keys", "Expected",
+           "Fill", "Duplicates", "Bad values", "Violations", "Keys per level");
+    for (int t = 0; t < HEALTH_TREES; t++)
+    {
+        char levels[256];
+        formatLevelKeys(&health[t], levels, sizeof(levels));
+        printf("%-9s %6d %9lld %10lld %10lld %5.1f%% %10lld %10lld %10d  %s\n", health_tree_names[t],
+               health[t].shape.height, health[t].shape.nodes, health[t].shape.keys, health[t].expected,
+               100.0 * health[t].fill, health[t].duplicates, health[t].bad_values, health[t].shape.violations,
+               levels);
+    }
+    printf("Checked in %.3f ms.\n", elapsed / 1e6);
+}
+
+//==========MEMORY ACCOUNTING==========//
+
+// Bytes held by each structure, walked from the live trees. Fixed-size arrays are split out so
+// the slots that are reserved but unused show up: every medication carries MAX_BATCHES batches
+// and every batch MAX_SUPPLIERS supplier pointers, whether or not they are used. A supplier's
+// medication array and link set grow on demand; their spare capacity is shown the same way.
+// Allocator overhead is not included.
+
+typedef enum
+{
+    MEM_MEDID_NODES,
+    MEM_NAME_NODES,
+    MEM_EXPIRY_NODES,
+    MEM_SUPPLIER_NODES,
+    MEM_STRING_KEYS,
+    MEM_MEDICATIONS,
+    MEM_BATCHES,
+    MEM_BATCH_SUPPLIER_SLOTS,
+    MEM_SUPPLIERS,
+    MEM_SUPPLIER_MED_SLOTS,
+    MEM_SUPPLIER_LINKS,
+    MEM_RANKINGS,
+    MEM_BATCH_COLUMNS,
+    MEM_SUPPLY_EDGES,
+    MEM_PACKED_INDEX,
+    MEM_ITEMS
+} memory_item;
+
+const char *memory_item_names[MEM_ITEMS] = {"medid_nodes", "name_nodes", "expiry_nodes", "supplier_nodes",
+                                            "string_keys", "medications", "batches", "batch_supplier_slots",
+                                            "suppliers", "supplier_med_slots", "supplier_links", "rankings",
+                                            "batch_columns", "supply_edges", "packed_index"};
+
+// One structure's footprint. used/reserved count slots: keys per node, batches per medication,
+// links per batch or supplier, rows per column.
+typedef struct
+{
+    long long bytes;
+    long long used;
+    long long reserved;
+} memory_usage;
+
+void accountIntNodes(B *node, memory_usage *usage, size_t node_size)
+{
+    if (node == NULL)
+        return;
+    usage->bytes += node_size;
+    usage->used += node->num_keys;
+    usage->reserved += INT_ORDER - 1;
+    if (!node->is_leaf)
+        for (int i = 0; i <= node->num_keys; i++)
+            accountIntNodes(node->children[i], usage, node_size);
+}
+
+void accountStrNodes(B_str *node, memory_usage *usage, memory_usage *strings)
+{
+    if (node == NULL)
+        return;
+    usage->bytes += sizeof(B_str);
+    usage->used += node->num_keys;
+    usage->reserved += ORDER - 1;
+    for (int i = 0; i < node->num_keys; i++)
+    {
+        long long length = (long long)strlen(node->keys[i]) + 1;
+        strings->bytes += length;
+        strings->used += length;
+        strings->reserved += length;
+    }
+    if (!node->is_leaf)
+        for (int i = 0; i <= node->num_keys; i++)
+            accountStrNodes(node->children[i], usage, strings);
+}
+
+void accountMedications(B *node, memory_usage *report)
+{
+    if (node == NULL)
+        return;
+    size_t batch_bytes = sizeof(batch) - MAX_SUPPLIERS * sizeof(supplier *);
+    for (int i = 0; i < node->num_keys; i++)
+    {
+        data *med = node->values[i];
+        report[MEM_MEDICATIONS].bytes += sizeof(data) - MAX_BATCHES * sizeof(batch);
+        report[MEM_MEDICATIONS].used++;
+        report[MEM_MEDICATIONS].reserved++;
+        report[MEM_BATCHES].bytes += MAX_BATCHES * batch_bytes;
+        report[MEM_BATCHES].used += med->batch_count;
+        report[MEM_BATCHES].reserved += MAX_BATCHES;
+        report[MEM_BATCH_SUPPLIER_SLOTS].bytes += (long long)MAX_BATCHES * MAX_SUPPLIERS * sizeof(supplier *);
+        report[MEM_BATCH_SUPPLIER_SLOTS].reserved += (long long)MAX_BATCHES * MAX_SUPPLIERS;
+        for (int j = 0; j < med->batch_count; j++)
+            report[MEM_BATCH_SUPPLIER_SLOTS].used += med->Batch[j].supplier_count;
+    }
+    if (!node->is_leaf)
+        for (int i = 0; i <= node->num_keys; i++)
+            accountMedications(node->children[i], report);
+}
+
+void accountSuppliers(B_supp *node, memory_usage *report)
+{
+    if (node == NULL)
+        return;
+    for (int i = 0; i < node->num_keys; i++)
+    {
+        supplier *s = node->values[i];
+        report[MEM_SUPPLIERS].bytes += sizeof(supplier);
+        report[MEM_SUPPLIERS].used++;
+        report[MEM_SUPPLIERS].reserved++;
+        report[MEM_SUPPLIER_MED_SLOTS].bytes +=
+            s->med_capacity * sizeof(data *) + s->med_set_capacity * sizeof(med_link_slot);
+        report[MEM_SUPPLIER_MED_SLOTS].used += s->med_count;
+        report[MEM_SUPPLIER_MED_SLOTS].reserved += s->med_capacity;
+        report[MEM_SUPPLIER_LINKS].bytes += s->link_capacity * sizeof(supplier_link);
+        report[MEM_SUPPLIER_LINKS].used += s->link_count;
+        report[MEM_SUPPLIER_LINKS].reserved += s->link_capacity;
+    }
+    if (!node->is_leaf)
+        for (int i = 0; i <= node->num_keys; i++)
+            accountSuppliers(node->children[i], report);
+}
+
+// Fills report[MEM_ITEMS]. Callers must keep writers out of the trees meanwhile.
+void accountMemory(memory_usage *report)
+{
+    memset(report, 0, MEM_ITEMS * sizeof(memory_usage));
+    accountIntNodes(medIDTree, &report[MEM_MEDID_NODES], sizeof(B));
+    accountIntNodes((B *)supplierTree, &report[MEM_SUPPLIER_NODES], sizeof(B_supp));
+    accountStrNodes(mednameTree, &report[MEM_NAME_NODES], &report[MEM_STRING_KEYS]);
+    accountStrNodes(expDateTree, &report[MEM_EXPIRY_NODES], &report[MEM_STRING_KEYS]);
+    accountMedications(medIDTree, report);
+    accountSuppliers(supplierTree, report);
+
+    for (int m = 0; m < RANK_METRICS; m++)
+    {
+        report[MEM_RANKINGS].bytes += supplierRankings[m].capacity * sizeof(supplier *);
+        report[MEM_RANKINGS].used += supplierRankings[m].size;
+        report[MEM_RANKINGS].reserved += supplierRankings[m].capacity;
+    }
+
+    // expiry, qty, price, med and free_rows per row; meds and free_slots per slot
+    report[MEM_BATCH_COLUMNS].bytes = (long long)columns.row_capacity * 5 * sizeof(int) +
+                                      (long long)columns.slot_capacity * (sizeof(data *) + sizeof(int));
+    report[MEM_BATCH_COLUMNS].used = columns.rows - columns.free_row_count;
+    report[MEM_BATCH_COLUMNS].reserved = columns.row_capacity;
+
+    // supplier, batch, qty, price and free_rows per row
+    report[MEM_SUPPLY_EDGES].bytes = (long long)supply_edges.row_capacity * 5 * sizeof(int);
+    report[MEM_SUPPLY_EDGES].used = supply_edges.rows - supply_edges.free_row_count;
+    report[MEM_SUPPLY_EDGES].reserved = supply_edges.row_capacity;
+
+    packed_index *packed = __atomic_load_n(&packed_medID, __ATOMIC_ACQUIRE);
+    if (packed)
+    {
+        report[MEM_PACKED_INDEX].bytes = sizeof(packed_index) + (packed->count + 1) * (sizeof(int) + sizeof(data *));
+        report[MEM_PACKED_INDEX].used = packed->count;
+        report[MEM_PACKED_INDEX].reserved = packed->count;
+    }
+}
+
+long long memoryTotal(const memory_usage *report)
+{
+    long long total = 0;
+    for (int i = 0; i < MEM_ITEMS; i++)
+        total += report[i].bytes;
+    return total;
+}
+
+void printMemoryReport()
+{
+    memory_usage report[MEM_ITEMS];
+    accountMemory(report);
+    long long total = memoryTotal(report);
+
+    printf("%-22s %14s %7s %14s %14s %7s\n", "Structure", "Bytes", "Share", "Slots used", "Reserved", "Used");
+    for (int i = 0; i < MEM_ITEMS; i++)
+    {
+        printf("%-22s %14lld %6.1f%% %14lld %14lld %6.1f%%\n", memory_item_names[i], report[i].bytes,
+               total ? 100.0 * report[i].bytes / total : 0.0, report[i].used, report[i].reserved,
+               report[i].reserved ? 100.0 * report[i].used / report[i].reserved : 0.0);
+    }
+    printf("%-22s %14lld (%.1f MB)\n", "total", total, total / (1024.0 * 1024.0));
+}
+
+//==========SUPPLIER ANALYTICS==========//
+
+// Recomputes every supplier's distinct-medication count and turnover from scratch by walking
+// medIDTree. The upper levels of the tree are cut into independent subtrees that worker threads
+// claim one at a time, each adding into its own partial totals; the partials are merged at the
+// end. The incremental rankings answer the reports; this full pass audits them and is what a
+// rebuild would use. Totals are kept per entry of a supplier_index built from supplierTree before
+// the pass, so every supplier ID is tallied; workers only read the index.
+
+typedef struct
+{
+    const supplier_index *index; // Supplier ID to entry, shared by every partial
+    long long *turnover;         // Units x unit price at receipt over every link
+    int *med_count;              // Distinct medications linked
+    const data **last_med;       // Last medication counted, to count each one once
+    long long links;             // Batch-supplier links visited
+} supplier_totals;
+
+typedef struct
+{
+    B **subtrees;
+    int num_subtrees;
+    int next; // Next subtree to claim
+} analytics_pass;
+
+typedef struct
+{
+    analytics_pass *pass;
+    supplier_totals *partial; // This worker's own totals
+} analytics_worker;
+
+void accumulateMedication(const data *med, supplier_totals *t)
+{
+    for (int b = 0; b < med->batch_count; b++)
+    {
+        const batch *bt = &med->Batch[b];
+        for (int k = 0; k < bt->supplier_count; k++)
+        {
+            supplier *s = bt->suppliers[k];
+            t->links++;
+            if (s == NULL)
+                continue;
+            int id = findSupplierIndex(t->index, s->supplier_id);
+            if (id < 0)
+                continue;
+            const supplier_link *link = findSupplierLink(s, med, b);
+            if (link)
+                t->turnover[id] += (long long)supply_edges.qty[link->edge] * supply_edges.price[link->edge];
+            if (t->last_med[id] != med)
+            {
+                t->last_med[id] = med;
+                t->med_count[id]++;
+            }
+        }
+    }
+}
+
+void accumulateSubtree(B *node, supplier_totals *t)
+{
+    if (node == NULL)
+        return;
+    for (int i = 0; i < node->num_keys; i++)
+    {
+        if (!node->is_leaf)
+            accumulateSubtree(node->children[i], t);
+        accumulateMedication(node->values[i], t);
+    }
+    if (!node->is_leaf)
+        accumulateSubtree(node->children[node->num_keys], t);
+}
+
+void *analyticsWorker(void *arg)
+{
+    analytics_worker *w = (analytics_worker *)arg;
+    int i;
+    while ((i = __atomic_fetch_add(&w->pass->next, 1, __ATOMIC_RELAXED)) < w->pass->num_subtrees)
+        accumulateSubtree(w->pass->subtrees[i], w->partial);
+    return NULL;
+}
+
+// Gives every supplier under node an entry in index.
+status_code indexSupplierNode(B_supp *node, supplier_index *index)
+{
+    if (node == NULL)
+        return SUCCESS;
+    for (int i = 0; i <= node->num_keys; i++)
+    {
+        if (!node->is_leaf && indexSupplierNode(node->children[i], index) == FAILURE)
+            return FAILURE;
+        if (i < node->num_keys && addSupplierIndex(index, node->values[i]->supplier_id) < 0)
+            return FAILURE;
+    }
+    return SUCCESS;
+}
+
+// Points t at index and gives it zeroed counters for every entry.
+status_code allocSupplierTotals(supplier_totals *t, const supplier_index *index)
+{
+    int n = index->count ? index->count : 1;
+    t->index = index;
+    t->turnover = (long long *)calloc(n, sizeof(long long));
+    t->med_count = (int *)calloc(n, sizeof(int));
+    t->last_med = (const data **)calloc(n, sizeof(const data *));
+    t->links = 0;
+    if (!t->turnover || !t->med_count || !t->last_med)
+        return FAILURE;
+    return SUCCESS;
+}
+
+void freeSupplierTotals(supplier_totals *t)
+{
+    free(t->turnover);
+    free(t->med_count);
+    free(t->last_med);
+    t->turnover = NULL;
+    t->med_count = NULL;
+    t->last_med = NULL;
+}
+
+// Fills totals for every supplier in index using up to `threads` threads. index must hold every
+// supplier in supplierTree (see indexSupplierNode). Returns FAILURE if memory for the pass could
+// not be allocated. The caller frees totals with freeSupplierTotals either way.
+status_code computeSupplierTotals(int threads, const supplier_index *index, supplier_totals *totals)
+{
+    if (allocSupplierTotals(totals, index) == FAILURE)
+        return FAILURE;
+    if (medIDTree == NULL)
+        return SUCCESS;
+    if (threads < 1)
+        threads = 1;
+
+    // Descend level by level until there are a few subtrees per thread to balance the load.
+    // Records stored in the levels above the cut are counted here, on the calling thread.
+    B **level = (B **)malloc(sizeof(B *));
+    if (!level)
+        return FAILURE;
+    level[0] = medIDTree;
+    int level_size = 1;
+    while (level_size < 4 * threads && !level[0]->is_leaf)
+    {
+        B **next = (B **)malloc(level_size * INT_ORDER * sizeof(B *));
+        if (!next)
+        {
+            free(level);
+            return FAILURE;
+        }
+        int next_size = 0;
+        for (int n = 0; n < level_size; n++)
+        {
+            for (int i = 0; i < level[n]->num_keys; i++)
+                accumulateMedication(level[n]->values[i], totals);
+            for (int i = 0; i <= level[n]->num_keys; i++)
+                next[next_size++] = level[n]->children[i];
+        }
+        free(level);
+        level = next;
+        level_size = next_size;
+    }
+
+    if (threads > level_size)
+        threads = level_size;
+    supplier_totals *partials = (supplier_totals *)calloc(threads, sizeof(supplier_totals));
+    pthread_t *tids = (pthread_t *)malloc(threads * sizeof(pthread_t));
+    analytics_worker *workers = (analytics_worker *)malloc(threads * sizeof(analytics_worker));
+    status_code status = (partials && tids && workers) ? SUCCESS : FAILURE;
+    for (int t = 0; partials && t < threads && status == SUCCESS; t++)
+        status = allocSupplierTotals(&partials[t], index);
+    if (status == FAILURE)
+    {
+        for (int t = 0; partials && t < threads; t++)
+            freeSupplierTotals(&partials[t]);
+        free(partials);
+        free(tids);
+        free(workers);
+        free(level);
+        return FAILURE;
+    }
+
+    analytics_pass pass = {level, level_size, 0};
+    for (int t = 0; t < threads; t++)
+    {
+        workers[t].pass = &pass;
+        workers[t].partial = &partials[t];
+        if (t > 0)
+            pthread_create(&tids[t], NULL, analyticsWorker, &workers[t]);
+    }
+    analyticsWorker(&workers[0]); // The calling thread takes a share too
+    for (int t = 1; t < threads; t++)
+        pthread_join(tids[t], NULL);
+
+    // Each subtree holds whole medications, so per-thread distinct counts simply add up
+    for (int t = 0; t < threads; t++)
+    {
+        for (int id = 0; id < index->count; id++)
+        {
+            totals->turnover[id] += partials[t].turnover[id];
+            totals->med_count[id] += partials[t].med_count[id];
+        }
+        totals->links += partials[t].links;
+        freeSupplierTotals(&partials[t]);
+    }
+
+    free(partials);
+    free(tids);
+    free(workers);
+    free(level);
+    return SUCCESS;
+}
+
+// Counts suppliers under node whose incremental ranking scores disagree with totals.
+void auditSupplierNode(B_supp *node, const supplier_totals *totals, int *suppliers, int *mismatches)
+{
+    if (node == NULL)
+        return;
+    for (int i = 0; i <= node->num_keys; i++)
+    {
+        if (!node->is_leaf)
+            auditSupplierNode(node->children[i], totals, suppliers, mismatches);
+        if (i == node->num_keys)
+            break;
+
+        supplier *s = node->values[i];
+        int id = findSupplierIndex(totals->index, s->supplier_id);
+        (*suppliers)++;
+        if (id < 0 || supplierScore(s, RANK_BY_MEDS) != totals->med_count[id] ||
+            supplierScore(s, RANK_BY_TURNOVER) != totals->turnover[id])
+            (*mismatches)++;
+    }
+}
+
+#define BENCH_LINKS_PER_BATCH 32 // Suppliers linked to each batch of the analytics benchmark
+
+// Builds a synthetic inventory with about a million batch-supplier links and times the full
+// analytics pass for 1, 2, 4, ... max_threads threads.
+// Prints CSV: threads,links,seconds,links_per_sec,speedup
+int runAnalyticsBenchmark(int max_threads)
+{
+    if (buildBenchInventory(1, 4 * BENCH_MEDICATIONS) == FAILURE)
+        return 1;
+    supplier *suppliers[MAX_SUPPLIERS];
+    for (int id = 0; id < MAX_SUPPLIERS; id++)
+    {
+        suppliers[id] = createSupplier(&supplierTree, id, "BenchSupplier", 1 + id % 50, 9000000000LL + id);
+        if (!suppliers[id])
+        {
+            fprintf(stderr, "Memory allocation failed for benchmark suppliers.\n");
+            return 1;
+        }
+    }
+    for (int medID = 1; medID <= 4 * BENCH_MEDICATIONS; medID++)
+    {
+        data *med = search_medID(medIDTree, medID);
+        for (int b = 0; b < med->batch_count; b++)
+        {
+            for (int k = 0; k < BENCH_LINKS_PER_BATCH; k++)
+                linkSupplierToBatch(med, &med->Batch[b], suppliers[(medID * 7 + b * 31 + k * 13) % MAX_SUPPLIERS]);
+        }
+    }
+
+    supplier_index index = {NULL, NULL, 0, 0};
+    if (indexSupplierNode(supplierTree, &index) == FAILURE)
+    {
+        fprintf(stderr, "Memory allocation failed for analytics pass.\n");
+        freeSupplierIndex(&index);
+        return 1;
+    }
+    printf("threads,links,seconds,links_per_sec,speedup\n");
+    double base = 0;
+    for (int threads = 1;; threads *= 2)
+    {
+        if (threads > max_threads)
+            threads = max_threads;
+        supplier_totals totals = {NULL, NULL, NULL, NULL, 0};
+        long long start = now_ns();
+        if (computeSupplierTotals(threads, &index, &totals) == FAILURE)
+        {
+            fprintf(stderr, "Memory allocation failed for analytics pass.\n");
+            freeSupplierTotals(&totals);
+            freeSupplierIndex(&index);
+            return 1;
+        }
+        double seconds = (now_ns() - start) / 1e9;
+        double rate = totals.links / seconds;
+        if (threads == 1)
+            base = rate;
+        printf("%d,%lld,%.4f,%.0f,%.2f\n", threads, totals.links, seconds, rate, rate / base);
+        freeSupplierTotals(&totals);
+        if (threads == max_threads)
+            break;
+    }
+    freeSupplierIndex(&index);
+    return 0;
+}
+
+void topKlargestturnover(int k)
+{
+    if (!medIDTree) // Assuming this is the root of your B-tree for meds
+    {
+        printf("Medication tree is empty.\n");
+        return;
+    }
+
+    if (k <= 0)
+        return;
+    supplier **top = (supplier **)malloc(k * sizeof(supplier *));
+    if (!top)
+    {
+        printf("Memory allocation failed for top-K report.\n");
+        return;
+    }
+    int ranked = topKSuppliers(RANK_BY_TURNOVER, k, top);
+
+    printf("Top %d suppliers by turnover:\n", k);
+    int found = 0;
+    for (int i = 0; i < ranked; i++)
+    {
+        long long turnover = supplierScore(top[i], RANK_BY_TURNOVER);
+        if (turnover > 0)
+        {
+            printf("Supplier ID: %d, Turnover: %lld\n", top[i]->supplier_id, turnover);
+            found++;
+        }
+    }
+    free(top);
+
+    if (found == 0)
+    {
+        printf("No suppliers have non-zero turnover.\n");
+    }
+}
+
+void top10largestturnover()
+{
+    topKlargestturnover(10);
+}
+
+// Sums the supply edge table while no writer or sale can change it.
+status_code snapshotSupplyTotals(supply_totals *totals)
+{
+    readBegin();
+    pthread_mutex_lock(&supplier_lock);
+    status_code status = sumSupplyEdges(totals);
+    pthread_mutex_unlock(&supplier_lock);
+    readEnd();
+    return status;
+}
+
+void printSupplyReport()
+{
+    supply_totals totals;
+    if (snapshotSupplyTotals(&totals) == FAILURE)
+    {
+        printf("Memory allocation failed for supply report.\n");
+        return;
+    }
+
+    long long volume = 0, turnover = 0;
+    int links = 0;
+    printf("%-12s %8s %14s %16s\n", "Supplier", "Links", "Units", "Turnover");
+    for (int i = 0; i < totals.count; i++)
+    {
+        const supply_total *t = &totals.entries[i];
+        printf("%-12d %8d %14lld %16lld\n", t->supplier_id, t->links, t->volume, t->turnover);
+        links += t->links;
+        volume += t->volume;
+        turnover += t->turnover;
+    }
+    printf("%-12s %8d %14lld %16lld\n", "total", links, volume, turnover);
+    free(totals.entries);
+}
+
+void searchMedication()
+{
+    printf("Enter 1 to search by medID\nEnter 2 to search by medName\nEnter 3 to search by supplier\n");
+    int choice;
+    scanf("%d", &choice);
+    switch (choice)
+    {
+    case 1:
+    {
+        printf("Enter medication ID to search: ");
+        int medID;
+        scanf("%d", &medID);
+        recordWorkload("query,%d", medID);
+        searchMedicationBymedId(medID, medIDTree);
+        break;
+    }
+    case 2:
+    {
+        printf("Enter medication name to search: ");
+        char medName[MAX_NAME_LENGTH];
+        scanf("%s", medName);
+        recordWorkload("find,%s", medName);
+        searchMedicationBymedname(medName, mednameTree);
+        break;
+    }
+    case 3:
+    {
+        searchbysupplier();
+        break;
+    }
+    }
+}
+//==========SNAPSHOTS==========//
+
+// A snapshot is a point-in-time view of every medication and supplier for reports and saves
+// that take a while. Taking one holds the trees exclusively only to copy the flat arrays it
+// needs (the medication pointers of the batch columns and the supply edge columns) and the
+// supplier details, of which there are few. The sorted views are built after the lock is
+// released, inside a read section so that no record removed meanwhile is freed. Sales and
+// updates carry on against the live records: the first change to a record while a snapshot is
+// open saves a frozen copy of it into that snapshot (copy-on-write), so the snapshot keeps seeing
+// the record as it was. A copy holds only the record's live batches.
+
+typedef struct
+{
+    int medID;
+    data *live;
+    data *frozen; // Copy taken before the first change after the snapshot, NULL if unchanged
+} snapshot_entry;
+
+typedef struct
+{
+    supplier *live; // Key only; never dereferenced through the snapshot
+    int supplier_id;
+    char supp_name[MAX_NAME_LENGTH];
+    long long contact;
+} snapshot_supplier;
+
+typedef struct
+{
+    int batch_row;
+    int supplier_id;
+    int qty;
+    int price;
+} snapshot_edge;
+
+typedef struct snapshot_tag
+{
+    unsigned long long id;
+    snapshot_entry *records; // In medID order
+    int num_records;
+    Boolean listed;          // records is sorted; until then changed records go to early
+    snapshot_entry *early;   // Records changed while records was being sorted, with their copies
+    int num_early;
+    int early_capacity;
+    snapshot_supplier *suppliers; // Sorted by live pointer
+    int num_suppliers;
+    snapshot_edge *edges; // Sorted by batch row, then supplier ID
+    int num_edges;
+    struct snapshot_tag *next;
+} snapshot;
+
+snapshot *open_snapshots = NULL;         // Guarded by snapshot_lock
+pthread_mutex_t snapshot_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Copies the parts of med a report or save reads: header fields, rollups and live batches.
+// The copy is allocated only up to its last live batch.
+data *copyRecord(const data *med)
+{
+    data *copy = (data *)malloc(offsetof(data, Batch) + med->batch_count * sizeof(batch));
+    if (!copy)
+        return NULL;
+    copy->medID = med->medID;
+    memcpy(copy->medname, med->medname, MAX_NAME_LENGTH);
+    copy->batch_count = med->batch_count;
+    copy->reorder_lvl = med->reorder_lvl;
+    copy->priceperunit = med->priceperunit;
+    copy->units_sold = med->units_sold;
+    memcpy(copy->daily, med->daily, sizeof(med->daily));
+    memcpy(copy->weekly, med->weekly, sizeof(med->weekly));
+    for (int j = 0; j < med->batch_count; j++)
+    {
+        const batch *from = &med->Batch[j];
+        batch *to = &copy->Batch[j];
+        to->batch_no = from->batch_no;
+        to->qty_instock = from->qty_instock;
+        to->col_row = from->col_row;
+        memcpy(to->exp_date, from->exp_date, MAX_DATE_LENGTH);
+        to->supplier_count = from->supplier_count;
+        memcpy(to->suppliers, from->suppliers, from->supplier_count * sizeof(supplier *));
+    }
+    return copy;
+}
+
+// Must be called before med changes. Caller holds med->lock or the trees exclusively.
+void preserveRecord(data *med)
+{
+    if (__atomic_load_n(&latest_snapshot_id, __ATOMIC_ACQUIRE) <= med->cow_version)
+        return;
+
+    pthread_mutex_lock(&snapshot_lock);
+    for (snapshot *snap = open_snapshots; snap; snap = snap->next)
+    {
+        if (snap->id <= med->cow_version)
+            continue;
+        if (!snap->listed)
+        {
+            if (snap->num_early == snap->early_capacity)
+            {
+                int capacity = snap->early_capacity ? snap->early_capacity * 2 : 64;
+                snapshot_entry *grown = (snapshot_entry *)realloc(snap->early, capacity * sizeof(snapshot_entry));
+                if (!grown)
+                    continue;
+                snap->early = grown;
+                snap->early_capacity = capacity;
+            }
+            snapshot_entry *entry = &snap->early[snap->num_early];
+            entry->medID = med->medID;
+            entry->live = med;
+            entry->frozen = copyRecord(med);
+            if (entry->frozen)
+                snap->num_early++;
+            continue;
+        }
+        int lo = 0, hi = snap->num_records - 1;
+        while (lo <= hi)
+        {
+            int mid = (lo + hi) / 2;
+            if (snap->records[mid].medID < med->medID)
+                lo = mid + 1;
+            else if (snap->records[mid].medID > med->medID)
+                hi = mid - 1;
+            else
+            {
+                if (snap->records[mid].live == med && snap->records[mid].frozen == NULL)
+                    __atomic_store_n(&snap->records[mid].frozen, copyRecord(med), __ATOMIC_RELEASE);
+                break;
+            }
+        }
+    }
+    med->cow_version = latest_snapshot_id;
+    pthread_mutex_unlock(&snapshot_lock);
+}
+
+int compareSnapshotEntries(const void *a, const void *b)
+{
+    int x = ((const snapshot_entry *)a)->medID;
+    int y = ((const snapshot_entry *)b)->medID;
+    return x < y ? -1 : x > y;
+}
+
+void collectSnapshotSuppliers(B_supp *node, snapshot_supplier *suppliers, int *count)
+{
+    if (node == NULL)
+        return;
+    for (int i = 0; i <= node->num_keys; i++)
+    {
+        if (!node->is_leaf)
+            collectSnapshotSuppliers(node->children[i], suppliers, count);
+        if (i < node->num_keys)
+        {
+            supplier *s = node->values[i];
+            snapshot_supplier *copy = &suppliers[(*count)++];
+            copy->live = s;
+            copy->supplier_id = s->supplier_id;
+            memcpy(copy->supp_name, s->supp_name, MAX_NAME_LENGTH);
+            copy->contact = s->contact;
+        }
+    }
+}
+
+int compareSnapshotSuppliers(const void *a, const void *b)
+{
+    uintptr_t x = (uintptr_t)((const snapshot_supplier *)a)->live;
+    uintptr_t y = (uintptr_t)((const snapshot_supplier *)b)->live;
+    return x < y ? -1 : x > y;
+}
+
+int compareSnapshotEdges(const void *a, const void *b)
+{
+    const snapshot_edge *x = (const snapshot_edge *)a;
+    const snapshot_edge *y = (const snapshot_edge *)b;
+    if (x->batch_row != y->batch_row)
+        return x->batch_row < y->batch_row ? -1 : 1;
+    return x->supplier_id < y->supplier_id ? -1 : x->supplier_id > y->supplier_id;
+}
+
+// Gives the entry for medID in a listed snapshot, or NULL.
+snapshot_entry *findSnapshotEntry(snapshot *snap, int medID)
+{
+    snapshot_entry key;
+    key.medID = medID;
+    return (snapshot_entry *)bsearch(&key, snap->records, snap->num_records, sizeof(snapshot_entry),
+                                     compareSnapshotEntries);
+}
+
+void freeSnapshotParts(snapshot *snap)
+{
+    free(snap->records);
+    free(snap->early);
+    free(snap->suppliers);
+    free(snap->edges);
+    free(snap);
+}
+
+// Returns a new snapshot of the whole inventory, or NULL if memory runs out.
+snapshot *takeSnapshot()
+{
+    snapshot *snap = (snapshot *)calloc(1, sizeof(snapshot));
+    if (!snap)
+        return NULL;
+
+    // Under the lock: flat copies only
+    writeBegin();
+    int slots = columns.slots;
+    int edge_rows = supply_edges.rows;
+    int max_suppliers = supplierTree ? supplierTree->subtree_size : 0;
+    data **meds = (data **)malloc((slots + 1) * sizeof(data *));
+    int *edge_columns = (int *)malloc(4 * ((size_t)edge_rows + 1) * sizeof(int));
+    snap->records = (snapshot_entry *)malloc((slots + 1) * sizeof(snapshot_entry));
+    snap->suppliers = (snapshot_supplier *)malloc((max_suppliers + 1) * sizeof(snapshot_supplier));
+    snap->edges = (snapshot_edge *)malloc((edge_rows + 1) * sizeof(snapshot_edge));
+    if (!meds || !edge_columns || !snap->records || !snap->suppliers || !snap->edges)
+    {
+        writeEnd();
+        free(meds);
+        free(edge_columns);
+        freeSnapshotParts(snap);
+        return NULL;
+    }
+    int *edge_supplier = edge_columns, *edge_batch = edge_columns + edge_rows;
+    int *edge_qty = edge_batch + edge_rows, *edge_price = edge_qty + edge_rows;
+    memcpy(meds, columns.meds, slots * sizeof(data *));
+    memcpy(edge_supplier, supply_edges.supplier, edge_rows * sizeof(int));
+    memcpy(edge_batch, supply_edges.batch, edge_rows * sizeof(int));
+    memcpy(edge_qty, supply_edges.qty, edge_rows * sizeof(int));
+    memcpy(edge_price, supply_edges.price, edge_rows * sizeof(int));
+    collectSnapshotSuppliers(supplierTree, snap->suppliers, &snap->num_suppliers);
+
+    pthread_mutex_lock(&snapshot_lock);
+    snap->id = latest_snapshot_id + 1;
+    snap->next = open_snapshots;
+    open_snapshots = snap;
+    __atomic_store_n(&latest_snapshot_id, snap->id, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&snapshot_lock);
+    readBegin(); // Records removed from here on stay allocated until the listing is done
+    writeEnd();
+
+    // Outside the lock: build the sorted views. A record's medID never changes.
+    for (int slot = 0; slot < slots; slot++)
+    {
+        if (meds[slot] == NULL)
+            continue;
+        snapshot_entry *entry = &snap->records[snap->num_records++];
+        entry->medID = meds[slot]->medID;
+        entry->live = meds[slot];
+        entry->frozen = NULL;
+    }
+    qsort(snap->records, snap->num_records, sizeof(snapshot_entry), compareSnapshotEntries);
+    for (int row = 0; row < edge_rows; row++)
+    {
+        if (edge_batch[row] < 0)
+            continue;
+        snapshot_edge *copy = &snap->edges[snap->num_edges++];
+        copy->batch_row = edge_batch[row];
+        copy->supplier_id = edge_supplier[row];
+        copy->qty = edge_qty[row];
+        copy->price = edge_price[row];
+    }
+    qsort(snap->edges, snap->num_edges, sizeof(snapshot_edge), compareSnapshotEdges);
+    qsort(snap->suppliers, snap->num_suppliers, sizeof(snapshot_supplier), compareSnapshotSuppliers);
+    free(meds);
+    free(edge_columns);
+
+    // Hand the copies made while sorting to their entries; from now on preserveRecord finds them
+    pthread_mutex_lock(&snapshot_lock);
+    for (int i = 0; i < snap->num_early; i++)
+    {
+        snapshot_entry *entry = findSnapshotEntry(snap, snap->early[i].medID);
+        if (entry && entry->live == snap->early[i].live && entry->frozen == NULL)
+            entry->frozen = snap->early[i].frozen;
+        else
+            free(snap->early[i].frozen);
+    }
+    free(snap->early);
+    snap->early = NULL;
+    snap->num_early = snap->early_capacity = 0;
+    snap->listed = true;
+    pthread_mutex_unlock(&snapshot_lock);
+    readEnd();
+    return snap;
+}
+
+void releaseSnapshot(snapshot *snap)
+{
+    pthread_mutex_lock(&snapshot_lock);
+    for (snapshot **link = &open_snapshots; *link; link = &(*link)->next)
+    {
+        if (*link == snap)
+        {
+            *link = snap->next;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&snapshot_lock);
+
+    for (int i = 0; i < snap->num_records; i++)
+        free(snap->records[i].frozen);
+    freeSnapshotParts(snap);
+}
+
+// Details of a supplier as they were when the snapshot was taken, or NULL if it did not exist.
+const snapshot_supplier *snapshotSupplier(snapshot *snap, supplier *live)
+{
+    snapshot_supplier key;
+    key.live = live;
+    return (const snapshot_supplier *)bsearch(&key, snap->suppliers, snap->num_suppliers,
+                                              sizeof(snapshot_supplier), compareSnapshotSuppliers);
+}
+
+// Supply of a supplier to the batch in the given batch row when the snapshot was taken, or NULL
+// if it was not linked.
+const snapshot_edge *snapshotEdge(snapshot *snap, int batch_row, int supplier_id)
+{
+    snapshot_edge key;
+    key.batch_row = batch_row;
+    key.supplier_id = supplier_id;
+    return (const snapshot_edge *)bsearch(&key, snap->edges, snap->num_edges, sizeof(snapshot_edge),
+                                          compareSnapshotEdges);
+}
+
+// Calls visit on every record of the snapshot in medID order. An unchanged record is read in
+// place while its lock is held, so a sale on it waits until visit returns.
+void snapshotForEach(snapshot *snap, void (*visit)(const data *med, snapshot *snap, void *ctx), void *ctx)
+{
+    Boolean exclusive = write_depth > 0; // This thread is the writer; nothing can change under it
+    for (int i = 0; i < snap->num_records; i++)
+    {
+        snapshot_entry *entry = &snap->records[i];
+        data *frozen = __atomic_load_n(&entry->frozen, __ATOMIC_ACQUIRE);
+        if (frozen || exclusive)
+        {
+            visit(frozen ? frozen : entry->live, snap, ctx);
+            continue;
+        }
+
+        // Removing a record needs the trees exclusively, so the live record stays valid here
+        pthread_rwlock_rdlock(&index_lock);
+        frozen = __atomic_load_n(&entry->frozen, __ATOMIC_ACQUIRE);
+        if (frozen)
+        {
+            pthread_rwlock_unlock(&index_lock);
+            visit(frozen, snap, ctx);
+            continue;
+        }
+        pthread_mutex_lock(&entry->live->lock);
+        frozen = __atomic_load_n(&entry->frozen, __ATOMIC_ACQUIRE);
+        visit(frozen ? frozen : entry->live, snap, ctx);
+        pthread_mutex_unlock(&entry->live->lock);
+        pthread_rwlock_unlock(&index_lock);
+    }
+}
+
+// Writes one record in the data file format.
+void writeSnapshotRecord(const data *med, snapshot *snap, void *ctx)
+{
+    FILE *fp = (FILE *)ctx;
+    fprintf(fp, "%d,%s,%d,%d\n", med->medID, med->medname, med->priceperunit, med->reorder_lvl);
+
+    for (int j = 0; j < med->batch_count; j++)
+    {
+        const batch *b = &med->Batch[j];
+
+        // Convert expiry date format before writing
+        char reversed_date[MAX_DATE_LENGTH];
+        reverse_date_format(b->exp_date, reversed_date);
+
+        fprintf(fp, "%d,%s,%d\n", b->batch_no, reversed_date, b->qty_instock);
+
+        for (int k = 0; k < b->supplier_count; k++)
+        {
+            const snapshot_supplier *s = snapshotSupplier(snap, b->suppliers[k]);
+            const snapshot_edge *e = s ? snapshotEdge(snap, b->col_row, s->supplier_id) : NULL;
+            if (e)
+                fprintf(fp, "%d,%s,%d,%lld,%d\n", s->supplier_id, s->supp_name, e->qty, s->contact, e->price);
+        }
+
+        fprintf(fp, "###\n"); // Separate batches
+    }
+
+    fprintf(fp, "END\n"); // End of medication
+}
+
+// One row of the expiry report
+typedef struct
+{
+    char exp_date[MAX_DATE_LENGTH];
+    int medID;
+    char medname[MAX_NAME_LENGTH];
+    int batch_no;
+    int qty_instock;
+} expiring_batch;
+
+typedef struct
+{
+    char from[MAX_DATE_LENGTH]; // YYYY-MM-DD, inclusive
+    char to[MAX_DATE_LENGTH];
+    expiring_batch *rows;
+    int count;
+    int capacity;
+} expiry_report;
+
+// Collects the record's batches that expire inside the report's range.
+void collectExpiringBatches(const data *med, snapshot *snap, void *ctx)
+{
+    (void)snap;
+    expiry_report *report = (expiry_report *)ctx;
+    for (int j = 0; j < med->batch_count; j++)
+    {
+        const batch *b = &med->Batch[j];
+        if (strcmp(b->exp_date, report->from) < 0 || strcmp(b->exp_date, report->to) > 0)
+            continue;
+        if (report->count == report->capacity)
+        {
+            int new_capacity = report->capacity ? report->capacity * 2 : 64;
+            expiring_batch *grown = (expiring_batch *)realloc(report->rows, new_capacity * sizeof(expiring_batch));
+            if (!grown)
+                return;
+            report->rows = grown;
+            report->capacity = new_capacity;
+        }
+        expiring_batch *row = &report->rows[report->count++];
+        memcpy(row->exp_date, b->exp_date, MAX_DATE_LENGTH);
+        row->medID = med->medID;
+        memcpy(row->medname, med->medname, MAX_NAME_LENGTH);
+        row->batch_no = b->batch_no;
+        row->qty_instock = b->qty_instock;
+    }
+}
+
+int compareExpiringBatches(const void *a, const void *b)
+{
+    const expiring_batch *x = (const expiring_batch *)a;
+    const expiring_batch *y = (const expiring_batch *)b;
+    int cmp = strcmp(x->exp_date, y->exp_date);
+    if (cmp != 0)
+        return cmp;
+    if (x->medID != y->medID)
+        return x->medID < y->medID ? -1 : 1;
+    return x->batch_no - y->batch_no;
+}
+
+// Returns the batches expiring between from and to (YYYY-MM-DD, inclusive) as of one point in
+// time, ordered by expiry date, in a malloc'd array the caller frees. *count is -1 on failure.
+expiring_batch *expiringBatchesReport(const char *from, const char *to, int *count)
+{
+    expiry_report report;
+    memset(&report, 0, sizeof(report));
+    memcpy(report.from, from, MAX_DATE_LENGTH);
+    memcpy(report.to, to, MAX_DATE_LENGTH);
+
+    snapshot *snap = takeSnapshot();
+    if (!snap)
+    {
+        *count = -1;
+        return NULL;
+    }
+    snapshotForEach(snap, collectExpiringBatches, &report);
+    releaseSnapshot(snap);
+
+    long long start = opBegin();
+    qsort(report.rows, report.count, sizeof(expiring_batch), compareExpiringBatches);
+    opEnd(PHASE_BATCH_SORT, start, false);
+    *count = report.count;
+    return report.rows;
+}
+
+pthread_mutex_t save_lock = PTHREAD_MUTEX_INITIALIZER; // One save writes the data file at a time
+const char *data_file = "medications_data.txt";         // Where the inventory is loaded from and saved to
+
+// Writes a point-in-time snapshot of the inventory; sales may continue while it is written.
+status_code saveMedicationsToFile(void)
+{
+    pthread_mutex_lock(&save_lock);
+    long long start = opBegin();
+    FILE *fp = fopen(data_file, "w");
+    snapshot *snap = fp ? takeSnapshot() : NULL;
+    if (!snap)
+    {
+        if (fp)
+            fclose(fp);
+        opEnd(PHASE_SAVE, start, true);
+        pthread_mutex_unlock(&save_lock);
+        if (!quiet)
+            printf("Error opening file for writing.\n");
+        return FAILURE;
+    }
+
+    snapshotForEach(snap, writeSnapshotRecord, fp);
+    releaseSnapshot(snap);
+    Boolean failed = fclose(fp) != 0;
+    flushSalesLedger();
+    opEnd(PHASE_SAVE, start, failed);
+    pthread_mutex_unlock(&save_lock);
+    if (!quiet)
+        printf(failed ? "Error writing medication data.\n" : "Medication data successfully saved to file.\n");
+    return failed ? FAILURE : SUCCESS;
+}
+void loadMedicationsFromFile()
+{
+    long long start = opBegin();
+    FILE *fp = fopen(data_file, "r");
+    if (!fp)
+    {
+        if (!quiet)
+            printf("No previous medication data found.\n");
+        return;
+    }
+
+    char line[256];
+    data *currentMed = NULL;
+    batch *currentBatch = NULL;
+
+    while (fgets(line, sizeof(line), fp))
+    {
+        if (strncmp(line, "END", 3) == 0)
+        {
+            currentMed = NULL;
+            currentBatch = NULL;
+            continue;
+        }
+
+        if (strncmp(line, "###", 3) == 0)
+        {
+            currentBatch = NULL;
+            continue;
+        }
+        if (line[0] == '#') // Comment, as in the purge archive
+            continue;
+
+        if (currentMed == NULL)
+        {
+            // Medication line
+            int medID, priceperunit, reorder_lvl;
+            char medname[MAX_NAME_LENGTH];
+            sscanf(line, "%d,%[^,],%d,%d", &medID, medname, &priceperunit, &reorder_lvl);
+
+            currentMed = findOrCreateMedication(&medIDTree, &mednameTree, medID, medname, priceperunit, reorder_lvl);
+            if (!currentMed)
+                break;
+        }
+        else if (currentBatch == NULL)
+        {
+            // Batch line
+            int batch_no, qty_instock;
+            char exp_date[MAX_DATE_LENGTH];
+            sscanf(line, "%d,%[^,],%d", &batch_no, exp_date, &qty_instock);
+
+            if (currentMed->batch_count >= MAX_BATCHES)
+                continue;
+
+            // Convert date format before storing and indexing
+            char formatted_date[MAX_DATE_LENGTH];
+            convert_date_format(exp_date, formatted_date);
+            currentBatch = addBatchToMedication(&expDateTree, currentMed, batch_no, qty_instock, formatted_date);
+        }
+        else
+        {
+            // Supplier line: the units this supplier delivered to the batch and, in files saved
+            // since prices were kept per delivery, the unit price they were received at
+            int supplier_id, qty_supplied, price = currentMed->priceperunit;
+            long long contact;
+            char supp_name[MAX_NAME_LENGTH];
+            sscanf(line, "%d,%[^,],%d,%lld,%d", &supplier_id, supp_name, &qty_supplied, &contact, &price);
+
+            // A new supplier's usual delivery is taken from its first line
+            supplier *s = search_supplier(supplierTree, supplier_id);
+            if (!s)
+            {
+                s = createSupplier(&supplierTree, supplier_id, supp_name, qty_supplied, contact);
+                if (!s)
+                    continue;
+            }
+
+            // Link supplier to current batch (and the medication to the supplier). A supplier
+            // listed twice on a batch is linked once; any other failure loses a link, so say so.
+            if (linkSupplierWithSupply(currentMed, currentBatch, s, qty_supplied, price) == FAILURE &&
+                !batchHasSupplier(currentBatch, s))
+                fprintf(stderr, "Could not link supplier %d to batch %d of medication %d.\n", supplier_id,
+                        currentBatch->batch_no, currentMed->medID);
+        }
+    }
+
+    fclose(fp);
+    rebuildPackedIndex();
+    opEnd(PHASE_LOAD, start, false);
+    if (!quiet)
+        printf("Medication data successfully loaded from file.\n");
+}
+
+//==========EXPIRED STOCK PURGE==========//
+
+// Drops every batch that expired before a cutoff date, and every medication left without
+// batches, in one pass under a single write section. The expired rows come from the batch
+// columns, the affected medications are trimmed in place, and the index trees that changed are
+// then built again bottom-up from their sorted entries instead of taking one delete per entry.
+// What was removed is appended to the archive file in the data file format, one record per purge.
+
+#define PURGE_ARCHIVE_FILE "expired_archive.txt"
+
+const char *archive_file = PURGE_ARCHIVE_FILE; // NULL skips the archive (replays)
+
+typedef struct
+{
+    int batches;     // Expired batches removed
+    int medications; // Medications removed because their last batch went
+    long long units; // Units in stock across the removed batches
+} purge_totals;
+
+// One (key, record) entry of a string-keyed tree
+typedef struct
+{
+    char *key;
+    data *value;
+} tree_entry;
+
+int compareTreeEntries(const void *a, const void *b)
+{
+    const tree_entry *x = (const tree_entry *)a, *y = (const tree_entry *)b;
+    return compareEntryStr(x->key, x->value, y->key, y->value);
+}
+
+int compareMedicationsByID(const void *a, const void *b)
+{
+    int x = (*(data *const *)a)->medID, y = (*(data *const *)b)->medID;
+    return (x > y) - (x < y);
+}
+
+// Smallest height at which a tree of the given order holds n keys
+int bulkTreeHeight(int order, int n)
+{
+    int height = 1;
+    long long full = order - 1; // Keys of a full tree of this height
+    while (full < n)
+    {
+        full = full * order + order - 1;
+        height++;
+    }
+    return height;
+}
+
+// Keys of a full tree of the given order and height
+long long fullTreeKeys(int order, int height)
+{
+    long long full = 0;
+    for (int h = 0; h < height; h++)
+        full = full * order + order - 1;
+    return full;
+}
+
+// Builds a tree of exactly the given height over meds[0..n), which are sorted by medID. Each
+// node gets the fewest children that can hold its keys and the keys are spread evenly between
+// them, so the children are built first and every non-root node stays at least half full.
+B *bulkBuildInt(data **meds, int n, int height)
+{
+    B *node = create_node();
+    if (height == 1)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            node->keys[i] = meds[i]->medID;
+            node->values[i] = meds[i];
+        }
+        node->num_keys = n;
+        node->subtree_size = n;
+        return node;
+    }
+
+    long long child_keys = fullTreeKeys(INT_ORDER, height - 1);
+    int children = (int)((n + child_keys + 1) / (child_keys + 1));
+    int rest = n - (children - 1), pos = 0;
+    node->is_leaf = 0;
+    for (int c = 0; c < children; c++)
+    {
+        int size = rest / children + (c < rest % children);
+        node->children[c] = bulkBuildInt(meds + pos, size, height - 1);
+        pos += size;
+        if (c < children - 1)
+        {
+            node->keys[c] = meds[pos]->medID;
+            node->values[c] = meds[pos];
+            pos++;
+        }
+    }
+    node->num_keys = children - 1;
+    recount_node(node);
+    return node;
+}
+
+// The same for a string-keyed tree over entries[0..n), sorted by compareTreeEntries.
+B_str *bulkBuildStr(const tree_entry *entries, int n, int height)
+{
+    B_str *node = create_node_str();
+    if (height == 1)
+    {
+        for (int i = 0; i < n; i++)
+        {
+            node->keys[i] = strdup(entries[i].key);
+            node->values[i] = entries[i].value;
+        }
+        node->num_keys = n;
+        node->subtree_size = n;
+        return node;
+    }
+
+    long long child_keys = fullTreeKeys(ORDER, height - 1);
+    int children = (int)((n + child_keys + 1) / (child_keys + 1));
+    int rest = n - (children - 1), pos = 0;
+    node->is_leaf = 0;
+    for (int c = 0; c < children; c++)
+    {
+        int size = rest / children + (c < rest % children);
+        node->children[c] = bulkBuildStr(entries + pos, size, height - 1);
+        pos += size;
+        if (c < children - 1)
+        {
+            node->keys[c] = strdup(entries[pos].key);
+            node->values[c] = entries[pos].value;
+            pos++;
+        }
+    }
+    node->num_keys = children - 1;
+    recount_node_str(node);
+    return node;
+}
+
+// Retires every node of a replaced tree, and the string keys it owns. Writers only.
+void retireTreeInt(B *node)
+{
+    if (node == NULL)
+        return;
+    if (!node->is_leaf)
+    {
+        for (int i = 0; i <= node->num_keys; i++)
+            retireTreeInt(node->children[i]);
+    }
+    retireFree(node);
+}
+
+void retireTreeStr(B_str *node)
+{
+    if (node == NULL)
+        return;
+    for (int i = 0; i < node->num_keys; i++)
+        retireFree(node->keys[i]);
+    if (!node->is_leaf)
+    {
+        for (int i = 0; i <= node->num_keys; i++)
+            retireTreeStr(node->children[i]);
+    }
+    retireFree(node);
+}
+
+// Writes the batches of med that expire before cutoff (YYYY-MM-DD) as one data file record.
+void archiveExpiredBatches(FILE *fp, const data *med, const char *cutoff)
+{
+    fprintf(fp, "%d,%s,%d,%d\n", med->medID, med->medname, med->priceperunit, med->reorder_lvl);
+    for (int j = 0; j < med->batch_count; j++)
+    {
+        const batch *b = &med->Batch[j];
+        if (strcmp(b->exp_date, cutoff) >= 0)
+            continue;
+
+        char reversed_date[MAX_DATE_LENGTH];
+        reverse_date_format(b->exp_date, reversed_date);
+        fprintf(fp, "%d,%s,%d\n", b->batch_no, reversed_date, b->qty_instock);
+        for (int k = 0; k < b->supplier_count; k++)
+        {
+            supplier *s = b->suppliers[k];
+            const supplier_link *link = s ? findSupplierLink(s, med, j) : NULL;
+            if (link)
+                fprintf(fp, "%d,%s,%d,%lld,%d\n", s->supplier_id, s->supp_name, supply_edges.qty[link->edge],
+                        s->contact, supply_edges.price[link->edge]);
+        }
+        fprintf(fp, "###\n");
+    }
+    fprintf(fp, "END\n");
+}
+
+// Removes every batch expiring before cutoff (YYYY-MM-DD) and every medication this empties,
+// rebuilds the expiry tree (and the ID and name trees if medications went) and appends what was
+// removed to archive_file. Fails without changing anything if memory or the archive is missing.
+status_code purgeExpiredStock(const char *cutoff, purge_totals *totals)
+{
+    memset(totals, 0, sizeof(*totals));
+    writeBegin();
+
+    int count;
+    int *rows = expiringRows(dateToDay(cutoff) - 1, &count);
+    if (!rows)
+    {
+        writeEnd();
+        return FAILURE;
+    }
+    if (count == 0)
+    {
+        free(rows);
+        writeEnd();
+        return SUCCESS;
+    }
+
+    // Everything the rebuild needs is allocated before the first change
+    int live_rows = columns.rows - columns.free_row_count;
+    int live_meds = columns.slots - columns.free_slot_count;
+    int *expired = (int *)calloc(columns.slots ? columns.slots : 1, sizeof(int)); // Expired batches per slot
+    data **affected = (data **)malloc(count * sizeof(data *));
+    data **meds = (data **)malloc((live_meds ? live_meds : 1) * sizeof(data *));
+    tree_entry *entries = (tree_entry *)malloc((live_rows > live_meds ? live_rows : live_meds) * sizeof(tree_entry));
+    FILE *fp = archive_file ? fopen(archive_file, "a") : NULL;
+    if (!expired || !affected || !meds || !entries || (archive_file && !fp))
+    {
+        free(rows);
+        free(expired);
+        free(affected);
+        free(meds);
+        free(entries);
+        if (fp)
+            fclose(fp);
+        writeEnd();
+        return FAILURE;
+    }
+
+    int num_affected = 0;
+    for (int i = 0; i < count; i++)
+    {
+        int slot = columns.med[rows[i]];
+        totals->units += columns.qty[rows[i]];
+        if (expired[slot]++ == 0)
+            affected[num_affected++] = columns.meds[slot];
+    }
+    for (int i = 0; i < num_affected; i++)
+        totals->medications += expired[affected[i]->col_slot] == affected[i]->batch_count;
+    totals->batches = count;
+    free(rows);
+    free(expired);
+    qsort(affected, num_affected, sizeof(data *), compareMedicationsByID);
+
+    if (fp)
+    {
+        char reversed_cutoff[MAX_DATE_LENGTH];
+        reverse_date_format(cutoff, reversed_cutoff);
+        fprintf(fp, "# Purged %d batches (%lld units) expired before %s and %d emptied medications at %lld\n",
+                totals->batches, totals->units, reversed_cutoff, totals->medications, (long long)time(NULL));
+    }
+
+    int emptied = 0;
+    for (int i = 0; i < num_affected; i++)
+    {
+        data *med = affected[i];
+        preserveRecord(med);
+        if (fp)
+            archiveExpiredBatches(fp, med, cutoff);
+
+        // Removing a batch moves the last one into its place, so walk backwards
+        for (int j = med->batch_count - 1; j >= 0; j--)
+        {
+            if (strcmp(med->Batch[j].exp_date, cutoff) < 0)
+            {
+                unlinkBatchSuppliers(med, &med->Batch[j]);
+                removeBatchAt(med, j);
+            }
+        }
+        if (med->batch_count == 0)
+        {
+            columnsRemoveMedication(med);
+            affected[emptied++] = med;
+        }
+    }
+    if (fp)
+        fclose(fp);
+
+    // Every remaining batch, sorted, becomes the new expiry tree
+    int n = 0, m = 0;
+    for (int slot = 0; slot < columns.slots; slot++)
+    {
+        data *med = columns.meds[slot];
+        if (med == NULL)
+            continue;
+        meds[m++] = med;
+        for (int j = 0; j < med->batch_count; j++)
+        {
+            entries[n].key = med->Batch[j].exp_date;
+            entries[n++].value = med;
+        }
+    }
+    qsort(entries, n, sizeof(tree_entry), compareTreeEntries);
+    retireTreeStr(expDateTree);
+    expDateTree = n ? bulkBuildStr(entries, n, bulkTreeHeight(ORDER, n)) : NULL;
+
+    if (emptied > 0)
+    {
+        qsort(meds, m, sizeof(data *), compareMedicationsByID);
+        retireTreeInt(medIDTree);
+        medIDTree = m ? bulkBuildInt(meds, m, bulkTreeHeight(INT_ORDER, m)) : NULL;
+
+        for (int i = 0; i < m; i++)
+        {
+            entries[i].key = meds[i]->medname;
+            entries[i].value = meds[i];
+        }
+        qsort(entries, m, sizeof(tree_entry), compareTreeEntries);
+        retireTreeStr(mednameTree);
+        mednameTree = m ? bulkBuildStr(entries, m, bulkTreeHeight(ORDER, m)) : NULL;
+
+        for (int i = 0; i < emptied; i++)
+            retireMemory(affected[i], releaseMedication);
+    }
+
+    free(affected);
+    free(meds);
+    free(entries);
+    writeEnd();
+    return SUCCESS;
+}
+
+void purgeMenu()
+{
+    char date[MAX_DATE_LENGTH], cutoff[MAX_DATE_LENGTH];
+    printf("Remove batches that expired before (DD-MM-YYYY): ");
+    scanf(" %10s", date);
+    recordWorkload("purge,%s", date);
+    convert_date_format(date, cutoff);
+
+    long long start = opBegin();
+    purge_totals totals;
+    status_code status = purgeExpiredStock(cutoff, &totals);
+    opEnd(OP_PURGE, start, status == FAILURE);
+    if (status == FAILURE)
+    {
+        printf("Purge failed: out of memory or %s is not writable. Nothing was removed.\n", PURGE_ARCHIVE_FILE);
+        return;
+    }
+    if (totals.batches == 0)
+    {
+        printf("No batches expired before %s.\n", date);
+        return;
+    }
+    printf("Removed %d batches (%lld units) expired before %s, and %d medications left without batches.\n",
+           totals.batches, totals.units, date, totals.medications);
+    printf("The removed stock was archived to %s.\n", PURGE_ARCHIVE_FILE);
+    recordWorkload("save");
+    if (saveMedicationsToFile() == FAILURE)
+        printf("Purge not saved: %s still lists the removed batches.\n", data_file);
+}
+
+//==========BATCH MODE==========//
+
+// Batch mode applies a stream of comma-separated commands without the menu and saves once at
+// the end (and every checkpoint_every mutations, if set). Dates use DD-MM-YYYY like the data file.
+//
+//   add,medID,name,batch_no,price,qty,exp_date,reorder_lvl,supplier_id[,supp_name,qty_of_supply,contact]
+//   update,medID,price,batch_no,qty       (-1 leaves the price / batch quantity unchanged)
+//   sell,medID,qty
+//   delete,medID,batch_no                 (batch_no -1 deletes the whole medication)
+//   query,medID
+//   find,medname
+//   top,meds|turnover,k
+//   page,expiry|name,page,page_size       (pages are 1-based)
+//   rank,expiry|name,key                  (entries sorting before key, out of the total)
+//   alerts                                (medications at or below their reorder level)
+//   due,date                              (batches expired or expiring within 30 days of date)
+//   purge,date                            (removes batches expired before date; archived to
+//                                          expired_archive.txt)
+//   link,medID,batch_no,supplier_id[,supp_name,qty_of_supply,contact]
+//   dropsupplier,supplier_id
+//   editsupplier,supplier_id,qty_of_supply,contact  (-1 leaves a field unchanged)
+//   supplier,supplier_id
+//   supply                                (per supplier: links, units supplied and turnover at
+//                                          the prices received, then the totals and pass time)
+//   latency                               (per-sale latency percentiles in ns)
+//   treestats                             (per tree: height, nodes, keys, expected keys, fill,
+//                                          duplicates, bad values, violations, keys per level)
+//   memory                                (bytes, used and reserved slots per structure)
+//   stats[,file]                          (per-operation counts and latency percentiles in ns,
+//                                          or the same CSV written to file)
+//   save
+//
+// Every command produces one or more result lines on stdout:
+//   ok,<line>,<command>[,fields...]
+//   error,<line>,<command>,<reason>
+// followed by a final "summary,<commands>,<ok>,<errors>,<saves>" line.
+
+#define MAX_BATCH_LINE 512
+#define MAX_BATCH_FIELDS 16
+
+__thread FILE *reply_out = NULL; // Where batch command replies go; stdout when NULL
+
+void replyf(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vfprintf(reply_out ? reply_out : stdout, format, args);
+    va_end(args);
+}
+
+// Splits line in place at commas, stripping the trailing newline. Returns the number of fields.
+int splitFields(char *line, char *fields[], int max_fields)
+{
+    line[strcspn(line, "\r\n")] = '\0';
+    int count = 0;
+    char *start = line;
+    while (count < max_fields)
+    {
+        fields[count++] = start;
+        char *comma = strchr(start, ',');
+        if (!comma)
+            break;
+        *comma = '\0';
+        start = comma + 1;
+    }
+    return count;
+}
+
+// Parses a whole-field integer; returns 0 if the field is not a number.
+int parseIntField(const char *field, long long *out)
+{
+    char *end;
+    if (*field == '\0')
+        return 0;
+    *out = strtoll(field, &end, 10);
+    return *end == '\0';
+}
+
+// Converts a DD-MM-YYYY field to the internal YYYY-MM-DD form; returns 0 if it is malformed.
+int parseDateField(const char *field, char *out)
+{
+    int day, month, year;
+    char extra;
+    if (strlen(field) != 10 || sscanf(field, "%d-%d-%d%c", &day, &month, &year, &extra) != 3)
+        return 0;
+    if (day < 1 || day > 31 || month < 1 || month > 12)
+        return 0;
+    convert_date_format(field, out);
+    return 1;
+}
+
+void printMedicationRow(int line_no, const char *command, data *med)
+{
+    int stock = 0;
+    for (int j = 0; j < med->batch_count; j++)
+        stock += med->Batch[j].qty_instock;
+    replyf("ok,%d,%s,%d,%s,%d,%d,%d,%d\n", line_no, command, med->medID, med->medname,
+           med->priceperunit, med->reorder_lvl, med->batch_count, stock);
+}
+
+data *search_medname(B_str *root, const char *medname)
+{
+    while (root != NULL)
+    {
+        int i = 0;
+        while (i < root->num_keys && strcmp(medname, root->keys[i]) > 0)
+            i++;
+        if (i < root->num_keys && strcmp(medname, root->keys[i]) == 0)
+            return root->values[i];
+        if (root->is_leaf)
+            return NULL;
+        root = root->children[i];
+    }
+    return NULL;
+}
+
+// Executes one batch command. Returns SUCCESS if it was applied; *mutated is set when the
+// inventory changed and must eventually be persisted.
+status_code applyBatchCommand(int line_no, char *fields[], int num_fields, Boolean *mutated)
+{
+    const char *command = fields[0];
+    long long v[MAX_BATCH_FIELDS] = {0};
+    *mutated = false;
+
+#define BATCH_ERROR(reason)                                          \
+    do                                                               \
+    {                                                                \
+        replyf("error,%d,%s,%s\n", line_no, command, reason);        \
+        return FAILURE;                                              \
+    } while (0)
+#define BATCH_INT(index)                                             \
+    do                                                               \
+    {                                                                \
+        if ((index) >= num_fields || !parseIntField(fields[index], &v[index])) \
+            BATCH_ERROR("bad number in field " #index);              \
+    } while (0)
+
+    if (strcmp(command, "add") == 0)
+    {
+        if (num_fields != 9 && num_fields != 12)
+            BATCH_ERROR("expected 8 or 11 arguments");
+        BATCH_INT(1);
+        BATCH_INT(3);
+        BATCH_INT(4);
+        BATCH_INT(5);
+        BATCH_INT(7);
+        BATCH_INT(8);
+        char exp_date[MAX_DATE_LENGTH];
+        if (!parseDateField(fields[6], exp_date))
+            BATCH_ERROR("bad expiry date");
+        if (fields[2][0] == '\0')
+            BATCH_ERROR("empty medication name");
+
+        supplier *supp = search_supplier(supplierTree, (int)v[8]);
+        if (supp == NULL && num_fields != 12)
+            BATCH_ERROR("unknown supplier and no supplier details");
+        if (supp == NULL)
+        {
+            BATCH_INT(10);
+            BATCH_INT(11);
+        }
+
+        data *med = findOrCreateMedication(&medIDTree, &mednameTree, (int)v[1], fields[2], (int)v[4], (int)v[7]);
+        if (!med)
+            BATCH_ERROR("out of memory");
+        batch *newBatch = addBatchToMedication(&expDateTree, med, (int)v[3], (int)v[5], exp_date);
+        *mutated = true;
+        if (!newBatch)
+            BATCH_ERROR("maximum batches reached");
+        if (supp == NULL)
+        {
+            supp = createSupplier(&supplierTree, (int)v[8], fields[9], (int)v[10], v[11]);
+            if (!supp)
+                BATCH_ERROR("out of memory");
+        }
+        if (linkSupplierToBatch(med, newBatch, supp) == FAILURE)
+            BATCH_ERROR("out of memory");
+        replyf("ok,%d,add,%d,%d\n", line_no, med->medID, newBatch->batch_no);
+        return SUCCESS;
+    }
+    if (strcmp(command, "update") == 0)
+    {
+        if (num_fields != 5)
+            BATCH_ERROR("expected 4 arguments");
+        BATCH_INT(1);
+        BATCH_INT(2);
+        BATCH_INT(3);
+        BATCH_INT(4);
+        data *med = search_medID(medIDTree, (int)v[1]);
+        if (!med)
+            BATCH_ERROR("medication not found");
+        batch *b = NULL;
+        if (v[3] != -1)
+        {
+            for (int j = 0; j < med->batch_count && !b; j++)
+            {
+                if (med->Batch[j].batch_no == v[3])
+                    b = &med->Batch[j];
+            }
+            if (!b)
+                BATCH_ERROR("batch not found");
+        }
+        if (v[2] != -1)
+            setMedicationPrice(med, (int)v[2]);
+        if (b)
+        {
+            preserveRecord(med);
+            b->qty_instock = (int)v[4];
+            columnsSetQty(b);
+        }
+        *mutated = true;
+        replyf("ok,%d,update,%d\n", line_no, med->medID);
+        return SUCCESS;
+    }
+    if (strcmp(command, "sell") == 0)
+    {
+        if (num_fields != 3)
+            BATCH_ERROR("expected 2 arguments");
+        BATCH_INT(1);
+        BATCH_INT(2);
+        if (v[2] <= 0)
+            BATCH_ERROR("quantity must be positive");
+        int sold = concurrentSell((int)v[1], (int)v[2], (long long)time(NULL));
+        if (sold < 0)
+            BATCH_ERROR("medication not found");
+        *mutated = sold > 0;
+        replyf("ok,%d,sell,%d,%d,%d\n", line_no, (int)v[1], sold, (int)v[2]);
+        return SUCCESS;
+    }
+    if (strcmp(command, "delete") == 0)
+    {
+        if (num_fields != 3)
+            BATCH_ERROR("expected 2 arguments");
+        BATCH_INT(1);
+        BATCH_INT(2);
+        data *med = search_medID(medIDTree, (int)v[1]);
+        if (!med)
+            BATCH_ERROR("medication not found");
+        if (removeMedicationRecord(&medIDTree, &mednameTree, &expDateTree, med, (int)v[2]) == FAILURE)
+            BATCH_ERROR("batch not found");
+        *mutated = true;
+        replyf("ok,%d,delete,%d,%d\n", line_no, (int)v[1], (int)v[2]);
+        return SUCCESS;
+    }
+    if (strcmp(command, "query") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        BATCH_INT(1);
+        readBegin();
+        data *med = lookupMedID((int)v[1]);
+        if (med)
+            printMedicationRow(line_no, "query", med);
+        readEnd();
+        if (!med)
+            BATCH_ERROR("medication not found");
+        return SUCCESS;
+    }
+    if (strcmp(command, "find") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        readBegin();
+        data *med = lookupMedname(fields[1]);
+        if (med)
+            printMedicationRow(line_no, "find", med);
+        readEnd();
+        if (!med)
+            BATCH_ERROR("medication not found");
+        return SUCCESS;
+    }
+    if (strcmp(command, "top") == 0)
+    {
+        if (num_fields != 3)
+            BATCH_ERROR("expected 2 arguments");
+        BATCH_INT(2);
+        rank_metric metric;
+        if (strcmp(fields[1], "meds") == 0)
+            metric = RANK_BY_MEDS;
+        else if (strcmp(fields[1], "turnover") == 0)
+            metric = RANK_BY_TURNOVER;
+        else
+            BATCH_ERROR("metric must be meds or turnover");
+        if (v[2] <= 0 || v[2] > 100000)
+            BATCH_ERROR("k out of range");
+
+        supplier **top = (supplier **)malloc(v[2] * sizeof(supplier *));
+        if (!top)
+            BATCH_ERROR("out of memory");
+        int ranked = topKSuppliers(metric, (int)v[2], top);
+        for (int i = 0; i < ranked; i++)
+        {
+            replyf("ok,%d,top,%s,%d,%d,%lld\n", line_no, fields[1], i + 1,
+                   top[i]->supplier_id, supplierScore(top[i], metric));
+        }
+        free(top);
+        if (ranked == 0)
+            replyf("ok,%d,top,%s\n", line_no, fields[1]);
+        return SUCCESS;
+    }
+
+    if (strcmp(command, "expiring") == 0)
+    {
+        if (num_fields != 3)
+            BATCH_ERROR("expected 2 arguments");
+        char from[MAX_DATE_LENGTH], to[MAX_DATE_LENGTH];
+        if (!parseDateField(fields[1], from) || !parseDateField(fields[2], to))
+            BATCH_ERROR("bad date");
+        int count;
+        expiring_batch *rows = expiringBatchesReport(from, to, &count);
+        if (count < 0)
+            BATCH_ERROR("out of memory");
+        for (int i = 0; i < count; i++)
+        {
+            char date[MAX_DATE_LENGTH];
+            reverse_date_format(rows[i].exp_date, date);
+            replyf("ok,%d,expiring,%s,%d,%s,%d,%d\n", line_no, date, rows[i].medID, rows[i].medname,
+                   rows[i].batch_no, rows[i].qty_instock);
+        }
+        free(rows);
+        if (count == 0)
+            replyf("ok,%d,expiring\n", line_no);
+        return SUCCESS;
+    }
+    if (strcmp(command, "sweep") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        char date[MAX_DATE_LENGTH];
+        if (!parseDateField(fields[1], date))
+            BATCH_ERROR("bad date");
+        long long start = now_ns();
+        int today = dateToDay(date), due, low;
+        sweep_totals totals;
+        sweepKernels()->totals(columns.expiry, columns.qty, columns.price, columns.rows, today, &totals);
+        int *rows = expiringRows(today + EXPIRY_WARNING_DAYS, &due);
+        stock_alert *alerts = lowStockAlerts(&low);
+        free(rows);
+        free(alerts);
+        if (!rows || !alerts)
+            BATCH_ERROR("out of memory");
+        replyf("ok,%d,sweep,%d,%lld,%lld,%lld,%lld,%d,%d,%.3f\n", line_no, columns.rows - columns.free_row_count,
+               totals.units, totals.value, totals.expired_units, totals.expired_value, due, low,
+               (now_ns() - start) / 1e6);
+        return SUCCESS;
+    }
+    if (strcmp(command, "audit") == 0)
+    {
+        if (num_fields > 2)
+            BATCH_ERROR("expected at most 1 argument");
+        v[1] = sysconf(_SC_NPROCESSORS_ONLN);
+        if (num_fields == 2)
+            BATCH_INT(1);
+        if (v[1] < 1 || v[1] > 256)
+            BATCH_ERROR("threads out of range");
+        supplier_index index = {NULL, NULL, 0, 0};
+        supplier_totals totals = {NULL, NULL, NULL, NULL, 0};
+        long long start = now_ns();
+        if (indexSupplierNode(supplierTree, &index) == FAILURE ||
+            computeSupplierTotals((int)v[1], &index, &totals) == FAILURE)
+        {
+            freeSupplierTotals(&totals);
+            freeSupplierIndex(&index);
+            BATCH_ERROR("out of memory");
+        }
+        int suppliers = 0, mismatches = 0;
+        auditSupplierNode(supplierTree, &totals, &suppliers, &mismatches);
+        replyf("ok,%d,audit,%d,%lld,%d,%.3f\n", line_no, suppliers, totals.links, mismatches,
+               (now_ns() - start) / 1e6);
+        freeSupplierTotals(&totals);
+        freeSupplierIndex(&index);
+        return SUCCESS;
+    }
+    if (strcmp(command, "supply") == 0)
+    {
+        if (num_fields != 1)
+            BATCH_ERROR("expected no arguments");
+        supply_totals totals;
+        long long start = now_ns();
+        if (snapshotSupplyTotals(&totals) == FAILURE)
+            BATCH_ERROR("out of memory");
+        double ms = (now_ns() - start) / 1e6;
+
+        long long volume = 0, turnover = 0;
+        int links = 0;
+        for (int i = 0; i < totals.count; i++)
+        {
+            const supply_total *t = &totals.entries[i];
+            replyf("ok,%d,supply,%d,%d,%lld,%lld\n", line_no, t->supplier_id, t->links, t->volume, t->turnover);
+            links += t->links;
+            volume += t->volume;
+            turnover += t->turnover;
+        }
+        replyf("ok,%d,supply,total,%d,%lld,%lld,%.3f\n", line_no, links, volume, turnover, ms);
+        free(totals.entries);
+        return SUCCESS;
+    }
+    if (strcmp(command, "latency") == 0)
+    {
+        latency_histogram *h = &operation_stats[OP_SALE].latency;
+        replyf("ok,%d,latency,sell,%lld,%lld,%lld,%lld,%lld,%lld\n", line_no, h->total,
+               latencyPercentile(h, 50), latencyPercentile(h, 90),
+               latencyPercentile(h, 99), latencyPercentile(h, 99.9), h->max);
+        return SUCCESS;
+    }
+    if (strcmp(command, "sold") == 0)
+    {
+        if (num_fields != 3)
+            BATCH_ERROR("expected 2 arguments");
+        BATCH_INT(1);
+        BATCH_INT(2);
+        if (v[2] < 1 || v[2] > ROLLUP_DAYS)
+            BATCH_ERROR("days out of range");
+        data *med = search_medID(medIDTree, (int)v[1]);
+        if (!med)
+            BATCH_ERROR("medication not found");
+        replyf("ok,%d,sold,%d,%d,%lld,%lld\n", line_no, med->medID, (int)v[2],
+               unitsSoldInLastDays(med, (int)v[2], (long long)time(NULL)), med->units_sold);
+        return SUCCESS;
+    }
+    if (strcmp(command, "topsellers") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        BATCH_INT(1);
+        if (v[1] < 1 || v[1] > 100000)
+            BATCH_ERROR("k out of range");
+        seller_entry *top = (seller_entry *)malloc(v[1] * sizeof(seller_entry));
+        if (!top)
+            BATCH_ERROR("out of memory");
+        int found = topSellersThisWeek((int)v[1], (long long)time(NULL), top);
+        for (int i = 0; i < found; i++)
+            replyf("ok,%d,topsellers,%d,%d,%lld\n", line_no, i + 1, top[i].med->medID, top[i].units);
+        free(top);
+        if (found == 0)
+            replyf("ok,%d,topsellers\n", line_no);
+        return SUCCESS;
+    }
+    if (strcmp(command, "page") == 0 || strcmp(command, "rank") == 0)
+    {
+        if (num_fields != (strcmp(command, "page") == 0 ? 4 : 3))
+            BATCH_ERROR(strcmp(command, "page") == 0 ? "expected 3 arguments" : "expected 2 arguments");
+        Boolean expiry = strcmp(fields[1], "expiry") == 0;
+        if (!expiry && strcmp(fields[1], "name") != 0)
+            BATCH_ERROR("index must be expiry or name");
+        B_str *root = expiry ? expDateTree : mednameTree;
+
+        if (strcmp(command, "rank") == 0)
+        {
+            char date[MAX_DATE_LENGTH];
+            if (expiry && !parseDateField(fields[2], date))
+                BATCH_ERROR("bad expiry date");
+            replyf("ok,%d,rank,%s,%d,%d\n", line_no, fields[1],
+                   rankOfKeyStr(root, expiry ? date : fields[2]), subtreeSizeStr(root));
+            return SUCCESS;
+        }
+
+        BATCH_INT(2);
+        BATCH_INT(3);
+        if (v[2] < 1 || v[3] < 1 || v[3] > 100000)
+            BATCH_ERROR("page and page size must be positive");
+        long long first = (v[2] - 1) * v[3];
+        if (first >= subtreeSizeStr(root))
+        {
+            replyf("ok,%d,page,%s\n", line_no, fields[1]);
+            return SUCCESS;
+        }
+
+        char **keys = (char **)malloc(v[3] * sizeof(char *));
+        data **values = (data **)malloc(v[3] * sizeof(data *));
+        if (!keys || !values)
+        {
+            free(keys);
+            free(values);
+            BATCH_ERROR("out of memory");
+        }
+        int shown = entriesByPositionStr(root, (int)first, (int)v[3], keys, values);
+        for (int i = 0; i < shown; i++)
+        {
+            char key[MAX_NAME_LENGTH];
+            if (expiry)
+                reverse_date_format(keys[i], key);
+            else
+                snprintf(key, sizeof(key), "%s", keys[i]);
+            replyf("ok,%d,page,%s,%lld,%s,%d,%s\n", line_no, fields[1], first + i + 1, key,
+                   values[i]->medID, values[i]->medname);
+        }
+        free(keys);
+        free(values);
+        return SUCCESS;
+    }
+
+    if (strcmp(command, "alerts") == 0)
+    {
+        int count;
+        stock_alert *alerts = lowStockAlerts(&count);
+        if (!alerts)
+            BATCH_ERROR("out of memory");
+        for (int i = 0; i < count; i++)
+            replyf("ok,%d,alerts,%d,%s,%lld,%d\n", line_no, alerts[i].med->medID, alerts[i].med->medname,
+                   alerts[i].stock, alerts[i].med->reorder_lvl);
+        free(alerts);
+        if (count == 0)
+            replyf("ok,%d,alerts\n", line_no);
+        return SUCCESS;
+    }
+    if (strcmp(command, "due") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        char date[MAX_DATE_LENGTH];
+        if (!parseDateField(fields[1], date))
+            BATCH_ERROR("bad date");
+        int today = dateToDay(date), count;
+        int *rows = expiringRows(today + EXPIRY_WARNING_DAYS, &count);
+        if (!rows)
+            BATCH_ERROR("out of memory");
+        for (int i = 0; i < count; i++)
+        {
+            char day[MAX_DATE_LENGTH], formatted[MAX_DATE_LENGTH];
+            dayToDate(columns.expiry[rows[i]], day);
+            reverse_date_format(day, formatted);
+            replyf("ok,%d,due,%d,%s,%s\n", line_no, columns.meds[columns.med[rows[i]]]->medID, formatted,
+                   columns.expiry[rows[i]] < today ? "expired" : "soon");
+        }
+        free(rows);
+        if (count == 0)
+            replyf("ok,%d,due\n", line_no);
+        return SUCCESS;
+    }
+    if (strcmp(command, "purge") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        char date[MAX_DATE_LENGTH];
+        if (!parseDateField(fields[1], date))
+            BATCH_ERROR("bad date");
+        long long start = now_ns();
+        purge_totals totals;
+        if (purgeExpiredStock(date, &totals) == FAILURE)
+            BATCH_ERROR("out of memory or archive not writable");
+        *mutated = totals.batches > 0;
+        replyf("ok,%d,purge,%d,%d,%lld,%.3f\n", line_no, totals.batches, totals.medications, totals.units,
+               (now_ns() - start) / 1e6);
+        return SUCCESS;
+    }
+    if (strcmp(command, "link") == 0)
+    {
+        if (num_fields != 4 && num_fields != 7)
+            BATCH_ERROR("expected 3 or 6 arguments");
+        BATCH_INT(1);
+        BATCH_INT(2);
+        BATCH_INT(3);
+        data *med = search_medID(medIDTree, (int)v[1]);
+        if (!med)
+            BATCH_ERROR("medication not found");
+        batch *b = NULL;
+        for (int j = 0; j < med->batch_count && !b; j++)
+        {
+            if (med->Batch[j].batch_no == v[2])
+                b = &med->Batch[j];
+        }
+        if (!b)
+            BATCH_ERROR("batch not found");
+        supplier *supp = search_supplier(supplierTree, (int)v[3]);
+        if (supp == NULL)
+        {
+            if (num_fields != 7)
+                BATCH_ERROR("unknown supplier and no supplier details");
+            BATCH_INT(5);
+            BATCH_INT(6);
+            supp = createSupplier(&supplierTree, (int)v[3], fields[4], (int)v[5], v[6]);
+            if (!supp)
+                BATCH_ERROR("out of memory");
+            *mutated = true;
+        }
+        if (batchHasSupplier(b, supp))
+            BATCH_ERROR("supplier already linked");
+        if (linkSupplierToBatch(med, b, supp) == FAILURE)
+            BATCH_ERROR("maximum suppliers reached");
+        *mutated = true;
+        replyf("ok,%d,link,%d,%d,%d\n", line_no, med->medID, b->batch_no, supp->supplier_id);
+        return SUCCESS;
+    }
+    if (strcmp(command, "dropsupplier") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        BATCH_INT(1);
+        int linked = removeSupplier((int)v[1]);
+        if (linked < 0)
+            BATCH_ERROR("supplier not found");
+        *mutated = true;
+        replyf("ok,%d,dropsupplier,%d,%d\n", line_no, (int)v[1], linked);
+        return SUCCESS;
+    }
+    if (strcmp(command, "editsupplier") == 0)
+    {
+        if (num_fields != 4)
+            BATCH_ERROR("expected 3 arguments");
+        BATCH_INT(1);
+        BATCH_INT(2);
+        BATCH_INT(3);
+        supplier *supp = search_supplier(supplierTree, (int)v[1]);
+        if (!supp)
+            BATCH_ERROR("supplier not found");
+        if (v[3] != -1)
+            supp->contact = v[3];
+        if (v[2] != -1)
+            supp->qty_of_supply = (int)v[2];
+        *mutated = true;
+        replyf("ok,%d,editsupplier,%d\n", line_no, supp->supplier_id);
+        return SUCCESS;
+    }
+    if (strcmp(command, "supplier") == 0)
+    {
+        if (num_fields != 2)
+            BATCH_ERROR("expected 1 argument");
+        BATCH_INT(1);
+        supplier *supp = search_supplier(supplierTree, (int)v[1]);
+        if (!supp)
+            BATCH_ERROR("supplier not found");
+        replyf("ok,%d,supplier,%d,%s,%d,%lld,%d,%lld\n", line_no, supp->supplier_id, supp->supp_name,
+               supp->qty_of_supply, supp->contact, supp->med_count, supp->supply_volume);
+        return SUCCESS;
+    }
+    if (strcmp(command, "treestats") == 0)
+    {
+        long long start = now_ns();
+        tree_health health[HEALTH_TREES];
+        int violations = surveyTrees(health);
+        for (int t = 0; t < HEALTH_TREES; t++)
+        {
+            char levels[256];
+            formatLevelKeys(&health[t], levels, sizeof(levels));
+            replyf("ok,%d,treestats,%s,%d,%lld,%lld,%lld,%.3f,%lld,%lld,%d,%s\n", line_no, health_tree_names[t],
+                   health[t].shape.height, health[t].shape.nodes, health[t].shape.keys, health[t].expected,
+                   health[t].fill, health[t].duplicates, health[t].bad_values, health[t].shape.violations, levels);
+        }
+        replyf("ok,%d,treestats,total,%d,%.3f\n", line_no, violations, (now_ns() - start) / 1e6);
+        return SUCCESS;
+    }
+    if (strcmp(command, "memory") == 0)
+    {
+        memory_usage report[MEM_ITEMS];
+        accountMemory(report);
+        for (int i = 0; i < MEM_ITEMS; i++)
+            replyf("ok,%d,memory,%s,%lld,%lld,%lld\n", line_no, memory_item_names[i], report[i].bytes,
+                   report[i].used, report[i].reserved);
+        replyf("ok,%d,memory,total,%lld\n", line_no, memoryTotal(report));
+        return SUCCESS;
+    }
+    if (strcmp(command, "stats") == 0)
+    {
+        if (num_fields > 2)
+            BATCH_ERROR("expected at most 1 argument");
+        if (num_fields == 2)
+        {
+            if (dumpOperationStatsToFile(fields[1]) == FAILURE)
+                BATCH_ERROR("cannot write file");
+            replyf("ok,%d,stats,%s\n", line_no, fields[1]);
+            return SUCCESS;
+        }
+        for (int k = 0; k < OP_KINDS; k++)
+        {
+            latency_histogram *h = &operation_stats[k].latency;
+            if (h->total == 0)
+                continue;
+            replyf("ok,%d,stats,%s,%lld,%lld,%lld,%lld,%lld,%lld,%lld\n", line_no, op_names[k], h->total,
+                   operation_stats[k].errors, latencyPercentile(h, 50), latencyPercentile(h, 90),
+                   latencyPercentile(h, 99), latencyPercentile(h, 99.9), h->max);
+        }
+        return SUCCESS;
+    }
+
+#undef BATCH_INT
+#undef BATCH_ERROR
+
+    replyf("error,%d,%s,unknown command\n", line_no, command);
+    return FAILURE;
+}
+
+// Operation kind a batch command is counted under in the operation stats.
+op_kind batchCommandKind(const char *command)
+{
+    static const struct
+    {
+        const char *command;
+        op_kind kind;
+    } kinds[] = {{"add", OP_ADD}, {"update", OP_UPDATE}, {"delete", OP_DELETE}, {"sell", OP_SALE},
+                 {"query", OP_SEARCH}, {"find", OP_SEARCH}, {"page", OP_SEARCH}, {"rank", OP_SEARCH},
+                 {"expiring", OP_EXPIRY_RANGE}, {"sweep", OP_EXPIRY_CHECK}, {"top", OP_TOP_REPORT},
+                 {"topsellers", OP_SALES_REPORT}, {"sold", OP_SALES_REPORT},
+                 {"alerts", OP_STOCK_ALERTS}, {"due", OP_EXPIRY_CHECK}, {"link", OP_SUPPLIER},
+                 {"dropsupplier", OP_SUPPLIER}, {"editsupplier", OP_SUPPLIER}, {"supplier", OP_SEARCH},
+                 {"supply", OP_TOP_REPORT}, {"purge", OP_PURGE}};
+    for (size_t i = 0; i < sizeof(kinds) / sizeof(kinds[0]); i++)
+        if (strcmp(command, kinds[i].command) == 0)
+            return kinds[i].kind;
+    return OP_OTHER;
+}
+
+// Executes one batch command and records its latency and outcome in the operation stats.
+status_code runBatchCommand(int line_no, char *fields[], int num_fields, Boolean *mutated)
+{
+    long long start = opBegin();
+    status_code status = applyBatchCommand(line_no, fields, num_fields, mutated);
+    if (start)
+        opEnd(batchCommandKind(fields[0]), start, status == FAILURE);
+    return status;
+}
+
+// Runs every command from in, persisting once at the end and every checkpoint_every
+// mutating commands when checkpoint_every > 0. Returns the number of failed commands.
+int runBatch(FILE *in, int checkpoint_every)
+{
+    char line[MAX_BATCH_LINE];
+    char *fields[MAX_BATCH_FIELDS];
+    int line_no = 0, commands = 0, succeeded = 0, failed = 0, saves = 0;
+    int unsaved = 0;
+
+    while (fgets(line, sizeof(line), in))
+    {
+        line_no++;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        int num_fields = splitFields(line, fields, MAX_BATCH_FIELDS);
+        commands++;
+
+        if (strcmp(fields[0], "save") == 0)
+        {
+            if (saveMedicationsToFile() == SUCCESS)
+            {
+                saves++;
+                unsaved = 0;
+                succeeded++;
+                printf("ok,%d,save\n", line_no);
+            }
+            else
+            {
+                failed++;
+                printf("error,%d,save,cannot write data file\n", line_no);
+            }
+            continue;
+        }
+
+        Boolean mutated = false;
+        if (runBatchCommand(line_no, fields, num_fields, &mutated) == SUCCESS)
+            succeeded++;
+        else
+            failed++;
+
+        if (mutated)
+            unsaved++;
+        if (checkpoint_every > 0 && unsaved >= checkpoint_every)
+        {
+            if (saveMedicationsToFile() == SUCCESS)
+            {
+                saves++;
+                unsaved = 0;
+                printf("ok,%d,checkpoint\n", line_no);
+            }
+            else
+            {
+                printf("error,%d,checkpoint,cannot write data file\n", line_no);
+            }
+        }
+    }
+
+    if (unsaved > 0)
+    {
+        if (saveMedicationsToFile() == SUCCESS)
+            saves++;
+        else
+            printf("error,%d,save,cannot write data file\n", line_no);
+    }
+
+    printf("summary,%d,%d,%d,%d\n", commands, succeeded, failed, saves);
+    return failed;
+}
+
+//==========WORKLOAD REPLAY==========//
+
+// Plays a recorded workload (see WORKLOAD RECORDING) against a copy of the inventory in
+// snapshot_path as fast as possible, then reports the run and the per-operation statistics.
+// Replies are discarded. Saves in the log write a scratch file, and sales are not appended to
+// the ledger, so neither the snapshot nor the real data files change.
+int runReplay(FILE *log, const char *snapshot_path)
+{
+    if (access(snapshot_path, R_OK) != 0)
+    {
+        fprintf(stderr, "Cannot read snapshot %s\n", snapshot_path);
+        return 1;
+    }
+    char scratch[] = "/tmp/pharmacy-replay-XXXXXX";
+    int fd = mkstemp(scratch);
+    FILE *sink = fopen("/dev/null", "w");
+    if (fd < 0 || !sink)
+    {
+        fprintf(stderr, "Cannot set up the replay scratch files.\n");
+        if (fd >= 0)
+        {
+            close(fd);
+            unlink(scratch);
+        }
+        return 1;
+    }
+    close(fd);
+
+    quiet = true;
+    data_file = snapshot_path;
+    long long start = now_ns();
+    loadMedicationsFromFile();
+    long long load_ns = now_ns() - start;
+    data_file = scratch;
+    archive_file = NULL;
+    resetOperationStats();
+
+    char line[MAX_BATCH_LINE];
+    char *fields[MAX_BATCH_FIELDS];
+    int line_no = 0, commands = 0, failed = 0, saves = 0;
+    reply_out = sink;
+    start = now_ns();
+    while (fgets(line, sizeof(line), log))
+    {
+        line_no++;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+        int num_fields = splitFields(line, fields, MAX_BATCH_FIELDS);
+        commands++;
+        if (strcmp(fields[0], "save") == 0)
+        {
+            saves++;
+            if (saveMedicationsToFile() == FAILURE)
+                failed++;
+            continue;
+        }
+        Boolean mutated;
+        if (runBatchCommand(line_no, fields, num_fields, &mutated) == FAILURE)
+            failed++;
+    }
+    long long elapsed = now_ns() - start;
+    reply_out = NULL;
+    fclose(sink);
+    unlink(scratch);
+
+    printf("commands,errors,saves,load_ms,replay_ms,commands_per_sec\n");
+    printf("%d,%d,%d,%.3f,%.3f,%.0f\n", commands, failed, saves, load_ns / 1e6, elapsed / 1e6,
+           elapsed > 0 ? commands / (elapsed / 1e9) : 0.0);
+    printf("\n");
+    dumpOperationStats(stdout);
+    return 0;
+}
+
+//==========BATCHED SALES==========//
+
+// Close-of-day ingestion: line items are sorted by medication and applied in a single in-order
+// walk of medIDTree, so each medication is found once no matter how many lines refer to it.
+
+typedef enum
+{
+    SALE_PENDING,
+    SALE_FILLED,      // Every requested unit was sold
+    SALE_PARTIAL,     // Some units were sold
+    SALE_EXPIRED,     // Nothing sold; the only stock left had expired by the sale date
+    SALE_NO_STOCK,    // Nothing sold; no stock at all
+    SALE_UNKNOWN_MED, // No medication with that ID
+    SALE_INVALID      // Malformed line or non-positive quantity
+} sale_status;
+
+typedef struct
+{
+    int line;                   // Position in the input, used for reporting
+    int medID;
+    int qty;
+    long long timestamp;        // Seconds since the epoch; orders lines of the same medication
+    char date[MAX_DATE_LENGTH]; // Sale date (YYYY-MM-DD) checked against batch expiry
+    int sold;
+    int refused_expired;        // Units left unsold because the remaining stock had expired
+    sale_status status;
+} sale_item;
+
+const char *saleStatusName(sale_status status)
+{
+    switch (status)
+    {
+    case SALE_FILLED:
+        return "filled";
+    case SALE_PARTIAL:
+        return "partial";
+    case SALE_EXPIRED:
+        return "expired";
+    case SALE_NO_STOCK:
+        return "no_stock";
+    case SALE_UNKNOWN_MED:
+        return "unknown";
+    case SALE_INVALID:
+        return "invalid";
+    default:
+        return "pending";
+    }
+}
+
+int compareSaleItemsByMed(const void *a, const void *b)
+{
+    const sale_item *x = (const sale_item *)a;
+    const sale_item *y = (const sale_item *)b;
+    if (x->medID != y->medID)
+        return x->medID < y->medID ? -1 : 1;
+    if (x->timestamp != y->timestamp)
+        return x->timestamp < y->timestamp ? -1 : 1;
+    return x->line - y->line;
+}
+
+int compareSaleItemsByLine(const void *a, const void *b)
+{
+    return ((const sale_item *)a)->line - ((const sale_item *)b)->line;
+}
+
+void applySaleItem(data *med, sale_item *item)
+{
+    int batches_used;
+    item->sold = sellFromMedication(med, item->qty, &batches_used, NULL, item->date);
+    recordSale(med, item->sold, item->timestamp);
+
+    int unfilled = item->qty - item->sold;
+    if (unfilled > 0)
+    {
+        int expired_stock;
+        fefoFirstUnexpired(med, item->date, &expired_stock);
+        item->refused_expired = unfilled < expired_stock ? unfilled : expired_stock;
+    }
+
+    if (unfilled == 0)
+        item->status = SALE_FILLED;
+    else if (item->sold > 0)
+        item->status = SALE_PARTIAL;
+    else if (item->refused_expired > 0)
+        item->status = SALE_EXPIRED;
+    else
+        item->status = SALE_NO_STOCK;
+}
+
+// Applies every item whose medID is below upper, walking node in key order. items must be
+// sorted by medID; *next is the first item not yet handled.
+void applySaleItemsInOrder(B *node, sale_item *items, int count, int *next, long long upper)
+{
+    for (int i = 0; node != NULL && i <= node->num_keys; i++)
+    {
+        long long bound = i < node->num_keys ? node->keys[i] : upper;
+
+        if (!node->is_leaf && *next < count && items[*next].medID < bound)
+            applySaleItemsInOrder(node->children[i], items, count, next, bound);
+
+        // Anything still below this key has no medication in the tree
+        while (*next < count && items[*next].medID < bound)
+        {
+            if (items[*next].status == SALE_PENDING)
+                items[*next].status = SALE_UNKNOWN_MED;
+            (*next)++;
+        }
+
+        while (i < node->num_keys && *next < count && items[*next].medID == node->keys[i])
+        {
+            if (items[*next].status == SALE_PENDING)
+                applySaleItem(node->values[i], &items[*next]);
+            (*next)++;
+        }
+
+        if (*next >= count || items[*next].medID >= upper)
+            return;
+    }
+
+    while (*next < count && items[*next].medID < upper)
+    {
+        if (items[*next].status == SALE_PENDING)
+            items[*next].status = SALE_UNKNOWN_MED;
+        (*next)++;
+    }
+}
+
+// Applies count sale items in one ordered pass over medIDTree. Items of the same medication are
+// applied in timestamp order; expired batches are never sold. Each item's sold,
+// refused_expired and status fields are filled in, and items are returned in input order.
+// Returns the total number of units sold.
+long long applySalesBatch(sale_item *items, int count)
+{
+    for (int k = 0; k < count; k++)
+    {
+        items[k].sold = 0;
+        items[k].refused_expired = 0;
+        if (items[k].status != SALE_INVALID)
+            items[k].status = items[k].qty > 0 ? SALE_PENDING : SALE_INVALID;
+    }
+
+    long long start = opBegin();
+    qsort(items, count, sizeof(sale_item), compareSaleItemsByMed);
+    opEnd(PHASE_BATCH_SORT, start, false);
+    int next = 0;
+    applySaleItemsInOrder(medIDTree, items, count, &next, (long long)1 << 32);
+    start = opBegin();
+    qsort(items, count, sizeof(sale_item), compareSaleItemsByLine);
+    opEnd(PHASE_BATCH_SORT, start, false);
+
+    long long sold = 0;
+    for (int k = 0; k < count; k++)
+        sold += items[k].sold;
+    return sold;
+}
+
+// Parses a sale timestamp: seconds since the epoch, or a DD-MM-YYYY date (taken as midnight UTC).
+// Fills in the YYYY-MM-DD sale date. Days are UTC, as in the ledger rollups, so a sale is counted
+// on the same day whatever the local time zone. Sales must fall between 1970 and 9999. Returns 0
+// if the field is malformed, names a day that does not exist or is out of that range.
+int parseSaleTimestamp(const char *field, long long *timestamp, char *date)
+{
+    int last_day = dateToDay("9999-12-31");
+    if (strchr(field, '-'))
+    {
+        // parseDateField checks the shape and the day and month ranges; the round trip through
+        // the day number rejects days the month does not have, such as 31-02
+        char check[MAX_DATE_LENGTH];
+        if (!parseDateField(field, date))
+            return 0;
+        int day = dateToDay(date);
+        dayToDate(day, check);
+        if (day < 0 || day > last_day || strcmp(check, date) != 0)
+            return 0;
+        *timestamp = (long long)day * SECONDS_PER_DAY;
+        return 1;
+    }
+
+    long long seconds;
+    if (!parseIntField(field, &seconds) || seconds < 0 || seconds / SECONDS_PER_DAY > last_day)
+        return 0;
+    *timestamp = seconds;
+    dayToDate(dayNumber(seconds), date);
+    return 1;
+}
+
+// Reads "medID,qty,timestamp" lines into a growing array. Blank lines and # comments are
+// skipped; malformed lines are kept and marked invalid so they are still reported.
+int readSaleItems(FILE *in, sale_item **items_out)
+{
+    char line[MAX_BATCH_LINE];
+    char *fields[MAX_BATCH_FIELDS];
+    int count = 0, capacity = 0, line_no = 0;
+    sale_item *items = NULL;
+
+    while (fgets(line, sizeof(line), in))
+    {
+        line_no++;
+        if (line[0] == '#' || line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+
+        if (count == capacity)
+        {
+            capacity = capacity ? capacity * 2 : 1024;
+            sale_item *grown = (sale_item *)realloc(items, capacity * sizeof(sale_item));
+            if (!grown)
+                break;
+            items = grown;
+        }
+
+        sale_item *item = &items[count++];
+        memset(item, 0, sizeof(*item));
+        item->line = line_no;
+
+        long long medID, qty;
+        int num_fields = splitFields(line, fields, MAX_BATCH_FIELDS);
+        if (num_fields != 3 || !parseIntField(fields[0], &medID) || !parseIntField(fields[1], &qty) ||
+            !parseSaleTimestamp(fields[2], &item->timestamp, item->date))
+        {
+            item->status = SALE_INVALID;
+            continue;
+        }
+        item->medID = (int)medID;
+        item->qty = (int)qty;
+    }
+
+    *items_out = items;
+    return count;
+}
+
+// Applies a file of sale lines, prints one result row per line and saves once.
+// Returns the number of lines that were not completely filled.
+int runSalesFile(FILE *in)
+{
+    sale_item *items = NULL;
+    int count = readSaleItems(in, &items);
+
+    long long start = now_ns();
+    long long sold = applySalesBatch(items, count);
+    flushSalesLedger(); // One commit for the whole batch, before any result is reported
+    long long elapsed = now_ns() - start;
+
+    int filled = 0, partial = 0, refused = 0, failed = 0;
+    for (int k = 0; k < count; k++)
+    {
+        sale_item *item = &items[k];
+        printf("%d,%d,%d,%d,%d,%s\n", item->line, item->medID, item->qty, item->sold,
+               item->refused_expired, saleStatusName(item->status));
+        if (item->status == SALE_FILLED)
+            filled++;
+        else if (item->status == SALE_PARTIAL)
+            partial++;
+        else if (item->status == SALE_EXPIRED)
+            refused++;
+        else
+            failed++;
+    }
+
+    if (sold > 0 && saveMedicationsToFile() == FAILURE)
+        printf("error,save,cannot write data file\n");
+    printf("summary,%d,%d,%d,%d,%d,%lld,%lld\n", count, filled, partial, refused, failed, sold, elapsed / 1000);
+
+    free(items);
+    return count - filled;
+}
+
+//==========SERVER MODE==========//
+
+// --serve keeps the inventory in memory and answers batch-mode commands over a Unix socket
+// ("unix:PATH") or a loopback TCP port ("tcp:PORT"). Each request is one command line; its
+// reply is the command's ok/error lines followed by an empty line. Clients may pipeline any
+// number of requests. One epoll loop accepts connections and reads requests; a worker pool
+// runs them, and replies on a connection come back in request order. Workers never wait on a
+// socket: a reply the peer is not ready to take is left with the connection, and the loop
+// finishes sending it when the socket becomes writable before reading that peer's next requests.
+//
+// Lookups (query, find) run lock-free, sales take only their medication's lock, and saves and
+// expiry reports read a snapshot, so all of them proceed in parallel across workers. Every
+// other command gets the trees to itself.
+
+#define SERVER_MAX_EVENTS 64
+#define SERVER_MAX_PENDING (1 << 20) // Unanswered request bytes a connection may buffer
+
+typedef struct connection_tag
+{
+    int fd;
+    char *in;      // Bytes received but not yet answered
+    int in_len;
+    int in_cap;
+    Boolean eof;   // Peer closed its side; close once the buffered requests are answered
+    char *out;     // Reply bytes not yet sent, NULL when there are none
+    size_t out_len;
+    size_t out_sent;
+    int requests;  // Requests answered on this connection, used as reply line numbers
+    struct connection_tag *next; // Link in the work or done queue
+} connection;
+
+typedef struct
+{
+    connection *head;
+    connection *tail;
+} connection_queue;
+
+connection_queue work_queue = {NULL, NULL}; // Connections with complete requests to run
+connection_queue done_queue = {NULL, NULL}; // Connections handed back to the event loop
+pthread_mutex_t work_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t work_ready = PTHREAD_COND_INITIALIZER;
+pthread_mutex_t done_lock = PTHREAD_MUTEX_INITIALIZER;
+int server_wake_pipe[2] = {-1, -1}; // Workers write here so the loop picks up done_queue
+int server_mutations = 0;           // Mutating commands since the last save
+volatile sig_atomic_t server_stopping = 0;
+char server_listen_tag, server_wake_tag; // epoll data for the two non-connection descriptors
+
+void enqueueConnection(connection_queue *queue, connection *conn)
+{
+    conn->next = NULL;
+    if (queue->tail)
+        queue->tail->next = conn;
+    else
+        queue->head = conn;
+    queue->tail = conn;
+}
+
+connection *dequeueConnection(connection_queue *queue)
+{
+    connection *conn = queue->head;
+    if (conn)
+    {
+        queue->head = conn->next;
+        if (!queue->head)
+            queue->tail = NULL;
+    }
+    return conn;
+}
+
+void stopServing(int signum)
+{
+    (void)signum;
+    server_stopping = 1;
+}
+
+// Fills addr from "unix:PATH" or "tcp:PORT" (loopback). Returns the address length, or 0 if
+// the address is malformed.
+socklen_t parseServerAddress(const char *address, struct sockaddr_storage *addr)
+{
+    memset(addr, 0, sizeof(*addr));
+    if (strncmp(address, "unix:", 5) == 0)
+    {
+        struct sockaddr_un *un = (struct sockaddr_un *)addr;
+        if (address[5] == '\0' || strlen(address + 5) >= sizeof(un->sun_path))
+            return 0;
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, address + 5);
+        return sizeof(*un);
+    }
+    if (strncmp(address, "tcp:", 4) == 0)
+    {
+        long long port;
+        struct sockaddr_in *in = (struct sockaddr_in *)addr;
+        if (!parseIntField(address + 4, &port) || port < 1 || port > 65535)
+            return 0;
+        in->sin_family = AF_INET;
+        in->sin_port = htons((unsigned short)port);
+        in->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        return sizeof(*in);
+    }
+    return 0;
+}
+
+int openServerSocket(const char *address)
+{
+    struct sockaddr_storage addr;
+    socklen_t len = parseServerAddress(address, &addr);
+    if (len == 0)
+    {
+        fprintf(stderr, "Bad server address %s (use unix:PATH or tcp:PORT)\n", address);
+        return -1;
+    }
+
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+    {
+        perror("socket");
+        return -1;
+    }
+    if (addr.ss_family == AF_UNIX)
+    {
+        unlink(((struct sockaddr_un *)&addr)->sun_path);
+    }
+    else
+    {
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    }
+    if (bind(fd, (struct sockaddr *)&addr, len) < 0 || listen(fd, SOMAXCONN) < 0)
+    {
+        perror(address);
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Sends as much of conn's pending reply as the socket takes without blocking, and frees the
+// reply once it is all sent. Returns FAILURE if the peer is gone.
+status_code flushConnection(connection *conn)
+{
+    while (conn->out_sent < conn->out_len)
+    {
+        ssize_t n = send(conn->fd, conn->out + conn->out_sent, conn->out_len - conn->out_sent, MSG_NOSIGNAL);
+        if (n > 0)
+            conn->out_sent += n;
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            return SUCCESS;
+        else
+            return FAILURE;
+    }
+    free(conn->out);
+    conn->out = NULL;
+    conn->out_len = conn->out_sent = 0;
+    return SUCCESS;
+}
+
+// Drops everything conn still holds so that the loop closes it.
+void abandonConnection(connection *conn)
+{
+    free(conn->out);
+    conn->out = NULL;
+    conn->out_len = conn->out_sent = 0;
+    conn->in_len = 0;
+    conn->eof = true;
+}
+
+// Runs one request line and writes its reply lines to reply_out.
+void serveCommand(connection *conn, char *line)
+{
+    char *fields[MAX_BATCH_FIELDS];
+    int line_no = ++conn->requests;
+    int num_fields = splitFields(line, fields, MAX_BATCH_FIELDS);
+    Boolean mutated = false;
+
+    if (strcmp(fields[0], "query") == 0 || strcmp(fields[0], "find") == 0 || strcmp(fields[0], "sell") == 0 ||
+        strcmp(fields[0], "expiring") == 0)
+    {
+        runBatchCommand(line_no, fields, num_fields, &mutated);
+    }
+    else if (strcmp(fields[0], "save") == 0)
+    {
+        // Writes a snapshot, so sales on other workers continue meanwhile
+        if (saveMedicationsToFile() == SUCCESS)
+        {
+            __atomic_store_n(&server_mutations, 0, __ATOMIC_RELAXED);
+            replyf("ok,%d,save\n", line_no);
+        }
+        else
+        {
+            replyf("error,%d,save,cannot write data file\n", line_no);
+        }
+    }
+    else
+    {
+        writeBegin();
+        runBatchCommand(line_no, fields, num_fields, &mutated);
+        writeEnd();
+    }
+
+    if (mutated)
+        __atomic_add_fetch(&server_mutations, 1, __ATOMIC_RELAXED);
+    replyf("\n");
+}
+
+void *serverWorker(void *arg)
+{
+    (void)arg;
+    for (;;)
+    {
+        pthread_mutex_lock(&work_lock);
+        connection *conn;
+        while ((conn = dequeueConnection(&work_queue)) == NULL && !server_stopping)
+            pthread_cond_wait(&work_ready, &work_lock);
+        pthread_mutex_unlock(&work_lock);
+        if (conn == NULL)
+            return NULL;
+
+        // Answer every complete request buffered so far, in order, with a single reply
+        char *reply = NULL;
+        size_t reply_len = 0;
+        reply_out = open_memstream(&reply, &reply_len);
+        int consumed = 0;
+        char *newline;
+        while (reply_out && (newline = memchr(conn->in + consumed, '\n', conn->in_len - consumed)) != NULL)
+        {
+            *newline = '\0';
+            char *line = conn->in + consumed;
+            consumed = newline - conn->in + 1;
+            if (line[strspn(line, " \t\r")] != '\0')
+                serveCommand(conn, line);
+        }
+        memmove(conn->in, conn->in + consumed, conn->in_len - consumed);
+        conn->in_len -= consumed;
+        if (reply_out)
+        {
+            fclose(reply_out);
+            reply_out = NULL;
+            conn->out = reply;
+            conn->out_len = reply_len;
+            conn->out_sent = 0;
+            if (flushConnection(conn) == FAILURE)
+                abandonConnection(conn);
+        }
+        else
+        {
+            free(reply);
+            abandonConnection(conn);
+        }
+
+        pthread_mutex_lock(&done_lock);
+        enqueueConnection(&done_queue, conn);
+        pthread_mutex_unlock(&done_lock);
+        char wake = 1;
+        if (write(server_wake_pipe[1], &wake, 1) < 0 && errno != EAGAIN)
+            perror("wake");
+    }
+}
+
+void closeConnection(connection *conn)
+{
+    close(conn->fd);
+    free(conn->in);
+    free(conn->out);
+    free(conn);
+}
+
+// Waits for the next readable event on conn, or the next writable one while a reply is pending.
+void rearmConnection(int epfd, connection *conn)
+{
+    struct epoll_event ev;
+    ev.events = (conn->out ? EPOLLOUT : EPOLLIN | EPOLLRDHUP) | EPOLLONESHOT;
+    ev.data.ptr = conn;
+    epoll_ctl(epfd, EPOLL_CTL_MOD, conn->fd, &ev);
+}
+
+// Finishes a pending reply first; then hands conn to the workers if it holds a complete
+// request, and otherwise closes it after EOF or waits for more input.
+void dispatchConnection(int epfd, connection *conn)
+{
+    if (conn->out)
+    {
+        rearmConnection(epfd, conn);
+    }
+    else if (memchr(conn->in, '\n', conn->in_len))
+    {
+        pthread_mutex_lock(&work_lock);
+        enqueueConnection(&work_queue, conn);
+        pthread_cond_signal(&work_ready);
+        pthread_mutex_unlock(&work_lock);
+    }
+    else if (conn->eof || conn->in_len >= SERVER_MAX_PENDING)
+    {
+        closeConnection(conn);
+    }
+    else
+    {
+        rearmConnection(epfd, conn);
+    }
+}
+
+// Reads everything available on conn into its buffer.
+void readConnection(connection *conn)
+{
+    for (;;)
+    {
+        if (conn->in_cap - conn->in_len < 4096)
+        {
+            int new_cap = conn->in_cap ? conn->in_cap * 2 : 8192;
+            char *grown = (char *)realloc(conn->in, new_cap);
+            if (!grown)
+            {
+                conn->eof = true;
+                return;
+            }
+            conn->in = grown;
+            conn->in_cap = new_cap;
+        }
+        ssize_t n = recv(conn->fd, conn->in + conn->in_len, conn->in_cap - conn->in_len, 0);
+        if (n > 0)
+        {
+            conn->in_len += n;
+            if (conn->in_len >= SERVER_MAX_PENDING)
+                return;
+        }
+        else if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK))
+                conn->eof = true;
+            return;
+        }
+    }
+}
+
+int runServer(const char *address, int workers)
+{
+    int listen_fd = openServerSocket(address);
+    if (listen_fd < 0)
+        return 1;
+    int epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (epfd < 0 || pipe2(server_wake_pipe, O_NONBLOCK | O_CLOEXEC) < 0)
+    {
+        perror("epoll");
+        return 1;
+    }
+
+    struct epoll_event ev;
+    ev.events = EPOLLIN;
+    ev.data.ptr = &server_listen_tag;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.ptr = &server_wake_tag;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, server_wake_pipe[0], &ev);
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = stopServing;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    pthread_t tids[workers];
+    for (int t = 0; t < workers; t++)
+        pthread_create(&tids[t], NULL, serverWorker, NULL);
+    fprintf(stderr, "Serving %s with %d workers\n", address, workers);
+
+    struct epoll_event events[SERVER_MAX_EVENTS];
+    while (!server_stopping)
+    {
+        int ready = epoll_wait(epfd, events, SERVER_MAX_EVENTS, -1);
+        if (ready < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            perror("epoll_wait");
+            break;
+        }
+
+        for (int e = 0; e < ready; e++)
+        {
+            if (events[e].data.ptr == &server_listen_tag)
+            {
+                int fd;
+                while ((fd = accept4(listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0)
+                {
+                    connection *conn = (connection *)calloc(1, sizeof(connection));
+                    if (!conn)
+                    {
+                        close(fd);
+                        continue;
+                    }
+                    int one = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)); // Fails harmlessly on Unix sockets
+                    conn->fd = fd;
+                    ev.events = EPOLLIN | EPOLLRDHUP | EPOLLONESHOT;
+                    ev.data.ptr = conn;
+                    epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+                }
+            }
+            else if (events[e].data.ptr == &server_wake_tag)
+            {
+                char drain[256];
+                while (read(server_wake_pipe[0], drain, sizeof(drain)) > 0)
+                    ;
+                pthread_mutex_lock(&done_lock);
+                connection *done = done_queue.head;
+                done_queue.head = done_queue.tail = NULL;
+                pthread_mutex_unlock(&done_lock);
+                while (done)
+                {
+                    connection *next = done->next;
+                    dispatchConnection(epfd, done);
+                    done = next;
+                }
+            }
+            else
+            {
+                connection *conn = (connection *)events[e].data.ptr;
+                if (!conn->out)
+                    readConnection(conn);
+                else if (flushConnection(conn) == FAILURE)
+                    abandonConnection(conn);
+                dispatchConnection(epfd, conn);
+            }
+        }
+    }
+
+    // Let the workers finish what they hold, then persist
+    pthread_mutex_lock(&work_lock);
+    server_stopping = 1;
+    pthread_cond_broadcast(&work_ready);
+    pthread_mutex_unlock(&work_lock);
+    for (int t = 0; t < workers; t++)
+        pthread_join(tids[t], NULL);
+    if (server_mutations > 0 && saveMedicationsToFile() == FAILURE)
+        fprintf(stderr, "Cannot write data file.\n");
+    flushSalesLedger();
+    close(listen_fd);
+    fprintf(stderr, "Server stopped\n");
+    return 0;
+}
+
+//==========LOAD GENERATOR==========//
+
+// --client drives a server with `connections` threads, each keeping `pipeline` requests in
+// flight, and reports throughput and latency. Requests are "query,ID" with random IDs in
+// 1..key_range, or "sell,ID,1" for sell_percent percent of them.
+
+typedef struct
+{
+    const char *address;
+    int requests;     // Requests this connection sends
+    int pipeline;
+    int key_range;
+    int sell_percent;
+    unsigned int seed;
+    long long errors;
+    long long answered;
+    latency_histogram latency;
+} client_worker;
+
+int connectToServer(const char *address)
+{
+    struct sockaddr_storage addr;
+    socklen_t len = parseServerAddress(address, &addr);
+    if (len == 0)
+        return -1;
+    int fd = socket(addr.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0)
+        return -1;
+    if (connect(fd, (struct sockaddr *)&addr, len) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+// Writes all of buf to the client's socket, waiting while it is full.
+status_code sendAll(int fd, const char *buf, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n > 0)
+        {
+            buf += n;
+            len -= n;
+        }
+        else if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            struct pollfd p = {fd, POLLOUT, 0};
+            poll(&p, 1, -1);
+        }
+        else if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            return FAILURE;
+        }
+    }
+    return SUCCESS;
+}
+
+void *clientWorker(void *arg)
+{
+    client_worker *w = (client_worker *)arg;
+    int fd = connectToServer(w->address);
+    if (fd < 0)
+    {
+        perror(w->address);
+        return NULL;
+    }
+
+    long long *sent_at = (long long *)malloc(w->pipeline * sizeof(long long));
+    if (!sent_at)
+    {
+        close(fd);
+        return NULL;
+    }
+    unsigned int x = w->seed;
+    int sent = 0;
+    Boolean line_start = true, reply_error = false, first_line = true;
+    char buf[65536];
+
+    while (w->answered < w->requests)
+    {
+        // Top the pipeline up with as many requests as fit, in one write
+        char out[8192];
+        int out_len = 0;
+        while (sent < w->requests && sent - w->answered < w->pipeline && out_len < (int)sizeof(out) - 64)
+        {
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            int id = (int)(x % w->key_range) + 1;
+            if ((int)((x >> 8) % 100) < w->sell_percent)
+                out_len += snprintf(out + out_len, sizeof(out) - out_len, "sell,%d,1\n", id);
+            else
+                out_len += snprintf(out + out_len, sizeof(out) - out_len, "query,%d\n", id);
+            sent_at[sent % w->pipeline] = now_ns();
+            sent++;
+        }
+        if (out_len > 0 && sendAll(fd, out, out_len) == FAILURE)
+            break;
+
+        ssize_t n = recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0)
+            break;
+        // A reply ends at its empty line; "error" on its first line marks a failed request
+        for (ssize_t i = 0; i < n; i++)
+        {
+            if (line_start && first_line)
+                reply_error = (buf[i] == 'e');
+            if (buf[i] == '\n')
+            {
+                if (line_start)
+                {
+                    recordLatency(&w->latency, now_ns() - sent_at[w->answered % w->pipeline]);
+                    if (reply_error)
+                        w->errors++;
+                    w->answered++;
+                    first_line = true;
+                }
+                else
+                {
+                    first_line = false;
+                }
+                line_start = true;
+            }
+            else
+            {
+                line_start = false;
+            }
+        }
+    }
+
+    free(sent_at);
+    close(fd);
+    return NULL;
+}
+
+// Prints CSV: connections,pipeline,requests,errors,seconds,qps,p50_us,p90_us,p99_us,p999_us,max_us
+int runLoadGenerator(const char *address, int connections, int requests, int pipeline, int key_range, int sell_percent)
+{
+    client_worker *workers = (client_worker *)calloc(connections, sizeof(client_worker));
+    pthread_t *tids = (pthread_t *)malloc(connections * sizeof(pthread_t));
+    if (!workers || !tids)
+    {
+        fprintf(stderr, "Memory allocation failed for load generator.\n");
+        return 1;
+    }
+
+    long long start = now_ns();
+    for (int c = 0; c < connections; c++)
+    {
+        workers[c].address = address;
+        workers[c].requests = requests / connections + (c < requests % connections);
+        workers[c].pipeline = pipeline;
+        workers[c].key_range = key_range;
+        workers[c].sell_percent = sell_percent;
+        workers[c].seed = 2463534242u + 7919u * c;
+        pthread_create(&tids[c], NULL, clientWorker, &workers[c]);
+    }
+
+    latency_histogram all;
+    memset(&all, 0, sizeof(all));
+    long long errors = 0;
+    for (int c = 0; c < connections; c++)
+    {
+        pthread_join(tids[c], NULL);
+        for (int b = 0; b < LATENCY_BUCKETS; b++)
+            all.counts[b] += workers[c].latency.counts[b];
+        all.total += workers[c].latency.total;
+        if (workers[c].latency.max > all.max)
+            all.max = workers[c].latency.max;
+        errors += workers[c].errors;
+    }
+    double seconds = (now_ns() - start) / 1e9;
+
+    printf("connections,pipeline,requests,errors,seconds,qps,p50_us,p90_us,p99_us,p999_us,max_us\n");
+    printf("%d,%d,%lld,%lld,%.3f,%.0f,%.1f,%.1f,%.1f,%.1f,%.1f\n", connections, pipeline, all.total, errors,
+           seconds, all.total / seconds, latencyPercentile(&all, 50) / 1000.0, latencyPercentile(&all, 90) / 1000.0,
+           latencyPercentile(&all, 99) / 1000.0, latencyPercentile(&all, 99.9) / 1000.0, all.max / 1000.0);
+    free(workers);
+    free(tids);
+    return all.total == requests ? 0 : 2;
+}
+
+//==========SYNTHETIC INVENTORY==========//
+
+// Writes made-up inventories in the data file format for benchmarking. Batch and supplier
+// counts vary around the requested means, a few suppliers serve most batches, and expiry dates
+// are spread so that about a fifth of the batches have already expired. Supplier IDs are spread
+// over the whole positive int range, and every link carries the price it was received at.
+
+typedef struct
+{
+    int skus;                // Medications
+    int batches_per_sku;     // Mean batches per medication
+    int suppliers_per_batch; // Mean suppliers per batch
+    int supplier_pool;       // Distinct suppliers
+    int date_spread;         // Days between the earliest and the latest expiry
+    unsigned int seed;
+} inventory_spec;
+
+const char *name_stems[] = {"Amoxi", "Cefa", "Dolo", "Ibu", "Para", "Metro", "Azithro", "Cipro",
+                            "Rani", "Panto", "Levo", "Atorva", "Losa", "Metfor", "Omepra", "Cetri"};
+const char *name_endings[] = {"cillin", "zole", "mycin", "profen", "cetamol", "pril", "statin", "tadine",
+                              "mide", "lol", "dine", "floxacin"};
+
+// Deterministic name of synthetic medication medID; unique per ID.
+void syntheticMedName(int medID, char *name)
+{
+    int stems = sizeof(name_stems) / sizeof(name_stems[0]);
+    int endings = sizeof(name_endings) / sizeof(name_endings[0]);
+    snprintf(name, MAX_NAME_LENGTH, "%s%s-%d", name_stems[medID % stems], name_endings[(medID / stems) % endings],
+             medID);
+}
+
+// Supplier ID of the rank-th synthetic supplier, rank >= 1. Multiplying by an odd constant
+// permutes the 31-bit values and keeps 0 at 0, so each rank gets its own positive ID.
+int syntheticSupplierId(int rank)
+{
+    return (int)(((unsigned)rank * 0x9E3779B1u) & 0x7FFFFFFFu);
+}
+
+// A count around mean: uniform over 1..2*mean-1, capped at max.
+int aroundMean(unsigned int *state, int mean, int max)
+{
+    int count = mean > 1 ? 1 + (int)(nextRandom(state) % (2 * mean - 1)) : 1;
+    return count < max ? count : max;
+}
+
+status_code writeSyntheticInventory(FILE *fp, const inventory_spec *spec)
+{
+    unsigned int state = spec->seed ? spec->seed : 2463534242u;
+    int today = dayNumber((long long)time(NULL));
+    for (int medID = 1; medID <= spec->skus; medID++)
+    {
+        char name[MAX_NAME_LENGTH];
+        syntheticMedName(medID, name);
+        int price = 1 + (int)(nextRandom(&state) % 500);
+        int reorder = 10 + (int)(nextRandom(&state) % 190);
+        fprintf(fp, "%d,%s,%d,%d\n", medID, name, price, reorder);
+
+        int batches = aroundMean(&state, spec->batches_per_sku, MAX_BATCHES);
+        for (int b = 1; b <= batches; b++)
+        {
+            char date[MAX_DATE_LENGTH], formatted_date[MAX_DATE_LENGTH];
+            int offset = spec->date_spread > 0 ? (int)(nextRandom(&state) % spec->date_spread) : 0;
+            dayToDate(today - spec->date_spread / 5 + offset, date);
+            reverse_date_format(date, formatted_date);
+            fprintf(fp, "%d,%s,%d\n", b, formatted_date, 10 + (int)(nextRandom(&state) % 990));
+
+            int pool = spec->supplier_pool < MAX_SUPPLIERS ? spec->supplier_pool : MAX_SUPPLIERS;
+            int suppliers = aroundMean(&state, spec->suppliers_per_batch, pool);
+            int chosen[MAX_SUPPLIERS];
+            for (int k = 0; k < suppliers; k++)
+            {
+                // Squaring a uniform draw favours the low ranks: a few suppliers carry most batches
+                double u = (nextRandom(&state) % 1000000) / 1000000.0;
+                int rank = 1 + (int)(u * u * spec->supplier_pool);
+                for (int c = 0; c < k; c++)
+                {
+                    if (chosen[c] == rank)
+                    {
+                        rank = rank % spec->supplier_pool + 1; // Taken: try the next rank
+                        c = -1;
+                    }
+                }
+                chosen[k] = rank;
+                int id = syntheticSupplierId(rank);
+                // Received at 60-100% of the current list price
+                int received = price * (60 + (int)(nextRandom(&state) % 41)) / 100;
+                fprintf(fp, "%d,Supplier%d,%d,%lld,%d\n", id, rank, 10 + (int)(nextRandom(&state) % 490),
+                        9000000000LL + rank, received > 0 ? received : 1);
+            }
+            fprintf(fp, "###\n");
+        }
+        fprintf(fp, "END\n");
+    }
+    return ferror(fp) ? FAILURE : SUCCESS;
+}
+
+// Checks spec against the limits of the data model; prints the first violation.
+status_code validateInventorySpec(const inventory_spec *spec)
+{
+    if (spec->skus < 1 || spec->batches_per_sku < 1 || spec->suppliers_per_batch < 1 || spec->date_spread < 0)
+    {
+        fprintf(stderr, "SKUs, batches and suppliers per batch must be positive.\n");
+        return FAILURE;
+    }
+    if (spec->batches_per_sku > MAX_BATCHES / 2 + 1)
+    {
+        fprintf(stderr, "At most %d batches per SKU on average (limit %d).\n", MAX_BATCHES / 2 + 1, MAX_BATCHES);
+        return FAILURE;
+    }
+    if (spec->suppliers_per_batch > MAX_SUPPLIERS / 2 + 1)
+    {
+        fprintf(stderr, "At most %d suppliers per batch on average (limit %d).\n", MAX_SUPPLIERS / 2 + 1,
+                MAX_SUPPLIERS);
+        return FAILURE;
+    }
+    if (spec->supplier_pool < 1)
+    {
+        fprintf(stderr, "The supplier pool must hold at least 1 supplier.\n");
+        return FAILURE;
+    }
+    return SUCCESS;
+}
+
+int runGenerator(const inventory_spec *spec, const char *path)
+{
+    if (validateInventorySpec(spec) == FAILURE)
+        return 1;
+    FILE *fp = strcmp(path, "-") == 0 ? stdout : fopen(path, "w");
+    if (!fp)
+    {
+        fprintf(stderr, "Cannot open output file %s\n", path);
+        return 1;
+    }
+    status_code status = writeSyntheticInventory(fp, spec);
+    if (fp != stdout && fclose(fp) != 0)
+        status = FAILURE;
+    if (status == FAILURE)
+    {
+        fprintf(stderr, "Failed writing %s\n", path);
+        return 1;
+    }
+    return 0;
+}
+
+//==========BENCHMARK SUITE==========//
+
+// End-to-end timings of the main operations on generated inventories. Each scale runs in a
+// child process, in a scratch directory of its own, so it starts from empty trees and its data
+// and ledger files never touch the real ones.
+
+#define SUITE_LOOKUPS 200000 // Lookups timed per index
+#define SUITE_SALES 100000   // Single-unit sales timed
+#define SUITE_RANGES 100     // 30-day expiry range reports timed
+#define SUITE_ALERT_PASSES 100
+#define SUITE_TOP_REPORTS 10000
+
+typedef struct
+{
+    Boolean json;
+    Boolean need_comma; // A JSON row has already been written
+    int skus;
+    int batches;
+} suite_output;
+
+void suiteRow(suite_output *out, const char *op, long long ops, long long elapsed_ns)
+{
+    double ms = elapsed_ns / 1e6, per_op = ops ? (double)elapsed_ns / ops : 0;
+    if (out->json)
+    {
+        printf("%s\n  {\"skus\": %d, \"batches\": %d, \"op\": \"%s\", \"ops\": %lld, \"total_ms\": %.3f, "
+               "\"ns_per_op\": %.1f}",
+               out->need_comma ? "," : "", out->skus, out->batches, op, ops, ms, per_op);
+        out->need_comma = true;
+    }
+    else
+        printf("%d,%d,%s,%lld,%.3f,%.1f\n", out->skus, out->batches, op, ops, ms, per_op);
+    fflush(stdout);
+}
+
+// Generates, loads and exercises one inventory in the current directory.
+int runSuiteScale(const inventory_spec *spec, suite_output *out)
+{
+    long long start = now_ns();
+    FILE *fp = fopen("medications_data.txt", "w");
+    if (!fp || writeSyntheticInventory(fp, spec) == FAILURE || fclose(fp) != 0)
+    {
+        fprintf(stderr, "Cannot write the synthetic inventory.\n");
+        return 1;
+    }
+    long long generated = now_ns() - start;
+
+    start = now_ns();
+    loadMedicationsFromFile();
+    long long loaded = now_ns() - start;
+    ledger_sync = false; // Scratch ledger: time the sale path, not the disk
+    loadSalesLedger();
+    out->batches = columns.rows - columns.free_row_count;
+    suiteRow(out, "generate", spec->skus, generated);
+    suiteRow(out, "load", out->batches, loaded);
+
+    unsigned int state = spec->seed ? spec->seed : 2463534242u;
+    long long found = 0;
+    start = now_ns();
+    readBegin();
+    for (int i = 0; i < SUITE_LOOKUPS; i++)
+        found += lookupMedID(1 + (int)(nextRandom(&state) % spec->skus)) != NULL;
+    readEnd();
+    suiteRow(out, "lookup_id", SUITE_LOOKUPS, now_ns() - start);
+
+    char(*names)[MAX_NAME_LENGTH] = malloc(1024 * sizeof(*names));
+    if (!names)
+        return 1;
+    for (int i = 0; i < 1024; i++)
+        syntheticMedName(1 + (int)(nextRandom(&state) % spec->skus), names[i]);
+    start = now_ns();
+    readBegin();
+    for (int i = 0; i < SUITE_LOOKUPS; i++)
+        found += lookupMedname(names[i & 1023]) != NULL;
+    readEnd();
+    suiteRow(out, "lookup_name", SUITE_LOOKUPS, now_ns() - start);
+    free(names);
+
+    int today = dayNumber((long long)time(NULL));
+    start = now_ns();
+    for (int i = 0; i < SUITE_RANGES; i++)
+    {
+        char from[MAX_DATE_LENGTH], to[MAX_DATE_LENGTH];
+        int first = today - spec->date_spread / 5 + (int)(nextRandom(&state) % (spec->date_spread + 1));
+        dayToDate(first, from);
+        dayToDate(first + 30, to);
+        int count;
+        free(expiringBatchesReport(from, to, &count));
+    }
+    suiteRow(out, "expiry_range", SUITE_RANGES, now_ns() - start);
+
+    start = now_ns();
+    for (int i = 0; i < SUITE_ALERT_PASSES; i++)
+    {
+        int count;
+        free(lowStockAlerts(&count));
+    }
+    suiteRow(out, "stock_alerts", SUITE_ALERT_PASSES, now_ns() - start);
+
+    supplier *top[10];
+    start = now_ns();
+    for (int i = 0; i < SUITE_TOP_REPORTS; i++)
+    {
+        topKSuppliers(RANK_BY_MEDS, 10, top);
+        topKSuppliers(RANK_BY_TURNOVER, 10, top);
+    }
+    suiteRow(out, "top10_reports", 2 * SUITE_TOP_REPORTS, now_ns() - start);
+
+    long long now = (long long)time(NULL);
+    start = now_ns();
+    for (int i = 0; i < SUITE_SALES; i++)
+        concurrentSell(1 + (int)(nextRandom(&state) % spec->skus), 1, now);
+    flushSalesLedger();
+    suiteRow(out, "sales", SUITE_SALES, now_ns() - start);
+
+    start = now_ns();
+    status_code saved = saveMedicationsToFile();
+    suiteRow(out, "save", out->batches, now_ns() - start);
+
+    if (found != 2 * SUITE_LOOKUPS || saved == FAILURE)
+    {
+        fprintf(stderr, "Benchmark run at %d SKUs lost data.\n", spec->skus);
+        return 2;
+    }
+    return 0;
+}
+
+// Removes the files a scale left in its scratch directory, then the directory.
+void removeScratchDirectory(const char *dir)
+{
+    char path[256];
+    const char *files[] = {"medications_data.txt", LEDGER_FILE};
+    for (size_t i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+        snprintf(path, sizeof(path), "%s/%s", dir, files[i]);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+int runBenchmarkSuite(const int *scales, int num_scales, inventory_spec spec, Boolean json)
+{
+    for (int i = 0; i < num_scales; i++)
+    {
+        spec.skus = scales[i];
+        if (validateInventorySpec(&spec) == FAILURE)
+            return 1;
+    }
+
+    printf(json ? "[" : "skus,batches,op,ops,total_ms,ns_per_op\n");
+    fflush(stdout);
+    int failed = 0;
+    suite_output out = {json, false, 0, 0};
+    for (int i = 0; i < num_scales && !failed; i++)
+    {
+        char dir[] = "/tmp/pharmacy-bench-XXXXXX";
+        if (!mkdtemp(dir))
+        {
+            perror("mkdtemp");
+            return 1;
+        }
+        spec.skus = out.skus = scales[i];
+        out.need_comma = json && i > 0;
+
+        pid_t child = fork();
+        if (child == 0)
+        {
+            quiet = true;
+            if (chdir(dir) != 0)
+                _exit(1);
+            _exit(runSuiteScale(&spec, &out));
+        }
+        int status = 1;
+        if (child < 0 || waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+        {
+            fprintf(stderr, "Benchmark run at %d SKUs failed.\n", scales[i]);
+            failed = 2;
+        }
+        removeScratchDirectory(dir);
+    }
+    if (json)
+        printf("\n]\n");
+    return failed;
+}
+
+void printUsage(const char *program)
+{
+    printf("Usage:\n");
+    printf("  %s                                   interactive menu\n", program);
+    printf("  %s --batch [file|-] [--checkpoint N]  apply a command stream, save once at the end\n", program);
+    printf("  %s --sales [file|-]                   apply medID,qty,timestamp sale lines in one sorted pass\n", program);
+    printf("  %s --bench-sales [threads]            measure concurrent sale throughput on a synthetic inventory\n", program);
+    printf("  %s --bench-lookups [readers]          measure lock-free lookup latency with and without a writer\n", program);
+    printf("  %s --bench-analytics [threads]        time the parallel supplier analytics pass\n", program);
+    printf("  %s --bench-search [keys]              compare scalar and SIMD in-node key search\n", program);
+    printf("  %s --bench-layout [max_keys]          compare B-tree and packed-layout lookups from 1k keys up\n", program);
+    printf("  %s --bench-trees [keys]               time insert/search/delete per index tree and check invariants\n", program);
+    printf("  %s --bench-sweep [batches]            time the columnar expiry, valuation and stock sweeps\n", program);
+    printf("  %s --generate [--output FILE|-] [inventory options]\n", program);
+    printf("      write a synthetic inventory in the data file format\n");
+    printf("  %s --bench-suite [--scales N,N,...] [--format csv|json] [inventory options]\n", program);
+    printf("      time load, save, lookups, expiry ranges, stock alerts, sales and top-10 reports\n");
+    printf("  inventory options: [--skus N] [--batches-per-sku B] [--suppliers-per-batch S]\n");
+    printf("      [--suppliers P] [--date-spread DAYS] [--seed X]\n");
+    printf("  %s --serve unix:PATH|tcp:PORT [--workers N]\n", program);
+    printf("      keep the inventory in memory and answer batch commands over a socket\n");
+    printf("  %s --client unix:PATH|tcp:PORT [--connections C] [--requests N] [--pipeline D]\n", program);
+    printf("      [--key-range R] [--sell-percent P]  load-test a server, report QPS and latency\n");
+    printf("  %s --record LOG                      interactive menu, logging every operation as a batch command\n", program);
+    printf("  %s --replay LOG|- [--snapshot FILE]  run a recorded log against FILE (default the data file) at full\n", program);
+    printf("      speed without changing it, and report the run and per-operation latencies\n");
+    printf("  --no-stats (before any mode)            skip the per-operation latency statistics\n");
+    printf("  --trace FILE [--trace-spans N] (before any mode)\n");
+    printf("      keep the last N (default %d) operation spans and write them as Chrome trace JSON at exit\n",
+           TRACE_DEFAULT_SPANS);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *batch_path = NULL;
+    const char *sales_path = NULL;
+    const char *record_path = NULL, *replay_path = NULL, *snapshot_path = "medications_data.txt";
+    Boolean batch_mode = false;
+    Boolean sales_mode = false;
+    int checkpoint_every = 0;
+    const char *serve_address = NULL;
+    const char *client_address = NULL;
+    int workers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int connections = 4, requests = 100000, pipeline = 16, key_range = 1000, sell_percent = 0;
+    Boolean generate = false, bench_suite = false, json = false;
+    const char *output_path = "synthetic_inventory.txt";
+    inventory_spec spec = {1000, 5, 2, 200, 730, 0};
+    int scales[16] = {1000, 10000}, num_scales = 2;
+
+    for (int a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "--no-stats") == 0)
+            stats_enabled = false;
+        else if (strcmp(argv[a], "--trace") == 0 && a + 1 < argc)
+        {
+            const char *path = argv[++a];
+            long long spans = TRACE_DEFAULT_SPANS;
+            if (a + 1 < argc && strcmp(argv[a + 1], "--trace-spans") == 0 && a + 2 < argc)
+            {
+                a += 2;
+                spans = atoll(argv[a]);
+            }
+            if (spans < 1 || startTracing(path, (unsigned long long)spans) == FAILURE)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[a], "--record") == 0 && a + 1 < argc)
+            record_path = argv[++a];
+        else if (strcmp(argv[a], "--replay") == 0 && a + 1 < argc)
+            replay_path = argv[++a];
+        else if (strcmp(argv[a], "--snapshot") == 0 && a + 1 < argc)
+            snapshot_path = argv[++a];
+        else if (strcmp(argv[a], "--batch") == 0)
+        {
+            batch_mode = true;
+            if (a + 1 < argc && strncmp(argv[a + 1], "--", 2) != 0)
+                batch_path = argv[++a];
+        }
+        else if (strcmp(argv[a], "--sales") == 0)
+        {
+            sales_mode = true;
+            if (a + 1 < argc && strncmp(argv[a + 1], "--", 2) != 0)
+                sales_path = argv[++a];
+        }
+        else if (strcmp(argv[a], "--bench-sales") == 0)
+        {
+            int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+            if (a + 1 < argc)
+                threads = atoi(argv[++a]);
+            if (threads < 1)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            quiet = true;
+            return runSalesBenchmark(threads);
+        }
+        else if (strcmp(argv[a], "--bench-analytics") == 0)
+        {
+            int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+            if (a + 1 < argc)
+                threads = atoi(argv[++a]);
+            if (threads < 1)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            quiet = true;
+            return runAnalyticsBenchmark(threads);
+        }
+        else if (strcmp(argv[a], "--bench-lookups") == 0)
+        {
+            int readers = (int)sysconf(_SC_NPROCESSORS_ONLN);
+            if (a + 1 < argc)
+                readers = atoi(argv[++a]);
+            if (readers < 1 || readers > MAX_READER_THREADS)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            quiet = true;
+            return runLookupBenchmark(readers);
+        }
+        else if (strcmp(argv[a], "--bench-layout") == 0)
+        {
+            int max_keys = 10000000;
+            if (a + 1 < argc)
+                max_keys = atoi(argv[++a]);
+            if (max_keys < 1000)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            return runLayoutBenchmark(max_keys);
+        }
+        else if (strcmp(argv[a], "--bench-trees") == 0)
+        {
+            int keys = 100000;
+            if (a + 1 < argc)
+                keys = atoi(argv[++a]);
+            if (keys < 1)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            return runTreeBenchmark(keys);
+        }
+        else if (strcmp(argv[a], "--bench-sweep") == 0)
+        {
+            int batches = 10000000;
+            if (a + 1 < argc)
+                batches = atoi(argv[++a]);
+            if (batches < 1)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            return runSweepBenchmark(batches);
+        }
+        else if (strcmp(argv[a], "--bench-search") == 0)
+        {
+            int keys = 1000000;
+            if (a + 1 < argc)
+                keys = atoi(argv[++a]);
+            if (keys < 1)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+            return runSearchBenchmark(keys);
+        }
+        else if (strcmp(argv[a], "--checkpoint") == 0 && a + 1 < argc)
+        {
+            checkpoint_every = atoi(argv[++a]);
+        }
+        else if (strcmp(argv[a], "--serve") == 0 && a + 1 < argc)
+            serve_address = argv[++a];
+        else if (strcmp(argv[a], "--workers") == 0 && a + 1 < argc)
+            workers = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--client") == 0 && a + 1 < argc)
+            client_address = argv[++a];
+        else if (strcmp(argv[a], "--connections") == 0 && a + 1 < argc)
+            connections = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--requests") == 0 && a + 1 < argc)
+            requests = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--pipeline") == 0 && a + 1 < argc)
+            pipeline = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--key-range") == 0 && a + 1 < argc)
+            key_range = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--sell-percent") == 0 && a + 1 < argc)
+            sell_percent = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--generate") == 0)
+            generate = true;
+        else if (strcmp(argv[a], "--bench-suite") == 0)
+            bench_suite = true;
+        else if (strcmp(argv[a], "--output") == 0 && a + 1 < argc)
+            output_path = argv[++a];
+        else if (strcmp(argv[a], "--skus") == 0 && a + 1 < argc)
+            spec.skus = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--batches-per-sku") == 0 && a + 1 < argc)
+            spec.batches_per_sku = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--suppliers-per-batch") == 0 && a + 1 < argc)
+            spec.suppliers_per_batch = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--suppliers") == 0 && a + 1 < argc)
+            spec.supplier_pool = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--date-spread") == 0 && a + 1 < argc)
+            spec.date_spread = atoi(argv[++a]);
+        else if (strcmp(argv[a], "--seed") == 0 && a + 1 < argc)
+            spec.seed = (unsigned int)strtoul(argv[++a], NULL, 10);
+        else if (strcmp(argv[a], "--format") == 0 && a + 1 < argc)
+        {
+            json = strcmp(argv[++a], "json") == 0;
+            if (!json && strcmp(argv[a], "csv") != 0)
+            {
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[a], "--scales") == 0 && a + 1 < argc)
+        {
+            char *list = argv[++a], *end;
+            num_scales = 0;
+            while (num_scales < 16 && *list)
+            {
+                scales[num_scales++] = (int)strtol(list, &end, 10);
+                if (end == list || (*end != ',' && *end != '\0'))
+                {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                list = *end ? end + 1 : end;
+            }
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (replay_path)
+    {
+        FILE *log = strcmp(replay_path, "-") == 0 ? stdin : fopen(replay_path, "r");
+        if (!log)
+        {
+            fprintf(stderr, "Cannot open workload log %s\n", replay_path);
+            return 1;
+        }
+        int status = runReplay(log, snapshot_path);
+        if (log != stdin)
+            fclose(log);
+        return status;
+    }
+    if (generate)
+        return runGenerator(&spec, output_path);
+    if (bench_suite)
+        return runBenchmarkSuite(scales, num_scales, spec, json);
+    if (client_address)
+    {
+        if (connections < 1 || requests < 1 || pipeline < 1 || key_range < 1 || sell_percent < 0 || sell_percent > 100)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return runLoadGenerator(client_address, connections, requests, pipeline, key_range, sell_percent);
+    }
+    if (serve_address)
+    {
+        if (workers < 1)
+        {
+            printUsage(argv[0]);
+            return 1;
+        }
+        quiet = true;
+        loadMedicationsFromFile();
+        loadSalesLedger();
+        return runServer(serve_address, workers);
+    }
+
+    if (batch_mode || sales_mode)
+    {
+        const char *path = batch_mode ? batch_path : sales_path;
+        FILE *in = stdin;
+        if (path && strcmp(path, "-") != 0)
+        {
+            in = fopen(path, "r");
+            if (!in)
+            {
+                fprintf(stderr, "Cannot open input file %s\n", path);
+                return 1;
+            }
+        }
+
+        quiet = true;
+        loadMedicationsFromFile();
+        loadSalesLedger();
+        int failed = batch_mode ? runBatch(in, checkpoint_every) : runSalesFile(in);
+        if (in != stdin)
+            fclose(in);
+        flushSalesLedger();
+        return failed ? 2 : 0;
+    }
+
+    if (record_path && startRecording(record_path) == FAILURE)
+    {
+        fprintf(stderr, "Cannot open workload log %s\n", record_path);
+        return 1;
+    }
+
+    // Load existing data from file
+    loadMedicationsFromFile();
+    loadSalesLedger();
+
+    int choice;
+    do
+    {
+        printf("\n=== Pharmacy Management System ===\n");
+        printf("1. Add New Medication\n");
+        printf("2. Update Medication\n");
+        printf("3. Delete Medication\n");
+        printf("4. Search Medication\n");
+        printf("5. View Stock Alerts\n");
+        printf("6. Check Expiry Dates\n");
+        printf("7. Sort Medication by Expiry Dates\n");
+        printf("8. Track the sales\n");
+        printf("9. Supplier Management\n");
+        printf("10. Top 10 All-rounder Supplier\n");
+        printf("11. Top 10 Largest Turnover\n");
+        printf("12. To Exit\n");
+        printf("13. Browse Listings by Page\n");
+        printf("14. Sale Latency Percentiles\n");
+        printf("15. Sales Report\n");
+        printf("16. Operation Statistics\n");
+        printf("17. Memory Usage\n");
+        printf("18. Tree Health\n");
+        printf("19. Purge Expired Stock\n");
+        printf("20. Supply Volume and Turnover\n");
+        printf("Enter your choice: ");
+        scanf("%d", &choice);
+
+        switch (choice)
+        {
+        case 1:
+        {
+            addMedicationGeneral(&medIDTree, &mednameTree, &expDateTree, &supplierTree);
+            saveMedicationsToFile();
+            recordWorkload("save");
+            break;
+        }
+        case 2:
+        {
+            int medID;
+            printf("Enter Medication ID to update: ");
+            scanf("%d", &medID);
+            updateMedication(medID);
+            saveMedicationsToFile();
+            recordWorkload("save");
+            break;
+        }
+        case 3:
+        {
+            int medID, batch_no;
+            printf("Enter Medication ID to delete: ");
+            scanf("%d", &medID);
+            printf("Enter Batch No.: ");
+            scanf("%d", &batch_no);
+            recordWorkload("delete,%d,%d", medID, batch_no);
+            deleteMedication(&medIDTree, &mednameTree, &expDateTree, medID, batch_no);
+            saveMedicationsToFile();
+            recordWorkload("save");
+            break;
+        }
+        case 4:
+        {
+            searchMedication();
+            break;
+        }
+        case 5:
+        {
+            recordWorkload("alerts");
+            long long start = opBegin();
+            stockAlerts();
+            opEnd(OP_STOCK_ALERTS, start, false);
+            break;
+        }
+        case 6:
+        {
+            char date[MAX_DATE_LENGTH];
+            printf("Enter current date (DD-MM-YYYY): ");
+            scanf(" %10s", date);
+            recordWorkload("due,%s", date);
+            long long start = opBegin();
+            checkexpirydate(date);
+            opEnd(OP_EXPIRY_CHECK, start, false);
+            break;
+        }
+        case 7:
+        {
+            char startDate[11], endDate[11];
+            printf("Enter the start date (DD-MM-YYYY): ");
+            scanf("%10s", startDate);
+            printf("Enter the end date (DD-MM-YYYY): ");
+            scanf("%10s", endDate);
+
+            recordWorkload("expiring,%s,%s", startDate, endDate);
+            printf("Medications with expiry dates between %s and %s:\n", startDate, endDate);
+            long long start = opBegin();
+            sortMedicationByExpiry(expDateTree, startDate, endDate);
+            opEnd(OP_EXPIRY_RANGE, start, false);
+            printf("\n");
+            break;
+        }
+        case 8:
+        {
+            int medID, qtySold;
+            printf("Enter Medication ID to sell: ");
+            scanf("%d", &medID);
+            printf("Enter quantity to sell: ");
+            scanf("%d", &qtySold);
+            recordWorkload("sell,%d,%d", medID, qtySold);
+            salesTracking(medIDTree, medID, qtySold);
+            saveMedicationsToFile();
+            recordWorkload("save");
+            break;
+        }
+        case 9:
+        {
+            supplierManagement();
+            saveMedicationsToFile();
+            recordWorkload("save");
+            break;
+        }
+        case 10:
+        {
+            recordWorkload("top,meds,10");
+            long long start = opBegin();
+            top10Allrounders(supplierTree);
+            opEnd(OP_TOP_REPORT, start, false);
+            break;
+        }
+        case 11:
+        {
+            recordWorkload("top,turnover,10");
+            long long start = opBegin();
+            top10largestturnover(supplierTree);
+            opEnd(OP_TOP_REPORT, start, false);
+            break;
+        }
+        case 12:
+            printf("Exiting...\n");
+            saveMedicationsToFile();
+            recordWorkload("save");
+            break;
+        case 13:
+        {
+            browseListings();
+            break;
+        }
+        case 14:
+        {
+            printLatencyPercentiles("Sale latency", &operation_stats[OP_SALE].latency);
+            break;
+        }
+        case 15:
+        {
+            salesReport();
+            break;
+        }
+        case 16:
+        {
+            operationStatsMenu();
+            break;
+        }
+        case 17:
+        {
+            printMemoryReport();
+            break;
+        }
+        case 18:
+        {
+            printTreeHealth();
+            break;
+        }
+        case 19:
+        {
+            purgeMenu();
+            break;
+        }
+        case 20:
+        {
+            recordWorkload("supply");
+            printSupplyReport();
+            break;
+        }
+        default:
+            printf("Invalid choice. Please try again.\n");
+        }
+    } while (choice != 12);
+
+    return 0;
 }
\ No newline at end of file